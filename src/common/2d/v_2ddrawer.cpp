@@ -33,6 +33,7 @@
 */
 
 #include <stdarg.h>
+#include <float.h>
 
 #include "v_2ddrawer.h"
 #include "vectors.h"
@@ -49,6 +50,8 @@ F2DDrawer* twod = &drawer;
 EXTERN_CVAR(Float, transsouls)
 CVAR(Float, classic_scaling_factor, 2.0, CVAR_ARCHIVE)
 CVAR(Float, classic_scaling_pixelaspect, 1.2f, CVAR_ARCHIVE)
+CVAR(Bool, hw_2dbatching, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Bool, hw_2dlayercache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
 IMPLEMENT_CLASS(FCanvas, false, false)
 
@@ -222,7 +225,7 @@ DEFINE_ACTION_FUNCTION_NATIVE(DShape2D, PushTriangle, Shape2D_PushTriangle)
 int F2DDrawer::AddCommand(RenderCommand *data) 
 {
 	data->mScreenFade = screenFade;
-	if (mData.Size() > 0 && data->isCompatible(mData.Last()))
+	if (mData.Size() > mMergeBarrier && data->isCompatible(mData.Last()))
 	{
 		// Merge with the last command.
 		mData.Last().mIndexCount += data->mIndexCount;
@@ -460,6 +463,18 @@ void F2DDrawer::AddTexture(FGameTexture* img, DrawParms& parms)
 	u2 = parms.srcx + parms.srcwidth;
 	v2 = parms.srcy + parms.srcheight;
 
+	double uscale = 1.;
+	if (auto atlas = img->GetAtlas())
+	{
+		auto& rect = img->GetAtlasRect();
+		u1 = rect.left + u1 * rect.width;
+		u2 = rect.left + u2 * rect.width;
+		v1 = rect.top + v1 * rect.height;
+		v2 = rect.top + v2 * rect.height;
+		uscale = rect.width;
+		dg.mTexture = atlas;
+	}
+
 	if (parms.flipX)
 	{
 		std::swap(u1, u2);
@@ -489,8 +504,8 @@ void F2DDrawer::AddTexture(FGameTexture* img, DrawParms& parms)
 			x += parms.windowleft * xscale;
 			w -= (parms.texwidth - wi + parms.windowleft) * xscale;
 
-			u1 = float(u1 + parms.windowleft / parms.texwidth);
-			u2 = float(u2 - (parms.texwidth - wi) / parms.texwidth);
+			u1 = float(u1 + parms.windowleft / parms.texwidth * uscale);
+			u2 = float(u2 - (parms.texwidth - wi) / parms.texwidth * uscale);
 		}
 		auto t = this->transform;
 		auto tCorners = {
@@ -1203,10 +1218,227 @@ void F2DDrawer::Clear()
 		mIndices.Clear();
 		mData.Clear();
 		mIsFirstPass = true;
+		mMergeBarrier = 0;
+		mRecordingLayer = nullptr;
 	}
 	screenFade = 1.f;
 }
 
+//==========================================================================
+//
+// Merges compatible triangle commands that are not directly adjacent.
+// A command may be moved back to an earlier compatible one if nothing
+// drawn in between overlaps it, so interleaved draws like text over
+// different background images still end up in a few draw calls.
+// Only the index order changes, the vertices stay where they are.
+//
+//==========================================================================
+
+void F2DDrawer::OptimizeBatches()
+{
+	if (!hw_2dbatching || mData.Size() < 3) return;
+
+	enum { MAX_LOOKBACK = 32 };
+
+	struct FBatch
+	{
+		float Bounds[4];	// left, top, right, bottom
+		int First, Last;	// chain of source commands in drawing order
+		bool Barrier;
+	};
+
+	TArray<FBatch> batches(mData.Size(), true);
+	TArray<int> nextCommand(mData.Size(), true);
+	unsigned numBatches = 0;
+	bool merged = false;
+
+	for (unsigned i = 0; i < mData.Size(); i++)
+	{
+		auto &cmd = mData[i];
+		nextCommand[i] = -1;
+
+		FBatch batch;
+		batch.First = batch.Last = i;
+		batch.Barrier = cmd.isSpecial != SpecialDrawCommand::NotSpecial || cmd.shape2DBufInfo != nullptr;
+		if (!batch.Barrier)
+		{
+			// Compute the screen space bounds of everything this command touches.
+			float &left = batch.Bounds[0], &top = batch.Bounds[1], &right = batch.Bounds[2], &bottom = batch.Bounds[3];
+			left = top = FLT_MAX;
+			right = bottom = -FLT_MAX;
+
+			auto addVertex = [&](const TwoDVertex &v)
+			{
+				float x = v.x, y = v.y;
+				if (cmd.useTransform)
+				{
+					x = float(cmd.transform.Cells[0][0] * v.x + cmd.transform.Cells[0][1] * v.y + cmd.transform.Cells[0][2]);
+					y = float(cmd.transform.Cells[1][0] * v.x + cmd.transform.Cells[1][1] * v.y + cmd.transform.Cells[1][2]);
+				}
+				left = min(left, x);
+				right = max(right, x);
+				top = min(top, y);
+				bottom = max(bottom, y);
+			};
+
+			if (cmd.mType == DrawTypeTriangles)
+			{
+				for (int j = 0; j < cmd.mIndexCount; j++) addVertex(mVertices[mIndices[cmd.mIndexIndex + j]]);
+			}
+			else
+			{
+				for (int j = 0; j < cmd.mVertCount; j++) addVertex(mVertices[cmd.mVertIndex + j]);
+			}
+			// Leave some room for line smoothing and texture filtering.
+			left -= 1; top -= 1; right += 1; bottom += 1;
+		}
+
+		if (!batch.Barrier && cmd.mType == DrawTypeTriangles)
+		{
+			unsigned stop = numBatches > MAX_LOOKBACK ? numBatches - MAX_LOOKBACK : 0;
+			for (unsigned b = numBatches; b-- > stop; )
+			{
+				auto &prev = batches[b];
+				if (prev.Barrier) break;
+
+				auto &prevcmd = mData[prev.First];
+				if (prevcmd.mType == DrawTypeTriangles && cmd.isCompatible(prevcmd))
+				{
+					nextCommand[prev.Last] = i;
+					prev.Last = i;
+					prev.Bounds[0] = min(prev.Bounds[0], batch.Bounds[0]);
+					prev.Bounds[1] = min(prev.Bounds[1], batch.Bounds[1]);
+					prev.Bounds[2] = max(prev.Bounds[2], batch.Bounds[2]);
+					prev.Bounds[3] = max(prev.Bounds[3], batch.Bounds[3]);
+					merged = true;
+					batch.First = -1;
+					break;
+				}
+				if (prev.Bounds[0] < batch.Bounds[2] && batch.Bounds[0] < prev.Bounds[2] &&
+					prev.Bounds[1] < batch.Bounds[3] && batch.Bounds[1] < prev.Bounds[3])
+				{
+					// Moving the command past this one would change what is visible.
+					break;
+				}
+			}
+		}
+		if (batch.First >= 0) batches[numBatches++] = batch;
+	}
+
+	if (!merged) return;
+
+	TArray<RenderCommand> commands(numBatches, false);
+	TArray<int> indices(mIndices.Size(), false);
+	for (unsigned b = 0; b < numBatches; b++)
+	{
+		RenderCommand cmd = mData[batches[b].First];
+		int firstIndex = indices.Size();
+		for (int c = batches[b].First; c >= 0; c = nextCommand[c])
+		{
+			auto &src = mData[c];
+			if (src.mIndexCount > 0)
+			{
+				memcpy(&indices[indices.Reserve(src.mIndexCount)], &mIndices[src.mIndexIndex], src.mIndexCount * sizeof(int));
+			}
+		}
+		cmd.mIndexIndex = firstIndex;
+		cmd.mIndexCount = indices.Size() - firstIndex;
+		commands.Push(cmd);
+	}
+	mData = std::move(commands);
+	mIndices = std::move(indices);
+}
+
+//==========================================================================
+//
+// Cached layers let static parts of a HUD skip being drawn every frame.
+// If the layer was recorded with the same key and the drawer is in the
+// same state, its output is appended and false gets returned. Otherwise
+// everything drawn until EndCachedLayer gets recorded. The key must
+// change whenever anything that affects the layer's content changes.
+//
+//==========================================================================
+
+bool F2DDrawer::BeginCachedLayer(FName name, uint32_t key)
+{
+	if (!hw_2dlayercache || mRecordingLayer != nullptr || locked) return true;
+
+	auto &layer = mCachedLayers[name];
+	if (layer.Valid && layer.Key == key && layer.Width == Width && layer.Height == Height &&
+		layer.ScreenFade == screenFade && layer.Offset == offset && !memcmp(&layer.Transform, &transform, sizeof(transform)))
+	{
+		unsigned vertexBase = mVertices.Size();
+		unsigned indexBase = mIndices.Size();
+
+		mVertices.Append(layer.Vertices);
+		mIndices.Reserve(layer.Indices.Size());
+		for (unsigned i = 0; i < layer.Indices.Size(); i++)
+		{
+			mIndices[indexBase + i] = layer.Indices[i] + vertexBase;
+		}
+		for (auto &cmd : layer.Commands)
+		{
+			auto &newcmd = mData[mData.Push(cmd)];
+			newcmd.mVertIndex += vertexBase;
+			newcmd.mIndexIndex += indexBase;
+		}
+		mMergeBarrier = mData.Size();
+		return false;
+	}
+
+	layer.Valid = false;
+	layer.Key = key;
+	layer.Width = Width;
+	layer.Height = Height;
+	layer.ScreenFade = screenFade;
+	layer.Offset = offset;
+	layer.Transform = transform;
+	mRecordingLayer = &layer;
+	mLayerCommand = mData.Size();
+	mLayerVertex = mVertices.Size();
+	mLayerIndex = mIndices.Size();
+	// The first command of the layer must not be merged into what came before it.
+	mMergeBarrier = mData.Size();
+	return true;
+}
+
+void F2DDrawer::EndCachedLayer()
+{
+	auto layer = mRecordingLayer;
+	if (layer == nullptr) return;
+	mRecordingLayer = nullptr;
+	mMergeBarrier = mData.Size();
+
+	layer->Commands.Clear();
+	layer->Vertices.Clear();
+	layer->Indices.Clear();
+	for (unsigned i = mLayerCommand; i < mData.Size(); i++)
+	{
+		// Shapes keep their own vertex buffers which may change at any time.
+		if (mData[i].shape2DBufInfo != nullptr) return;
+		auto &cmd = layer->Commands[layer->Commands.Push(mData[i])];
+		cmd.mVertIndex -= mLayerVertex;
+		cmd.mIndexIndex -= mLayerIndex;
+	}
+	layer->Vertices.Resize(mVertices.Size() - mLayerVertex);
+	for (unsigned i = 0; i < layer->Vertices.Size(); i++)
+	{
+		layer->Vertices[i] = mVertices[mLayerVertex + i];
+	}
+	layer->Indices.Resize(mIndices.Size() - mLayerIndex);
+	for (unsigned i = 0; i < layer->Indices.Size(); i++)
+	{
+		layer->Indices[i] = mIndices[mLayerIndex + i] - mLayerVertex;
+	}
+	layer->Valid = true;
+}
+
+void F2DDrawer::ClearCachedLayers()
+{
+	mRecordingLayer = nullptr;
+	mCachedLayers.Clear();
+}
+
 //==========================================================================
 //
 //
@@ -190,9 +190,27 @@ public:
 		}
 	};
 
+	// A block of 2D output that gets replayed in later frames instead of being drawn again.
+	struct FCachedLayer
+	{
+		TArray<RenderCommand> Commands;
+		TArray<TwoDVertex> Vertices;
+		TArray<int> Indices;
+		uint32_t Key = 0;
+		int Width = 0, Height = 0;
+		float ScreenFade = 0;
+		DVector2 Offset;
+		DMatrix3x3 Transform;
+		bool Valid = false;
+	};
+
 	TArray<int> mIndices;
 	TArray<TwoDVertex> mVertices;
 	TArray<RenderCommand> mData;
+	TMap<FName, FCachedLayer> mCachedLayers;
+	FCachedLayer *mRecordingLayer = nullptr;
+	unsigned mLayerCommand = 0, mLayerVertex = 0, mLayerIndex = 0;
+	unsigned mMergeBarrier = 0;	// commands before this index must not be merged with new ones.
 	int Width, Height;
 	bool isIn2D = false;
 	bool locked = false;	// prevents clearing of the data so it can be reused multiple times (useful for screen fades)
@@ -238,6 +256,10 @@ public:
 	void AddClearStencil();
 
 	void Clear();
+	void OptimizeBatches();
+	bool BeginCachedLayer(FName name, uint32_t key);
+	void EndCachedLayer();
+	void ClearCachedLayers();
 	void Lock() { locked = true; }
 	void SetScreenFade(float factor) { screenFade = factor; }
 	void Unlock() { locked = false; }
@@ -1965,6 +1965,24 @@ DEFINE_ACTION_FUNCTION(FCanvas, SetTransform)
 	return 0;
 }
 
+DEFINE_ACTION_FUNCTION(_Screen, BeginCachedLayer)
+{
+	PARAM_PROLOGUE;
+	PARAM_NAME(name);
+	PARAM_INT(key);
+
+	if (!twod->HasBegun2D()) ThrowAbortException(X_OTHER, "Attempt to draw to screen outside a draw function");
+
+	ACTION_RETURN_BOOL(twod->BeginCachedLayer(name, key));
+}
+
+DEFINE_ACTION_FUNCTION(_Screen, EndCachedLayer)
+{
+	PARAM_PROLOGUE;
+	twod->EndCachedLayer();
+	return 0;
+}
+
 DEFINE_ACTION_FUNCTION(_Screen, ClearTransform)
 {
 	PARAM_PROLOGUE;
@@ -36,6 +36,7 @@
 #include <stdlib.h>
 
 #include "oalsound.h"
+#include "softsound.h"
 
 #include "i_module.h"
 #include "i_interface.h"
@@ -269,6 +270,10 @@ void I_InitSound ()
 	{
 		GSnd = new NullSoundRenderer;
 	}
+	else if (stricmp(snd_backend, "soft") == 0)
+	{
+		GSnd = new SoftSoundRenderer;
+	}
 	else
 	{
 		#ifndef NO_OPENAL
@@ -496,3 +501,81 @@ SoundHandle SoundRenderer::LoadSoundVoc(uint8_t *sfxdata, int length)
 	return retval;
 }
 
+//==========================================================================
+//
+// SoundRenderer :: DecodeSound
+//
+// Decodes a sample in any format the decoders understand into PCM data
+// suitable for LoadSoundRaw, with the same loop point handling as the
+// renderer's LoadSound. Returns false if the data cannot be decoded.
+//
+//==========================================================================
+
+bool SoundRenderer::DecodeSound(FDecodedSound &result, const uint8_t *sfxdata, int length, int def_loop_start, int def_loop_end)
+{
+	uint32_t loop_start = 0, loop_end = ~0u;
+	zmusic_bool startass = false, endass = false;
+	ChannelConfig chans;
+	SampleType type;
+	int srate;
+
+	if (def_loop_start < 0)
+	{
+		FindLoopTags(sfxdata, length, &loop_start, &startass, &loop_end, &endass);
+	}
+	else
+	{
+		loop_start = def_loop_start;
+		loop_end = def_loop_end;
+		startass = endass = true;
+	}
+	auto decoder = CreateDecoder(sfxdata, length, true);
+	if (!decoder)
+		return false;
+
+	SoundDecoder_GetInfo(decoder, &srate, &chans, &type);
+	int channels = chans == ChannelConfig_Mono ? 1 : chans == ChannelConfig_Stereo ? 2 : 0;
+	int bits = type == SampleType_UInt8 ? 8 : type == SampleType_Int16 ? 16 : 0;
+	if (channels == 0 || bits == 0)
+	{
+		SoundDecoder_Close(decoder);
+		return false;
+	}
+
+	TArray<uint8_t> &data = result.Data;
+	unsigned total = 0;
+	unsigned got;
+
+	data.Resize(total + 32768);
+	while ((got = (unsigned)SoundDecoder_Read(decoder, (char*)&data[total], data.Size() - total)) > 0)
+	{
+		total += got;
+		data.Resize(total * 2);
+	}
+	SoundDecoder_Close(decoder);
+	data.Resize(total);
+	if (total == 0)
+		return false;
+
+	if (!startass) loop_start = Scale(loop_start, srate, 1000);
+	if (!endass && loop_end != ~0u) loop_end = Scale(loop_end, srate, 1000);
+	const uint32_t samples = total / (channels * bits / 8);
+	if (loop_start > samples) loop_start = 0;
+	if (loop_end > samples) loop_end = samples;
+
+	result.Frequency = srate;
+	result.Channels = channels;
+	result.Bits = bits;
+	if ((loop_start > 0 || loop_end > 0) && loop_end > loop_start && !(loop_start == 0 && loop_end == samples))
+	{
+		result.LoopStart = loop_start;
+		result.LoopEnd = loop_end;
+	}
+	else
+	{
+		result.LoopStart = 0;
+		result.LoopEnd = -1;
+	}
+	return true;
+}
+
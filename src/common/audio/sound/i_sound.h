@@ -96,6 +96,17 @@ typedef bool (*SoundStreamCallback)(SoundStream *stream, void *buff, int len, vo
 struct SoundDecoder;
 class MIDIDevice;
 
+// PCM data of a sound effect, decoded ahead of time so that only the upload through LoadSoundRaw is left to do.
+struct FDecodedSound
+{
+	TArray<uint8_t> Data;
+	int Frequency = 0;
+	int Channels = 0;
+	int Bits = 0;
+	int LoopStart = 0;
+	int LoopEnd = -1;
+};
+
 class SoundRenderer
 {
 public:
@@ -103,11 +114,13 @@ public:
 	virtual ~SoundRenderer ();
 
 	virtual bool IsNull() { return false; }
+	virtual bool NeedsSyncLoads() { return false; }	// sounds must be loaded when they start, not when a worker gets to them
 	virtual void SetSfxVolume (float volume) = 0;
 	virtual void SetMusicVolume (float volume) = 0;
 	virtual SoundHandle LoadSound(uint8_t *sfxdata, int length, int def_loop_start, int def_loop_end) = 0;
 	SoundHandle LoadSoundVoc(uint8_t *sfxdata, int length);
 	virtual SoundHandle LoadSoundRaw(uint8_t *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend = -1) = 0;
+	static bool DecodeSound(FDecodedSound &result, const uint8_t *sfxdata, int length, int def_loop_start, int def_loop_end);	// does not touch the device so it may be called from any thread
 	virtual void UnloadSound (SoundHandle sfx) = 0;	// unloads a sound from memory
 	virtual unsigned int GetMSLength(SoundHandle sfx) = 0;	// Gets the length of a sound at its default frequency
 	virtual unsigned int GetSampleLength(SoundHandle sfx) = 0;	// Gets the length of a sound at its default frequency
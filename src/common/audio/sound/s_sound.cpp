@@ -35,6 +35,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <atomic>
+#include <future>
 
 
 #include "s_soundinternal.h"
@@ -45,12 +47,14 @@
 #include "printf.h"
 #include "c_cvars.h"
 #include "gamestate.h"
+#include "ctpl.h"
 
 CVARD(Bool, snd_enabled, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG, "enables/disables sound effects")
 CVAR(Bool, i_soundinbackground, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 CVAR(Bool, i_pauseinbackground, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 // killough 2/21/98: optionally use varying pitched sounds
 CVAR(Bool, snd_pitched, false, CVAR_ARCHIVE)
+CVAR(Bool, snd_asyncload, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
 int SoundEnabled()
 {
@@ -106,6 +110,7 @@ void SoundEngine::Shutdown ()
 	FSoundChan *chan, *next;
 
 	StopAllChannels();
+	CancelSoundLoads();
 
 	for (chan = FreeChannels; chan != NULL; chan = next)
 	{
@@ -179,7 +184,7 @@ void SoundEngine::CacheSound (sfxinfo_t *sfx)
 		}
 		else
 		{
-			LoadSound(sfx);
+			if (!QueueSoundLoad(sfx)) LoadSound(sfx);
 			sfx->bUsed = true;
 		}
 	}
@@ -514,8 +519,9 @@ FSoundChan *SoundEngine::StartSound(int type, const void *source,
 		return NULL;
 	}
 
-	// Make sure the sound is loaded.
-	sfx = LoadSound(sfx);
+	// Make sure the sound is loaded. If it is still being decoded the channel starts out evicted.
+	bool loading = QueueSoundLoad(sfx);
+	if (!loading) sfx = LoadSound(sfx);
 
 	// The empty sound never plays.
 	if (sfx->lumpnum == sfx_empty)
@@ -572,6 +578,13 @@ FSoundChan *SoundEngine::StartSound(int type, const void *source,
 	{
 		chan = NULL;
 	}
+	else if (loading)
+	{
+		// RestoreEvictedChannels will start it at the right offset once the data is there.
+		chan = (FSoundChan*)GetChannel(NULL);
+		GSnd->MarkStartTime(chan, startTime);
+		chanflags |= CHANF_EVICTED | CHANF_LOADING;
+	}
 	else 
 	{
 		int startflags = 0;
@@ -654,6 +667,12 @@ void SoundEngine::RestartChannel(FSoundChan *chan)
 	if (sfx->bSingular && CheckSingular(chan->SoundID))
 		return;
 
+	chan->ChanFlags &= ~CHANF_LOADING;
+	if (QueueSoundLoad(sfx))
+	{
+		chan->ChanFlags |= CHANF_LOADING;
+		return;
+	}
 	sfx = LoadSound(sfx);
 
 	// The empty sound never plays.
@@ -718,8 +737,6 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 
 	while (!sfx->data.isValid())
 	{
-		unsigned int i;
-
 		if (sfx->lumpnum == sfx_empty)
 		{
 			return sfx;
@@ -727,51 +744,27 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 
 		// See if there is another sound already initialized with this lump. If so,
 		// then set this one up as a link, and don't load the sound again.
-		for (i = 0; i < S_sfx.Size(); i++)
+		int i = FindSharedSound(sfx);
+		if (i >= 0)
 		{
-			if (S_sfx[i].data.isValid() && S_sfx[i].link == sfxinfo_t::NO_LINK && S_sfx[i].lumpnum == sfx->lumpnum &&
-				(!sfx->bLoadRAW || (sfx->RawRate == S_sfx[i].RawRate)))	// Raw sounds with different sample rates may not share buffers, even if they use the same source data.
-			{
-				DPrintf (DMSG_NOTIFY, "Linked %s to %s (%d)\n", sfx->name.GetChars(), S_sfx[i].name.GetChars(), i);
-				sfx->link = FSoundID::fromInt(i);
-				// This is necessary to avoid using the rolloff settings of the linked sound if its
-				// settings are different.
-				if (sfx->Rolloff.MinDistance == 0) sfx->Rolloff = S_Rolloff;
-				return &S_sfx[i];
-			}
+			DPrintf (DMSG_NOTIFY, "Linked %s to %s (%d)\n", sfx->name.GetChars(), S_sfx[i].name.GetChars(), i);
+			sfx->link = FSoundID::fromInt(i);
+			// This is necessary to avoid using the rolloff settings of the linked sound if its
+			// settings are different.
+			if (sfx->Rolloff.MinDistance == 0) sfx->Rolloff = S_Rolloff;
+			return &S_sfx[i];
+		}
+
+		// If a worker is already decoding this lump, use its result instead of doing it twice.
+		if (WaitForSoundLoad(sfx))
+		{
+			continue;
 		}
 
 		DPrintf(DMSG_NOTIFY, "Loading sound \"%s\" (%td)\n", sfx->name.GetChars(), sfx - &S_sfx[0]);
 
 		auto sfxdata = ReadSound(sfx->lumpnum);
-		int size = (int)sfxdata.size();
-		if (size > 8)
-		{
-			auto sfxp = sfxdata.data();
-			int32_t dmxlen = LittleLong(((int32_t *)sfxp)[1]);
-			// If the sound is voc, use the custom loader.
-			if (size > 19 && memcmp (sfxp, "Creative Voice File", 19) == 0)
-			{
-				sfx->data = GSnd->LoadSoundVoc(sfxp, size);
-			}
-			// If the sound is raw, just load it as such.
-			else if (sfx->bLoadRAW)
-			{
-				sfx->data = GSnd->LoadSoundRaw(sfxp, size, sfx->RawRate, 1, 8, sfx->LoopStart);
-			}
-			// Otherwise, try the sound as DMX format.
-			else if (((uint8_t *)sfxp)[0] == 3 && ((uint8_t *)sfxp)[1] == 0 && dmxlen <= size - 8)
-			{
-				int frequency = LittleShort(((uint16_t *)sfxp)[1]);
-				if (frequency == 0) frequency = 11025;
-				sfx->data = GSnd->LoadSoundRaw(sfxp+8, dmxlen, frequency, 1, 8, sfx->LoopStart);
-			}
-			// If that fails, let the sound system try and figure it out.
-			else
-			{
-				sfx->data = GSnd->LoadSound(sfxp, size, sfx->LoopStart, sfx->LoopEnd);
-			}
-		}
+		LoadSoundData(sfx, sfxdata);
 
 		if (!sfx->data.isValid())
 		{
@@ -786,6 +779,217 @@ sfxinfo_t *SoundEngine::LoadSound(sfxinfo_t *sfx)
 	return sfx;
 }
 
+//==========================================================================
+//
+// Returns the index of a loaded sound that can share its data with sfx
+// or -1 if there is none.
+//
+//==========================================================================
+
+int SoundEngine::FindSharedSound(sfxinfo_t *sfx)
+{
+	for (unsigned i = 0; i < S_sfx.Size(); i++)
+	{
+		if (S_sfx[i].data.isValid() && S_sfx[i].link == sfxinfo_t::NO_LINK && S_sfx[i].lumpnum == sfx->lumpnum &&
+			(!sfx->bLoadRAW || (sfx->RawRate == S_sfx[i].RawRate)))	// Raw sounds with different sample rates may not share buffers, even if they use the same source data.
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+//==========================================================================
+//
+// Creates the sound's data from the lump contents.
+//
+//==========================================================================
+
+void SoundEngine::LoadSoundData(sfxinfo_t *sfx, TArray<uint8_t> &sfxdata)
+{
+	int size = (int)sfxdata.size();
+	if (size > 8)
+	{
+		auto sfxp = sfxdata.data();
+		int32_t dmxlen = LittleLong(((int32_t *)sfxp)[1]);
+		// If the sound is voc, use the custom loader.
+		if (size > 19 && memcmp (sfxp, "Creative Voice File", 19) == 0)
+		{
+			sfx->data = GSnd->LoadSoundVoc(sfxp, size);
+		}
+		// If the sound is raw, just load it as such.
+		else if (sfx->bLoadRAW)
+		{
+			sfx->data = GSnd->LoadSoundRaw(sfxp, size, sfx->RawRate, 1, 8, sfx->LoopStart);
+		}
+		// Otherwise, try the sound as DMX format.
+		else if (((uint8_t *)sfxp)[0] == 3 && ((uint8_t *)sfxp)[1] == 0 && dmxlen <= size - 8)
+		{
+			int frequency = LittleShort(((uint16_t *)sfxp)[1]);
+			if (frequency == 0) frequency = 11025;
+			sfx->data = GSnd->LoadSoundRaw(sfxp+8, dmxlen, frequency, 1, 8, sfx->LoopStart);
+		}
+		// If that fails, let the sound system try and figure it out.
+		else
+		{
+			sfx->data = GSnd->LoadSound(sfxp, size, sfx->LoopStart, sfx->LoopEnd);
+		}
+	}
+}
+
+//==========================================================================
+//
+// Background loading
+//
+// Only decoding runs on the workers. The result is handed to the sound
+// renderer on the main thread, in UpdateSounds or when somebody needs
+// the data right away.
+//
+//==========================================================================
+
+struct FSoundLoadJob
+{
+	int SfxIndex;
+	int LumpNum;
+	bool bLoadRAW;
+	int RawRate;
+	int LoopStart;
+	int LoopEnd;
+
+	std::atomic<bool> Cancelled = { false };
+	bool Failed = false;
+	TArray<uint8_t> Data;		// lump contents if they could not or need not be decoded on the worker.
+	FDecodedSound Decoded;
+	std::future<void> Finished;
+};
+
+static std::unique_ptr<ctpl::thread_pool> soundLoadPool;
+
+// Formats the engine converts itself are cheap, only the rest is worth decoding in the background.
+static bool NeedsDecoder(const uint8_t *sfxp, int size, bool loadraw)
+{
+	if (size <= 8 || loadraw) return false;
+	if (size > 19 && memcmp(sfxp, "Creative Voice File", 19) == 0) return false;
+	int32_t dmxlen = LittleLong(((const int32_t *)sfxp)[1]);
+	return !(sfxp[0] == 3 && sfxp[1] == 0 && dmxlen <= size - 8);
+}
+
+bool SoundEngine::QueueSoundLoad(sfxinfo_t *sfx)
+{
+	if (!snd_asyncload || GSnd == nullptr || GSnd->IsNull() || GSnd->NeedsSyncLoads() || sfx->data.isValid() || sfx->lumpnum == sfx_empty)
+		return false;
+
+	// LoadSound will only set up a link for these.
+	if (FindSharedSound(sfx) >= 0)
+		return false;
+
+	for (auto &job : PendingLoads)
+	{
+		if (job->LumpNum == sfx->lumpnum && job->bLoadRAW == sfx->bLoadRAW && (!sfx->bLoadRAW || job->RawRate == sfx->RawRate))
+			return true;
+	}
+
+	if (!soundLoadPool)
+	{
+		soundLoadPool.reset(new ctpl::thread_pool(2));
+	}
+	auto job = std::make_shared<FSoundLoadJob>();
+	job->SfxIndex = int(sfx - &S_sfx[0]);
+	job->LumpNum = sfx->lumpnum;
+	job->bLoadRAW = sfx->bLoadRAW;
+	job->RawRate = sfx->RawRate;
+	job->LoopStart = sfx->LoopStart;
+	job->LoopEnd = sfx->LoopEnd;
+	job->Finished = soundLoadPool->push([this, job](int) { RunSoundLoadJob(job.get()); });
+	PendingLoads.Push(job);
+	return true;
+}
+
+void SoundEngine::RunSoundLoadJob(FSoundLoadJob *job)
+{
+	if (job->Cancelled) return;
+	try
+	{
+		job->Data = ReadSound(job->LumpNum);
+		if (NeedsDecoder(job->Data.data(), (int)job->Data.size(), job->bLoadRAW) &&
+			SoundRenderer::DecodeSound(job->Decoded, job->Data.data(), (int)job->Data.size(), job->LoopStart, job->LoopEnd))
+		{
+			job->Data.Reset();
+		}
+	}
+	catch (...)
+	{
+		// Let the main thread retry synchronously so that errors get reported the normal way.
+		job->Failed = true;
+	}
+}
+
+void SoundEngine::FinishSoundLoad(FSoundLoadJob *job)
+{
+	if ((unsigned)job->SfxIndex >= S_sfx.Size()) return;
+	sfxinfo_t *sfx = &S_sfx[job->SfxIndex];
+
+	// Loaded some other way or redefined in the meantime.
+	if (sfx->data.isValid() || sfx->lumpnum != job->LumpNum) return;
+
+	if (job->Failed)
+	{
+		LoadSound(sfx);
+		return;
+	}
+	DPrintf(DMSG_NOTIFY, "Loading sound \"%s\" (%d) from background decoder\n", sfx->name.GetChars(), job->SfxIndex);
+	if (job->Decoded.Data.Size() > 0)
+	{
+		auto &d = job->Decoded;
+		sfx->data = GSnd->LoadSoundRaw(d.Data.Data(), d.Data.Size(), d.Frequency, d.Channels, d.Bits, d.LoopStart, d.LoopEnd);
+	}
+	else
+	{
+		LoadSoundData(sfx, job->Data);
+	}
+	if (!sfx->data.isValid())
+	{
+		sfx->lumpnum = sfx_empty;
+	}
+}
+
+bool SoundEngine::WaitForSoundLoad(sfxinfo_t *sfx)
+{
+	for (unsigned i = 0; i < PendingLoads.Size(); i++)
+	{
+		auto job = PendingLoads[i];
+		if (job->LumpNum == sfx->lumpnum && job->bLoadRAW == sfx->bLoadRAW && (!sfx->bLoadRAW || job->RawRate == sfx->RawRate))
+		{
+			PendingLoads.Delete(i);
+			job->Finished.wait();
+			FinishSoundLoad(job.get());
+			return true;
+		}
+	}
+	return false;
+}
+
+void SoundEngine::FinishSoundLoads()
+{
+	for (unsigned i = 0; i < PendingLoads.Size(); )
+	{
+		auto job = PendingLoads[i];
+		if (job->Finished.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			PendingLoads.Delete(i);
+			FinishSoundLoad(job.get());
+		}
+		else i++;
+	}
+}
+
+void SoundEngine::CancelSoundLoads()
+{
+	for (auto &job : PendingLoads) job->Cancelled = true;
+	for (auto &job : PendingLoads) job->Finished.wait();
+	PendingLoads.Clear();
+}
+
 //==========================================================================
 //
 // S_CheckSingular
@@ -1217,7 +1421,10 @@ void SoundEngine::RestoreEvictedChannel(FSoundChan *chan)
 		RestartChannel(chan);
 		if (!(chan->ChanFlags & CHANF_LOOP))
 		{
-			if (chan->ChanFlags & CHANF_EVICTED)
+			if (chan->ChanFlags & CHANF_LOADING)
+			{ // Waiting for its data, try again later.
+			}
+			else if (chan->ChanFlags & CHANF_EVICTED)
 			{ // Still evicted and not looping? Forget about it.
 				ReturnChannel(chan);
 			}
@@ -1259,6 +1466,8 @@ void SoundEngine::UpdateSounds(int time)
 {
 	FVector3 pos, vel;
 
+	FinishSoundLoads();
+
 	for (FSoundChan* chan = Channels; chan != NULL; chan = chan->NextChan)
 	{
 		if ((chan->ChanFlags & (CHANF_EVICTED | CHANF_IS3D)) == CHANF_IS3D)
@@ -1436,6 +1645,7 @@ void SoundEngine::StopChannel(FSoundChan *chan)
 
 void SoundEngine::UnloadAllSounds()
 {
+	CancelSoundLoads();
 	for (unsigned i = 0; i < S_sfx.Size(); i++)
 	{
 		UnloadSound(&S_sfx[i]);
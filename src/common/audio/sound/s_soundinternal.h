@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include "i_sound.h"
 #include "name.h"
 
@@ -180,6 +181,8 @@ ReverbContainer *S_FindEnvironment (const char *name);
 ReverbContainer *S_FindEnvironment (int id);
 void S_AddEnvironment (ReverbContainer *settings);
 
+struct FSoundLoadJob;
+
 class SoundEngine
 {
 protected:
@@ -199,6 +202,9 @@ protected:
 	TArray<FRandomSoundList> S_rnd;
 	bool blockNewSounds = false;
 
+	// sounds that are being decoded on worker threads.
+	TArray<std::shared_ptr<FSoundLoadJob>> PendingLoads;
+
 private:
 	void LinkChannel(FSoundChan* chan, FSoundChan** head);
 	void UnlinkChannel(FSoundChan* chan);
@@ -218,6 +224,13 @@ private:
 	bool CheckSingular(FSoundID sound_id);
 	virtual TArray<uint8_t> ReadSound(int lumpnum) = 0;
 
+	int FindSharedSound(sfxinfo_t* sfx);
+	void LoadSoundData(sfxinfo_t* sfx, TArray<uint8_t>& sfxdata);
+	void RunSoundLoadJob(FSoundLoadJob* job);
+	void FinishSoundLoad(FSoundLoadJob* job);
+	bool WaitForSoundLoad(sfxinfo_t* sfx);
+	void FinishSoundLoads();
+
 protected:
 	virtual bool CheckSoundLimit(sfxinfo_t* sfx, const FVector3& pos, int near_limit, float limit_range, int sourcetype, const void* actor, int channel, float attenuation);
 	virtual FSoundID ResolveSound(const void *ent, int srctype, FSoundID soundid, float &attenuation);
@@ -236,6 +249,13 @@ public:
 
 	virtual void StopChannel(FSoundChan* chan);
 	sfxinfo_t* LoadSound(sfxinfo_t* sfx);
+	// Starts decoding the sound on a worker thread. Returns false if it has to be loaded synchronously.
+	bool QueueSoundLoad(sfxinfo_t* sfx);
+	void CancelSoundLoads();
+	unsigned PendingSoundLoads() const
+	{
+		return PendingLoads.Size();
+	}
 	sfxinfo_t* GetWritableSfx(FSoundID snd)
 	{
 		if ((unsigned)snd.index() >= S_sfx.Size()) return nullptr;
@@ -0,0 +1,1144 @@
+/*
+** softsound.cpp
+** Software mixing sound renderer without an audio device
+**
+**---------------------------------------------------------------------------
+** Copyright 2008-2010 Chris Robinson
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#include <math.h>
+#include <chrono>
+
+#include "softsound.h"
+#include "s_soundinternal.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "v_text.h"
+#include "m_argv.h"
+#include "printf.h"
+#include "files.h"
+#include "i_time.h"
+#include "i_interface.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+#define SOFTSOUND_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <emmintrin.h>
+#endif
+
+EXTERN_CVAR(Int, snd_channels)
+EXTERN_CVAR(Int, snd_samplerate)
+
+// Mix by wall clock time instead of following the game tic. Not reproducible but closer to a real device.
+CVAR(Bool, snd_soft_realtime, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+#define AREA_SOUND_RADIUS  (32.f)
+
+#define PITCH_MULT (0.7937005f) /* Same as the OpenAL backend */
+
+//==========================================================================
+//
+// Sample and voice data
+//
+//==========================================================================
+
+struct FSoftSample
+{
+	TArray<float> Data;		// interleaved, followed by one guard frame for the interpolation
+	int Channels;
+	int Frequency;
+	int Frames;
+	int LoopStart;
+	int LoopEnd;
+};
+
+struct FSoftVoice
+{
+	FSoftSample *Sample;
+	FISoundChannel *Chan;
+	uint64_t Pos;			// 32.32 fixed point position in source frames
+	uint64_t Step;
+	float Volume;
+	float Pitch;
+	float Attenuation;
+	float PanLeft;
+	float PanRight;
+	int Flags;				// SNDF_* flags
+	bool Playing;
+	bool Is3D;
+	bool AreaSound;
+	bool SyncPaused;
+	FVector3 Position;
+};
+
+//==========================================================================
+//
+// SoftSoundStream
+//
+// Pulls data from the callback while the renderer mixes, so everything
+// stays on the thread calling UpdateSounds.
+//
+//==========================================================================
+
+class SoftSoundStream : public SoundStream
+{
+	friend class SoftSoundRenderer;
+
+	SoftSoundRenderer *Renderer;
+	SoundStreamCallback Callback;
+	void *UserData;
+	TArray<uint8_t> ReadBuffer;
+	TArray<float> Fifo;		// converted stereo frames that have not been played yet
+	int Flags;
+	int SampleRate;
+	uint64_t Pos = 0;		// 32.32 fixed point position in the fifo
+	uint64_t Step = 0;
+	uint64_t SamplesPlayed = 0;
+	float Volume = 1.f;
+	bool Playing = false;
+	bool Paused = false;
+	bool Ended = false;
+
+public:
+	SoftSoundStream(SoftSoundRenderer *renderer, SoundStreamCallback callback, int buffbytes, int flags, int samplerate, void *userdata)
+		: Renderer(renderer), Callback(callback), UserData(userdata), Flags(flags), SampleRate(samplerate)
+	{
+		ReadBuffer.Resize(buffbytes);
+	}
+
+	~SoftSoundStream()
+	{
+		if (Renderer != nullptr) Renderer->RemoveStream(this);
+	}
+
+	bool Play(bool looping, float volume) override
+	{
+		Playing = true;
+		Ended = false;
+		Volume = volume;
+		return true;
+	}
+
+	void Stop() override
+	{
+		Playing = false;
+		Fifo.Clear();
+		Pos = 0;
+	}
+
+	void SetVolume(float volume) override
+	{
+		Volume = volume;
+	}
+
+	bool SetPaused(bool paused) override
+	{
+		Paused = paused;
+		return true;
+	}
+
+	bool IsEnded() override
+	{
+		return !Playing;
+	}
+
+	Position GetPlayPosition() override
+	{
+		return { SamplesPlayed, std::chrono::nanoseconds(0) };
+	}
+
+	FString GetStats() override
+	{
+		FString stats;
+		stats.Format("Software stream, %d Hz, %u frames buffered", SampleRate, Fifo.Size() / 2);
+		return stats;
+	}
+
+private:
+	bool Refill();
+	void Mix(float *out, int frames, int outputrate, float volume);
+};
+
+//==========================================================================
+//
+// Reads one buffer from the callback and appends it as float stereo.
+//
+//==========================================================================
+
+bool SoftSoundStream::Refill()
+{
+	if (Ended || !Callback(this, ReadBuffer.Data(), ReadBuffer.Size(), UserData))
+	{
+		Ended = true;
+		return false;
+	}
+
+	int channels = (Flags & Mono) ? 1 : 2;
+	int bytes = (Flags & Bits8) ? 1 : (Flags & (Bits32 | Float)) ? 4 : 2;
+	int frames = ReadBuffer.Size() / (channels * bytes);
+	unsigned start = Fifo.Reserve(frames * 2);
+	float *dest = &Fifo[start];
+
+	for (int i = 0; i < frames * channels; i++)
+	{
+		float s;
+		if (bytes == 1) s = (ReadBuffer[i] - 128) * (1.f / 128.f);
+		else if (bytes == 2) s = ((int16_t*)ReadBuffer.Data())[i] * (1.f / 32768.f);
+		else if (Flags & Float) s = ((float*)ReadBuffer.Data())[i];
+		else s = ((int32_t*)ReadBuffer.Data())[i] * (1.f / 2147483648.f);
+
+		if (channels == 1)
+		{
+			dest[i * 2] = dest[i * 2 + 1] = s;
+		}
+		else
+		{
+			dest[i] = s;
+		}
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// Resamples linearly into the mix buffer.
+//
+//==========================================================================
+
+void SoftSoundStream::Mix(float *out, int frames, int outputrate, float volume)
+{
+	if (!Playing || Paused) return;
+
+	Step = (uint64_t(SampleRate) << 32) / outputrate;
+	float gain = Volume * volume;
+
+	for (int i = 0; i < frames; i++)
+	{
+		unsigned idx = unsigned(Pos >> 32);
+		while (idx + 1 >= Fifo.Size() / 2)
+		{
+			if (!Refill())
+			{
+				Playing = false;
+				Fifo.Clear();
+				Pos = 0;
+				return;
+			}
+		}
+		float frac = (Pos & 0xffffffff) * (1.f / 4294967296.f);
+		const float *src = &Fifo[idx * 2];
+		out[i * 2] += (src[0] + (src[2] - src[0]) * frac) * gain;
+		out[i * 2 + 1] += (src[1] + (src[3] - src[1]) * frac) * gain;
+		Pos += Step;
+	}
+
+	unsigned consumed = unsigned(Pos >> 32);
+	if (consumed > 0)
+	{
+		consumed = min(consumed, Fifo.Size() / 2);
+		Fifo.Delete(0, consumed * 2);
+		Pos -= uint64_t(consumed) << 32;
+		SamplesPlayed += consumed;
+	}
+}
+
+//==========================================================================
+//
+// SoftSoundRenderer
+//
+//==========================================================================
+
+SoftSoundRenderer::SoftSoundRenderer()
+{
+	OutputRate = *snd_samplerate != 0 ? *snd_samplerate : 44100;
+
+	// The voice array is never resized because channels point into it.
+	Voices.Resize(max<int>(snd_channels, 2));
+	memset(Voices.Data(), 0, Voices.Size() * sizeof(FSoftVoice));
+	for (int i = Voices.Size() - 1; i >= 0; i--)
+	{
+		FreeVoices.Push(&Voices[i]);
+	}
+
+	const char *outfile = Args->CheckValue("-soundout");
+	if (outfile != nullptr)
+	{
+		OpenWaveFile(outfile);
+	}
+	LastUpdateTime = I_nsTime();
+	Printf("I_InitSound: Initializing software mixer at %d Hz, %u voices\n", OutputRate, Voices.Size());
+}
+
+SoftSoundRenderer::~SoftSoundRenderer()
+{
+	for (auto stream : Streams)
+	{
+		stream->Renderer = nullptr;
+	}
+	CloseWaveFile();
+}
+
+bool SoftSoundRenderer::IsValid()
+{
+	return true;
+}
+
+void SoftSoundRenderer::SetSfxVolume(float volume)
+{
+	SfxVolume = volume;
+}
+
+void SoftSoundRenderer::SetMusicVolume(float volume)
+{
+	MusicVolume = volume;
+}
+
+float SoftSoundRenderer::GetOutputRate()
+{
+	return (float)OutputRate;
+}
+
+//==========================================================================
+//
+// Samples
+//
+//==========================================================================
+
+SoundHandle SoftSoundRenderer::LoadSound(uint8_t *sfxdata, int length, int def_loop_start, int def_loop_end)
+{
+	SoundHandle retval = { nullptr };
+	FDecodedSound decoded;
+
+	if (!DecodeSound(decoded, sfxdata, length, def_loop_start, def_loop_end))
+		return retval;
+
+	return LoadSoundRaw(decoded.Data.Data(), decoded.Data.Size(), decoded.Frequency, decoded.Channels, decoded.Bits, decoded.LoopStart, decoded.LoopEnd);
+}
+
+SoundHandle SoftSoundRenderer::LoadSoundRaw(uint8_t *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend)
+{
+	SoundHandle retval = { nullptr };
+
+	if (length == 0) return retval;
+
+	int bytes = abs(bits) / 8;
+	if ((bits != 8 && bits != -8 && bits != 16) || (channels != 1 && channels != 2) || frequency <= 0)
+	{
+		Printf("Unhandled format: %d bit, %d channel, %d hz\n", bits, channels, frequency);
+		return retval;
+	}
+
+	int frames = length / (channels * bytes);
+	if (frames == 0) return retval;
+
+	auto sample = new FSoftSample;
+	sample->Channels = channels;
+	sample->Frequency = frequency;
+	sample->Frames = frames;
+	sample->Data.Resize((frames + 1) * channels);
+
+	float *dest = sample->Data.Data();
+	for (int i = 0; i < frames * channels; i++)
+	{
+		if (bits == 16) dest[i] = ((int16_t*)sfxdata)[i] * (1.f / 32768.f);
+		else if (bits == 8) dest[i] = (sfxdata[i] - 128) * (1.f / 128.f);
+		else dest[i] = int8_t(sfxdata[i]) * (1.f / 128.f);
+	}
+	for (int c = 0; c < channels; c++)
+	{
+		dest[frames * channels + c] = dest[(frames - 1) * channels + c];
+	}
+
+	if (loopstart < 0 || loopstart >= frames) loopstart = 0;
+	if (loopend <= loopstart || loopend > frames) loopend = frames;
+	sample->LoopStart = loopstart;
+	sample->LoopEnd = loopend;
+
+	retval.data = sample;
+	return retval;
+}
+
+void SoftSoundRenderer::UnloadSound(SoundHandle sfx)
+{
+	if (sfx.data == nullptr) return;
+
+	auto sample = (FSoftSample*)sfx.data;
+	for (auto &voice : Voices)
+	{
+		if (voice.Playing && voice.Sample == sample)
+		{
+			StopChannel(voice.Chan);
+		}
+	}
+	delete sample;
+}
+
+unsigned int SoftSoundRenderer::GetMSLength(SoundHandle sfx)
+{
+	if (sfx.data == nullptr) return 0;
+	auto sample = (FSoftSample*)sfx.data;
+	return unsigned(uint64_t(sample->Frames) * 1000 / sample->Frequency);
+}
+
+unsigned int SoftSoundRenderer::GetSampleLength(SoundHandle sfx)
+{
+	if (sfx.data == nullptr) return 0;
+	return ((FSoftSample*)sfx.data)->Frames;
+}
+
+//==========================================================================
+//
+// Streams
+//
+//==========================================================================
+
+SoundStream *SoftSoundRenderer::CreateStream(SoundStreamCallback callback, int buffbytes, int flags, int samplerate, void *userdata)
+{
+	if (buffbytes <= 0 || samplerate <= 0) return nullptr;
+
+	auto stream = new SoftSoundStream(this, callback, buffbytes, flags, samplerate, userdata);
+	Streams.Push(stream);
+	return stream;
+}
+
+void SoftSoundRenderer::RemoveStream(SoftSoundStream *stream)
+{
+	unsigned index = Streams.Find(stream);
+	if (index < Streams.Size()) Streams.Delete(index);
+}
+
+//==========================================================================
+//
+// Voice allocation
+//
+//==========================================================================
+
+FSoftVoice *SoftSoundRenderer::AllocVoice()
+{
+	FSoftVoice *voice;
+	if (!FreeVoices.Pop(voice)) return nullptr;
+	return voice;
+}
+
+void SoftSoundRenderer::FreeVoice(FSoftVoice *voice)
+{
+	voice->Playing = false;
+	voice->Chan = nullptr;
+	voice->Sample = nullptr;
+	FreeVoices.Push(voice);
+}
+
+FSoundChan *SoftSoundRenderer::FindLowestChannel()
+{
+	FSoundChan *schan = soundEngine->GetChannels();
+	FSoundChan *lowest = nullptr;
+	while (schan)
+	{
+		if (schan->SysChannel != nullptr)
+		{
+			if (!lowest || schan->Priority < lowest->Priority ||
+				(schan->Priority == lowest->Priority &&
+				schan->DistanceSqr > lowest->DistanceSqr))
+				lowest = schan;
+		}
+		schan = schan->NextChan;
+	}
+	return lowest;
+}
+
+void SoftSoundRenderer::SetVoicePitch(FSoftVoice *voice)
+{
+	float pitch = voice->Pitch;
+	if (WasInWater && !(voice->Flags & SNDF_NOREVERB) && !(voice->Chan && (voice->Chan->ChanFlags & CHANF_UI)))
+		pitch *= PITCH_MULT;
+
+	double step = double(voice->Sample->Frequency) / OutputRate * pitch;
+	voice->Step = max<uint64_t>(uint64_t(step * 4294967296.0), 1);
+}
+
+//==========================================================================
+//
+// Common part of StartSound and StartSound3D
+//
+//==========================================================================
+
+void SoftSoundRenderer::SetupVoice(FSoftVoice *voice, FSoftSample *sample, float vol, float pitch, int chanflags, FISoundChannel *reuse_chan, float startTime)
+{
+	voice->Sample = sample;
+	voice->Volume = vol;
+	voice->Pitch = max(pitch, 0.0001f);
+	voice->Flags = chanflags;
+	voice->Playing = true;
+	voice->SyncPaused = false;
+
+	double offset = 0;
+	if (!reuse_chan || reuse_chan->StartTime == 0)
+	{
+		double sfxlength = double(sample->Frames) / sample->Frequency;
+		offset = (chanflags & SNDF_LOOP)
+			? (sfxlength > 0 ? fmod(startTime, sfxlength) : 0)
+			: clamp<double>(startTime, 0., sfxlength);
+		offset *= sample->Frequency;
+	}
+	else if (chanflags & SNDF_ABSTIME)
+	{
+		offset = double(reuse_chan->StartTime);
+	}
+	else if (MixedFrames > reuse_chan->StartTime)
+	{
+		// Start times are in output frames of the mixer's own clock.
+		offset = double(MixedFrames - reuse_chan->StartTime) * sample->Frequency / OutputRate;
+	}
+	if (chanflags & SNDF_LOOP)
+	{
+		offset = fmod(offset, double(sample->Frames));
+	}
+	voice->Pos = uint64_t(min(offset, double(sample->Frames)) * 4294967296.0);
+}
+
+//==========================================================================
+//
+// Equal power panning relative to the listener. Sounds very close to
+// the listener move towards the center, like OpenAL's source radius.
+//
+//==========================================================================
+
+void SoftSoundRenderer::UpdatePan(FSoftVoice *voice)
+{
+	float pan = 0;
+	if (voice->Is3D)
+	{
+		FVector3 dir = voice->Position - ListenerPos;
+		float dist = dir.Length();
+		if (dist >= 0.0004f)
+		{
+			// The listener's right vector in sound coordinates.
+			pan = (dir.X * sinf(ListenerAngle) - dir.Z * cosf(ListenerAngle)) / dist;
+			if (voice->AreaSound && dist < AREA_SOUND_RADIUS)
+				pan *= dist / AREA_SOUND_RADIUS;
+		}
+	}
+	else if (voice->Sample->Channels == 2)
+	{
+		voice->PanLeft = voice->PanRight = 1.f;
+		return;
+	}
+	float angle = (clamp(pan, -1.f, 1.f) + 1.f) * float(M_PI / 4);
+	voice->PanLeft = cosf(angle);
+	voice->PanRight = sinf(angle);
+}
+
+//==========================================================================
+//
+// Starting and stopping
+//
+//==========================================================================
+
+FISoundChannel *SoftSoundRenderer::StartSound(SoundHandle sfx, float vol, float pitch, int chanflags, FISoundChannel *reuse_chan, float startTime)
+{
+	if (sfx.data == nullptr) return nullptr;
+
+	FSoftVoice *voice = AllocVoice();
+	if (voice == nullptr)
+	{
+		FSoundChan *lowest = FindLowestChannel();
+		if (lowest)
+		{
+			StopChannel(lowest);
+			Evictions++;
+		}
+		voice = AllocVoice();
+		if (voice == nullptr)
+		{
+			Rejections++;
+			return nullptr;
+		}
+	}
+
+	voice->Is3D = false;
+	voice->AreaSound = false;
+	voice->Attenuation = 1.f;
+	SetupVoice(voice, (FSoftSample*)sfx.data, vol, pitch, chanflags, reuse_chan, startTime);
+	UpdatePan(voice);
+
+	FISoundChannel *chan = reuse_chan;
+	if (!chan) chan = soundEngine->GetChannel(voice);
+	else chan->SysChannel = voice;
+	voice->Chan = chan;
+	SetVoicePitch(voice);
+
+	chan->Rolloff.RolloffType = ROLLOFF_Log;
+	chan->Rolloff.RolloffFactor = 0.f;
+	chan->Rolloff.MinDistance = 1.f;
+	chan->DistanceSqr = 0.f;
+	chan->ManualRolloff = false;
+
+	return chan;
+}
+
+FISoundChannel *SoftSoundRenderer::StartSound3D(SoundHandle sfx, SoundListener *listener, float vol,
+	FRolloffInfo *rolloff, float distscale, float pitch, int priority, const FVector3 &pos, const FVector3 &vel,
+	int channum, int chanflags, FISoundChannel *reuse_chan, float startTime)
+{
+	if (sfx.data == nullptr) return nullptr;
+
+	float dist_sqr = (float)(pos - listener->position).LengthSquared();
+
+	FSoftVoice *voice = AllocVoice();
+	if (voice == nullptr)
+	{
+		// Same rules as the OpenAL backend so that eviction counts are comparable.
+		FSoundChan *lowest = FindLowestChannel();
+		if (lowest)
+		{
+			if (lowest->Priority < priority || (lowest->Priority == priority &&
+				lowest->DistanceSqr > dist_sqr))
+			{
+				StopChannel(lowest);
+				Evictions++;
+			}
+		}
+		voice = AllocVoice();
+		if (voice == nullptr)
+		{
+			Rejections++;
+			return nullptr;
+		}
+	}
+
+	ListenerPos = listener->position;
+	ListenerAngle = listener->angle;
+
+	voice->Is3D = true;
+	voice->AreaSound = !!(chanflags & SNDF_AREA);
+	voice->Position = pos;
+	voice->Attenuation = soundEngine->GetRolloff(rolloff, sqrtf(dist_sqr) * distscale);
+	SetupVoice(voice, (FSoftSample*)sfx.data, vol, pitch, chanflags, reuse_chan, startTime);
+	UpdatePan(voice);
+
+	FISoundChannel *chan = reuse_chan;
+	if (!chan) chan = soundEngine->GetChannel(voice);
+	else chan->SysChannel = voice;
+	voice->Chan = chan;
+	SetVoicePitch(voice);
+
+	chan->Rolloff = *rolloff;
+	chan->DistanceSqr = dist_sqr;
+	chan->ManualRolloff = true;
+
+	return chan;
+}
+
+void SoftSoundRenderer::StopChannel(FISoundChannel *chan)
+{
+	if (chan == nullptr || chan->SysChannel == nullptr)
+		return;
+
+	auto voice = (FSoftVoice*)chan->SysChannel;
+	// Release first, so it can be properly marked as evicted if it's being killed
+	soundEngine->ChannelEnded(chan);
+
+	if (!(chan->ChanFlags & CHANF_EVICTED))
+		soundEngine->SoundDone(chan);
+
+	FreeVoice(voice);
+}
+
+void SoftSoundRenderer::ChannelVolume(FISoundChannel *chan, float volume)
+{
+	if (chan == nullptr || chan->SysChannel == nullptr)
+		return;
+
+	((FSoftVoice*)chan->SysChannel)->Volume = volume;
+}
+
+void SoftSoundRenderer::ChannelPitch(FISoundChannel *chan, float pitch)
+{
+	if (chan == nullptr || chan->SysChannel == nullptr)
+		return;
+
+	auto voice = (FSoftVoice*)chan->SysChannel;
+	voice->Pitch = max(pitch, 0.0001f);
+	SetVoicePitch(voice);
+}
+
+unsigned int SoftSoundRenderer::GetPosition(FISoundChannel *chan)
+{
+	if (chan == nullptr || chan->SysChannel == nullptr)
+		return 0;
+
+	return unsigned(((FSoftVoice*)chan->SysChannel)->Pos >> 32);
+}
+
+void SoftSoundRenderer::MarkStartTime(FISoundChannel *chan, float startTime)
+{
+	// The mixer clock is exact, so no need to look at the system time here.
+	uint64_t offset = uint64_t(max(startTime, 0.f) * OutputRate);
+	chan->StartTime = MixedFrames > offset ? MixedFrames - offset : 1;
+}
+
+float SoftSoundRenderer::GetAudibility(FISoundChannel *chan)
+{
+	if (chan == nullptr || chan->SysChannel == nullptr)
+		return 0.f;
+
+	auto voice = (FSoftVoice*)chan->SysChannel;
+	return SfxVolume * voice->Volume * soundEngine->GetRolloff(&chan->Rolloff, sqrtf(chan->DistanceSqr) * chan->DistanceScale);
+}
+
+//==========================================================================
+//
+// Pausing
+//
+//==========================================================================
+
+void SoftSoundRenderer::Sync(bool sync)
+{
+	for (auto &voice : Voices)
+	{
+		if (voice.Playing) voice.SyncPaused = sync;
+	}
+}
+
+void SoftSoundRenderer::SetSfxPaused(bool paused, int slot)
+{
+	if (paused) SFXPaused |= 1 << slot;
+	else SFXPaused &= ~(1 << slot);
+}
+
+void SoftSoundRenderer::SetInactive(SoundRenderer::EInactiveState state)
+{
+	Inactive = state;
+}
+
+//==========================================================================
+//
+// Positional updates
+//
+//==========================================================================
+
+void SoftSoundRenderer::UpdateSoundParams3D(SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel)
+{
+	if (chan == nullptr || chan->SysChannel == nullptr)
+		return;
+
+	float dist_sqr = (float)(pos - listener->position).LengthSquared();
+	chan->DistanceSqr = dist_sqr;
+
+	auto voice = (FSoftVoice*)chan->SysChannel;
+	voice->Position = pos;
+	voice->AreaSound = areasound;
+	voice->Attenuation = soundEngine->GetRolloff(&chan->Rolloff, sqrtf(dist_sqr) * chan->DistanceScale);
+	UpdatePan(voice);
+}
+
+void SoftSoundRenderer::UpdateListener(SoundListener *listener)
+{
+	if (!listener->valid)
+		return;
+
+	ListenerPos = listener->position;
+	ListenerAngle = listener->angle;
+
+	const ReverbContainer *env = listener->Environment;
+	if (!env) env = DefaultEnvironments[0];
+
+	// No reverb here, only the pitch change the OpenAL backend applies under water.
+	bool inwater = listener->underwater || (env && env->SoftwareWater);
+	bool changed = inwater != WasInWater;
+	WasInWater = inwater;
+
+	for (auto &voice : Voices)
+	{
+		if (!voice.Playing) continue;
+		if (changed) SetVoicePitch(&voice);
+		if (voice.Is3D) UpdatePan(&voice);
+	}
+}
+
+//==========================================================================
+//
+// Resamples one voice into VoiceBuffer and adds it to the mix.
+// Returns true if a non-looping voice has reached its end.
+//
+//==========================================================================
+
+bool SoftSoundRenderer::MixVoice(FSoftVoice *voice, float *out, int frames)
+{
+	FSoftSample *sample = voice->Sample;
+	bool loop = !!(voice->Flags & SNDF_LOOP);
+	uint64_t end = uint64_t(loop ? sample->LoopEnd : sample->Frames) << 32;
+	unsigned wrapat = loop ? sample->LoopEnd : ~0u;
+	unsigned wrapto = sample->LoopStart;
+	bool stereo = sample->Channels == 2;
+	bool downmix = stereo && voice->Is3D;
+	const float *src = sample->Data.Data();
+	float *dest = VoiceBuffer.Data();
+	bool finished = false;
+	int done = 0;
+
+	while (done < frames)
+	{
+		if (voice->Pos >= end)
+		{
+			if (!loop)
+			{
+				finished = true;
+				break;
+			}
+			voice->Pos -= uint64_t(sample->LoopEnd - sample->LoopStart) << 32;
+			continue;
+		}
+
+		int count = (int)min<uint64_t>(frames - done, (end - voice->Pos + voice->Step - 1) / voice->Step);
+		uint64_t pos = voice->Pos;
+		uint64_t step = voice->Step;
+		for (int i = 0; i < count; i++)
+		{
+			unsigned idx = unsigned(pos >> 32);
+			unsigned next = idx + 1 == wrapat ? wrapto : idx + 1;
+			float frac = (pos & 0xffffffff) * (1.f / 4294967296.f);
+			if (!stereo)
+			{
+				dest[done + i] = src[idx] + (src[next] - src[idx]) * frac;
+			}
+			else
+			{
+				float l = src[idx * 2] + (src[next * 2] - src[idx * 2]) * frac;
+				float r = src[idx * 2 + 1] + (src[next * 2 + 1] - src[idx * 2 + 1]) * frac;
+				if (downmix)
+				{
+					dest[done + i] = (l + r) * 0.5f;
+				}
+				else
+				{
+					dest[(done + i) * 2] = l;
+					dest[(done + i) * 2 + 1] = r;
+				}
+			}
+			pos += step;
+		}
+		voice->Pos = pos;
+		done += count;
+	}
+
+	float gain = Inactive == INACTIVE_Mute ? 0.f : SfxVolume * voice->Volume * voice->Attenuation;
+	float gl = gain * voice->PanLeft;
+	float gr = gain * voice->PanRight;
+	int i = 0;
+
+	if (stereo && !downmix)
+	{
+#ifdef SOFTSOUND_SSE2
+		__m128 g = _mm_setr_ps(gl, gr, gl, gr);
+		for (; i + 2 <= done; i += 2)
+		{
+			__m128 s = _mm_loadu_ps(dest + i * 2);
+			__m128 o = _mm_loadu_ps(out + i * 2);
+			_mm_storeu_ps(out + i * 2, _mm_add_ps(o, _mm_mul_ps(s, g)));
+		}
+#endif
+		for (; i < done; i++)
+		{
+			out[i * 2] += dest[i * 2] * gl;
+			out[i * 2 + 1] += dest[i * 2 + 1] * gr;
+		}
+	}
+	else
+	{
+#ifdef SOFTSOUND_SSE2
+		__m128 g = _mm_setr_ps(gl, gr, gl, gr);
+		for (; i + 4 <= done; i += 4)
+		{
+			__m128 s = _mm_loadu_ps(dest + i);
+			__m128 lo = _mm_unpacklo_ps(s, s);
+			__m128 hi = _mm_unpackhi_ps(s, s);
+			__m128 o0 = _mm_loadu_ps(out + i * 2);
+			__m128 o1 = _mm_loadu_ps(out + i * 2 + 4);
+			_mm_storeu_ps(out + i * 2, _mm_add_ps(o0, _mm_mul_ps(lo, g)));
+			_mm_storeu_ps(out + i * 2 + 4, _mm_add_ps(o1, _mm_mul_ps(hi, g)));
+		}
+#endif
+		for (; i < done; i++)
+		{
+			out[i * 2] += dest[i] * gl;
+			out[i * 2 + 1] += dest[i] * gr;
+		}
+	}
+	return finished;
+}
+
+//==========================================================================
+//
+// Mixes all voices and streams for the given number of output frames.
+//
+//==========================================================================
+
+void SoftSoundRenderer::Mix(int frames)
+{
+	MixTime.Reset();
+	MixTime.Clock();
+
+	MixBuffer.Resize(frames * 2);
+	memset(MixBuffer.Data(), 0, frames * 2 * sizeof(float));
+	if (VoiceBuffer.Size() < unsigned(frames * 2)) VoiceBuffer.Resize(frames * 2);
+
+	TArray<FSoftVoice*> finished;
+	ActiveVoices = 0;
+	for (auto &voice : Voices)
+	{
+		if (!voice.Playing) continue;
+		ActiveVoices++;
+		if (voice.SyncPaused || (SFXPaused && !(voice.Flags & SNDF_NOPAUSE))) continue;
+
+		if (MixVoice(&voice, MixBuffer.Data(), frames))
+			finished.Push(&voice);
+	}
+	PeakVoices = max(PeakVoices, ActiveVoices);
+
+	for (auto stream : Streams)
+	{
+		stream->Mix(MixBuffer.Data(), frames, OutputRate, Inactive == INACTIVE_Mute ? 0.f : MusicVolume);
+	}
+
+	MixTime.Unclock();
+	LastMixMS = MixTime.TimeMS();
+	TotalMixMS += LastMixMS;
+	MixCalls++;
+	LastFrames = frames;
+
+	// The engine may start new sounds from these callbacks, so only do this once mixing is done.
+	for (auto voice : finished)
+	{
+		if (!voice->Playing) continue;
+		if (voice->Chan) StopChannel(voice->Chan);
+		else FreeVoice(voice);
+	}
+
+	WriteOutput(frames);
+	MixedFrames += frames;
+}
+
+//==========================================================================
+//
+// Converts the mix to 16 bit and hands it to the sinks.
+//
+//==========================================================================
+
+void SoftSoundRenderer::WriteOutput(int frames)
+{
+	int count = frames * 2;
+	LastBlock.Resize(count);
+	const float *src = MixBuffer.Data();
+	int16_t *dest = LastBlock.Data();
+	int i = 0;
+
+#ifdef SOFTSOUND_SSE2
+	__m128 scale = _mm_set1_ps(32767.f);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i), scale));
+		__m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale));
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_packs_epi32(a, b));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		dest[i] = (int16_t)clamp<int>((int)lrintf(src[i] * 32767.f), -32768, 32767);
+	}
+
+	// FNV-1a over the output so two runs can be compared without storing them.
+	const uint8_t *bytes = (const uint8_t*)dest;
+	for (int j = 0; j < count * 2; j++)
+	{
+		Checksum = (Checksum ^ bytes[j]) * 16777619u;
+	}
+
+	if (WaveFile != nullptr)
+	{
+		WaveFile->Write(dest, count * sizeof(int16_t));
+		WaveDataBytes += count * sizeof(int16_t);
+	}
+}
+
+//==========================================================================
+//
+// Reproducible output needs every sound to be ready the moment it starts,
+// not whenever the loader thread gets to it.
+//
+//==========================================================================
+
+bool SoftSoundRenderer::NeedsSyncLoads()
+{
+	return !snd_soft_realtime;
+}
+
+//==========================================================================
+//
+// Mixes as much audio as the game tic advanced since the last call, or
+// the time since the last call with snd_soft_realtime. The game calls
+// this a varying number of times per tic, so only the tic counter can
+// make the output reproducible.
+//
+//==========================================================================
+
+void SoftSoundRenderer::UpdateSounds()
+{
+	int frames;
+	uint64_t now = I_nsTime();
+	if (snd_soft_realtime)
+	{
+		frames = (int)min<uint64_t>((now - LastUpdateTime) * OutputRate / 1000000000, OutputRate);
+		LastUpdateTime += uint64_t(frames) * 1000000000 / OutputRate;
+	}
+	else
+	{
+		int tics = 1;
+		if (sysCallbacks.GetGameTic != nullptr)
+		{
+			int tic = sysCallbacks.GetGameTic();
+			tics = LastTic < 0 || tic < LastTic ? 0 : min(tic - LastTic, GameTicRate);
+			LastTic = tic;
+		}
+		FrameRemainder += double(OutputRate) * tics / GameTicRate;
+		frames = int(FrameRemainder);
+		FrameRemainder -= frames;
+		LastUpdateTime = now;
+	}
+
+	// A completely inactive device doesn't advance.
+	if (frames <= 0 || Inactive == INACTIVE_Complete) return;
+	Mix(frames);
+}
+
+//==========================================================================
+//
+// WAV sink
+//
+//==========================================================================
+
+static void WriteLong(uint8_t *p, uint32_t v)
+{
+	p[0] = uint8_t(v);
+	p[1] = uint8_t(v >> 8);
+	p[2] = uint8_t(v >> 16);
+	p[3] = uint8_t(v >> 24);
+}
+
+static void WriteShort(uint8_t *p, uint16_t v)
+{
+	p[0] = uint8_t(v);
+	p[1] = uint8_t(v >> 8);
+}
+
+void SoftSoundRenderer::OpenWaveFile(const char *filename)
+{
+	WaveFile.reset(FileWriter::Open(filename));
+	if (WaveFile == nullptr)
+	{
+		Printf(TEXTCOLOR_RED "Unable to open sound output file %s\n", filename);
+		return;
+	}
+
+	// The sizes get filled in when the file is closed.
+	uint8_t header[44];
+	memcpy(header, "RIFF\0\0\0\0WAVEfmt ", 16);
+	WriteLong(header + 16, 16);
+	WriteShort(header + 20, 1);						// PCM
+	WriteShort(header + 22, 2);						// channels
+	WriteLong(header + 24, OutputRate);
+	WriteLong(header + 28, OutputRate * 4);			// bytes per second
+	WriteShort(header + 32, 4);						// block align
+	WriteShort(header + 34, 16);					// bits per sample
+	memcpy(header + 36, "data\0\0\0\0", 8);
+	WaveFile->Write(header, sizeof(header));
+	WaveDataStart = sizeof(header);
+	WaveDataBytes = 0;
+}
+
+void SoftSoundRenderer::CloseWaveFile()
+{
+	if (WaveFile == nullptr) return;
+
+	uint32_t datasize = (uint32_t)min<uint64_t>(WaveDataBytes, 0xffffffffu - WaveDataStart);
+	uint8_t size[4];
+	WriteLong(size, datasize + WaveDataStart - 8);
+	WaveFile->Seek(4, SEEK_SET);
+	WaveFile->Write(size, 4);
+	WriteLong(size, datasize);
+	WaveFile->Seek(WaveDataStart - 4, SEEK_SET);
+	WaveFile->Write(size, 4);
+	WaveFile.reset();
+}
+
+//==========================================================================
+//
+// Status
+//
+//==========================================================================
+
+void SoftSoundRenderer::PrintStatus()
+{
+	Printf("Output device: " TEXTCOLOR_ORANGE "Software mixer\n");
+	Printf("Output rate: " TEXTCOLOR_BLUE "%d" TEXTCOLOR_NORMAL " Hz, " TEXTCOLOR_BLUE "%s\n", OutputRate, snd_soft_realtime ? "real time" : "following the game tic");
+	Printf("Voices: " TEXTCOLOR_BLUE "%u" TEXTCOLOR_NORMAL ", peak " TEXTCOLOR_BLUE "%d\n", Voices.Size(), PeakVoices);
+	Printf("Evicted: " TEXTCOLOR_BLUE "%llu" TEXTCOLOR_NORMAL ", rejected " TEXTCOLOR_BLUE "%llu\n", (unsigned long long)Evictions, (unsigned long long)Rejections);
+	Printf("Mixed: " TEXTCOLOR_BLUE "%llu" TEXTCOLOR_NORMAL " frames, average " TEXTCOLOR_BLUE "%.3f" TEXTCOLOR_NORMAL " ms per update\n",
+		(unsigned long long)MixedFrames, MixCalls > 0 ? TotalMixMS / MixCalls : 0.);
+	Printf("Checksum: " TEXTCOLOR_BLUE "%08x\n", Checksum);
+	if (WaveFile != nullptr)
+		Printf("Writing " TEXTCOLOR_BLUE "%llu" TEXTCOLOR_NORMAL " bytes of wave data\n", (unsigned long long)WaveDataBytes);
+}
+
+void SoftSoundRenderer::PrintDriversList()
+{
+	Printf("The software mixer has no devices\n");
+}
+
+FString SoftSoundRenderer::GatherStats()
+{
+	int channels = 0, evicted = 0;
+	for (FSoundChan *schan = soundEngine->GetChannels(); schan != nullptr; schan = schan->NextChan)
+	{
+		channels++;
+		if (schan->ChanFlags & CHANF_EVICTED) evicted++;
+	}
+
+	FString out;
+	out.Format("%d/%u voices (peak %d), %d channels (%d evicted), %u streams\n"
+		"mix %.3f ms for %d frames (avg %.3f ms), %llu evictions, %llu rejected, crc %08x",
+		ActiveVoices, Voices.Size(), PeakVoices, channels, evicted, Streams.Size(),
+		LastMixMS, LastFrames, MixCalls > 0 ? TotalMixMS / MixCalls : 0.,
+		(unsigned long long)Evictions, (unsigned long long)Rejections, Checksum);
+	return out;
+}
@@ -0,0 +1,138 @@
+#ifndef SOFTSOUND_H
+#define SOFTSOUND_H
+
+#include <memory>
+#include "i_sound.h"
+#include "stats.h"
+
+// A sound renderer that mixes everything in software and never opens an
+// audio device. Selected with snd_backend "soft". By default every call to
+// UpdateSounds mixes exactly one tic worth of audio so that the output of a
+// demo is reproducible; -soundout <file.wav> writes it to disk.
+
+class FileWriter;
+class SoftSoundStream;
+struct FSoftSample;
+struct FSoftVoice;
+
+class SoftSoundRenderer : public SoundRenderer
+{
+public:
+	SoftSoundRenderer();
+	virtual ~SoftSoundRenderer();
+
+	virtual bool NeedsSyncLoads();
+
+	virtual void SetSfxVolume(float volume);
+	virtual void SetMusicVolume(float volume);
+	virtual SoundHandle LoadSound(uint8_t *sfxdata, int length, int def_loop_start, int def_loop_end);
+	virtual SoundHandle LoadSoundRaw(uint8_t *sfxdata, int length, int frequency, int channels, int bits, int loopstart, int loopend = -1);
+	virtual void UnloadSound(SoundHandle sfx);
+	virtual unsigned int GetMSLength(SoundHandle sfx);
+	virtual unsigned int GetSampleLength(SoundHandle sfx);
+	virtual float GetOutputRate();
+
+	// Streaming sounds.
+	virtual SoundStream *CreateStream(SoundStreamCallback callback, int buffbytes, int flags, int samplerate, void *userdata);
+
+	// Starts a sound.
+	virtual FISoundChannel *StartSound(SoundHandle sfx, float vol, float pitch, int chanflags, FISoundChannel *reuse_chan, float startTime);
+	virtual FISoundChannel *StartSound3D(SoundHandle sfx, SoundListener *listener, float vol, FRolloffInfo *rolloff, float distscale, float pitch, int priority, const FVector3 &pos, const FVector3 &vel, int channum, int chanflags, FISoundChannel *reuse_chan, float startTime);
+
+	// Stops a sound channel.
+	virtual void StopChannel(FISoundChannel *chan);
+
+	// Changes a channel's volume.
+	virtual void ChannelVolume(FISoundChannel *chan, float volume);
+
+	// Changes a channel's pitch.
+	virtual void ChannelPitch(FISoundChannel *chan, float pitch);
+
+	// Returns position of sound on this channel, in samples.
+	virtual unsigned int GetPosition(FISoundChannel *chan);
+
+	// Synchronizes following sound startups.
+	virtual void Sync(bool sync);
+
+	// Pauses or resumes all sound effect channels.
+	virtual void SetSfxPaused(bool paused, int slot);
+
+	// Pauses or resumes *every* channel, including environmental reverb.
+	virtual void SetInactive(SoundRenderer::EInactiveState inactive);
+
+	// Updates the volume, separation, and pitch of a sound channel.
+	virtual void UpdateSoundParams3D(SoundListener *listener, FISoundChannel *chan, bool areasound, const FVector3 &pos, const FVector3 &vel);
+
+	virtual void UpdateListener(SoundListener *);
+	virtual void UpdateSounds();
+
+	virtual void MarkStartTime(FISoundChannel*, float startTime);
+	virtual float GetAudibility(FISoundChannel*);
+
+	virtual bool IsValid();
+	virtual void PrintStatus();
+	virtual void PrintDriversList();
+	virtual FString GatherStats();
+
+	// The int16 stereo output of the last UpdateSounds call.
+	const TArray<int16_t> &GetLastBlock() const { return LastBlock; }
+	// Checksum of everything mixed so far, for comparing two runs.
+	uint32_t GetChecksum() const { return Checksum; }
+
+	void RemoveStream(SoftSoundStream *stream);
+
+private:
+	FSoftVoice *AllocVoice();
+	void FreeVoice(FSoftVoice *voice);
+	FSoundChan *FindLowestChannel();
+	void SetupVoice(FSoftVoice *voice, FSoftSample *sample, float vol, float pitch, int chanflags, FISoundChannel *reuse_chan, float startTime);
+	void UpdatePan(FSoftVoice *voice);
+	void SetVoicePitch(FSoftVoice *voice);
+	bool MixVoice(FSoftVoice *voice, float *out, int frames);
+	void Mix(int frames);
+	void WriteOutput(int frames);
+	void OpenWaveFile(const char *filename);
+	void CloseWaveFile();
+
+	TArray<FSoftVoice> Voices;
+	TArray<FSoftVoice*> FreeVoices;
+	TArray<SoftSoundStream*> Streams;
+	TArray<float> MixBuffer;
+	TArray<float> VoiceBuffer;
+	TArray<int16_t> LastBlock;
+
+	int OutputRate;
+	float SfxVolume = 1.f;
+	float MusicVolume = 1.f;
+	int SFXPaused = 0;
+	bool Synced = false;
+	bool WasInWater = false;
+	EInactiveState Inactive = INACTIVE_Active;
+
+	FVector3 ListenerPos = { 0, 0, 0 };
+	float ListenerAngle = 0;
+
+	// The mixer's own clock, in output frames. Channel start times are stored in this unit.
+	uint64_t MixedFrames = 0;
+	uint64_t LastUpdateTime = 0;
+	double FrameRemainder = 0;
+	int LastTic = -1;
+	uint32_t Checksum = 2166136261u;
+
+	// Statistics
+	cycle_t MixTime;
+	double LastMixMS = 0;
+	double TotalMixMS = 0;
+	uint64_t MixCalls = 0;
+	int LastFrames = 0;
+	int ActiveVoices = 0;
+	int PeakVoices = 0;
+	uint64_t Evictions = 0;
+	uint64_t Rejections = 0;
+
+	std::unique_ptr<FileWriter> WaveFile;
+	uint32_t WaveDataStart = 0;
+	uint64_t WaveDataBytes = 0;
+};
+
+#endif
@@ -75,6 +75,7 @@
 #include "cmdlib.h"
 #include "printf.h"
 #include "i_interface.h"
+#include "c_cvars.h"
 
 
 #include "i_net.h"
@@ -123,6 +124,22 @@ const char *neterror (void);
 #define neterror() strerror(errno)
 #endif
 
+// Packets are compressed in the zlib format, so its checksum still catches
+// corrupted datagrams. The compressor and decompressor are allocated once
+// and only reset between packets instead of being set up for each one.
+// Whether a packet is compressed is flagged in the packet itself, so each
+// side can pick its own level.
+CUSTOM_CVAR(Int, net_compression, 9, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 0) self = 0;
+	else if (self > 9) self = 9;
+}
+
+static z_stream DeflateStream;
+static z_stream InflateStream;
+static int DeflateLevel = -1;
+static bool InflateReady;
+
 enum
 {
 	PRE_CONNECT,			// Sent from guest to host for initial connection
@@ -221,6 +238,154 @@ int FindNode (const sockaddr_in *address)
 //
 // PacketSend
 //
+//
+// CompressPacket
+// Returns the compressed size or a negative value if the packet is sent as is.
+//
+static int CompressPacket (const uint8_t *in, int inlen, uint8_t *out, int outlen)
+{
+	int level = net_compression;
+	if (level <= 0)
+	{
+		return -1;
+	}
+	if (DeflateLevel != level)
+	{
+		if (DeflateLevel >= 0)
+		{
+			deflateEnd (&DeflateStream);
+			DeflateLevel = -1;
+		}
+		memset (&DeflateStream, 0, sizeof(DeflateStream));
+		int err = deflateInit (&DeflateStream, level);
+		if (err != Z_OK)
+		{
+			return err < 0 ? err : -1;
+		}
+		DeflateLevel = level;
+	}
+	else
+	{
+		deflateReset (&DeflateStream);
+	}
+	DeflateStream.next_in = (Bytef *)in;
+	DeflateStream.avail_in = inlen;
+	DeflateStream.next_out = out;
+	DeflateStream.avail_out = outlen;
+	int err = deflate (&DeflateStream, Z_FINISH);
+	if (err != Z_STREAM_END)
+	{
+		return err < 0 ? err : -1;
+	}
+	return outlen - DeflateStream.avail_out;
+}
+
+//
+// UncompressPacket
+// Returns the uncompressed size or a zlib error code.
+//
+static int UncompressPacket (const uint8_t *in, int inlen, uint8_t *out, int outlen)
+{
+	if (!InflateReady)
+	{
+		memset (&InflateStream, 0, sizeof(InflateStream));
+		int err = inflateInit (&InflateStream);
+		if (err != Z_OK)
+		{
+			return err;
+		}
+		InflateReady = true;
+	}
+	else
+	{
+		inflateReset (&InflateStream);
+	}
+	InflateStream.next_in = (Bytef *)in;
+	InflateStream.avail_in = inlen;
+	InflateStream.next_out = out;
+	InflateStream.avail_out = outlen;
+	int err = inflate (&InflateStream, Z_FINISH);
+	if (err != Z_STREAM_END)
+	{
+		return err == Z_OK ? Z_BUF_ERROR : err;
+	}
+	return outlen - InflateStream.avail_out;
+}
+
+static void FreeCompression (void)
+{
+	if (DeflateLevel >= 0)
+	{
+		deflateEnd (&DeflateStream);
+		DeflateLevel = -1;
+	}
+	if (InflateReady)
+	{
+		inflateEnd (&InflateStream);
+		InflateReady = false;
+	}
+}
+
+//
+// PackPacket
+// Returns the size of the compressed packet in 'out' or -1 if the packet should be sent as is.
+//
+static int PackPacket (const uint8_t *data, int len, uint8_t *out)
+{
+	if (len < 10)
+	{
+		return -1;
+	}
+	out[0] = data[0] | NCMD_COMPRESSED;
+	int c = CompressPacket(data + 1, len - 1, out + 1, TRANSMIT_SIZE - 1);
+	if (c < 0 || c + 1 >= len)
+	{
+		if (len > TRANSMIT_SIZE)
+		{
+			I_Error("Net compression failed (zlib error %d)", c);
+		}
+		return -1;
+	}
+	return c + 1;
+}
+
+//
+// UnpackPacket
+// Returns the size of the packet in 'out' or a zlib error code.
+//
+static int UnpackPacket (const uint8_t *in, int len, uint8_t *out)
+{
+	out[0] = in[0] & ~NCMD_COMPRESSED;
+	if (!(in[0] & NCMD_COMPRESSED))
+	{
+		memcpy(out + 1, in + 1, len - 1);
+		return len;
+	}
+	int msgsize = UncompressPacket(in + 1, len - 1, out + 1, MAX_MSGLEN - 1);
+	return msgsize < 0 ? msgsize : msgsize + 1;
+}
+
+//
+// I_CheckLoopbackPacket
+// Runs a packet the local node sends to itself through compression and back.
+// Returns false if it does not survive the round trip.
+//
+bool I_CheckLoopbackPacket (const uint8_t *data, int len)
+{
+	if (len > MAX_MSGLEN)
+	{
+		return false;
+	}
+	static uint8_t packed[TRANSMIT_SIZE];
+	static uint8_t unpacked[MAX_MSGLEN];
+	int size = PackPacket(data, len, packed);
+	if (size < 0)
+	{
+		return true;	// would be sent as is
+	}
+	return UnpackPacket(packed, size, unpacked) == len && memcmp(data, unpacked, len) == 0;
+}
+
 void PacketSend (void)
 {
 	int c;
@@ -234,37 +399,20 @@ void PacketSend (void)
 	}
 	assert(!(doomcom.data[0] & NCMD_COMPRESSED));
 
-	uLong size = TRANSMIT_SIZE - 1;
-	if (doomcom.datalength >= 10)
-	{
-		TransmitBuffer[0] = doomcom.data[0] | NCMD_COMPRESSED;
-		c = compress2(TransmitBuffer + 1, &size, doomcom.data + 1, doomcom.datalength - 1, 9);
-		size += 1;
-	}
-	else
+	int size = PackPacket(doomcom.data, doomcom.datalength, TransmitBuffer);
+	if (size > 0)
 	{
-		c = -1;	// Just some random error code to avoid sending the compressed buffer.
-	}
-	if (c == Z_OK && size < (uLong)doomcom.datalength)
-	{
-//		Printf("send %lu/%d\n", size, doomcom.datalength);
+//		Printf("send %d/%d\n", size, doomcom.datalength);
 		c = sendto(mysocket, (char *)TransmitBuffer, size,
 			0, (sockaddr *)&sendaddress[doomcom.remotenode],
 			sizeof(sendaddress[doomcom.remotenode]));
 	}
 	else
 	{
-		if (doomcom.datalength > TRANSMIT_SIZE)
-		{
-			I_Error("Net compression failed (zlib error %d)", c);
-		}
-		else
-		{
-//			Printf("send %d\n", doomcom.datalength);
-			c = sendto(mysocket, (char *)doomcom.data, doomcom.datalength,
-				0, (sockaddr *)&sendaddress[doomcom.remotenode],
-				sizeof(sendaddress[doomcom.remotenode]));
-		}
+//		Printf("send %d\n", doomcom.datalength);
+		c = sendto(mysocket, (char *)doomcom.data, doomcom.datalength,
+			0, (sockaddr *)&sendaddress[doomcom.remotenode],
+			sizeof(sendaddress[doomcom.remotenode]));
 	}
 	//	if (c == -1)
 	//			I_Error ("SendPacket error: %s",strerror(errno));
@@ -321,26 +469,16 @@ void PacketGet (void)
 	}
 	else if (node >= 0 && c > 0)
 	{
-		doomcom.data[0] = TransmitBuffer[0] & ~NCMD_COMPRESSED;
-		if (TransmitBuffer[0] & NCMD_COMPRESSED)
+		int msgsize = UnpackPacket(TransmitBuffer, c, doomcom.data);
+//		Printf("recv %d/%d\n", c, msgsize);
+		if (msgsize < 0)
 		{
-			uLongf msgsize = MAX_MSGLEN - 1;
-			int err = uncompress(doomcom.data + 1, &msgsize, TransmitBuffer + 1, c - 1);
-//			Printf("recv %d/%lu\n", c, msgsize + 1);
-			if (err != Z_OK)
-			{
-				Printf("Net decompression failed (zlib error %s)\n", M_ZLibError(err).GetChars());
-				// Pretend no packet
-				doomcom.remotenode = -1;
-				return;
-			}
-			c = msgsize + 1;
-		}
-		else
-		{
-//			Printf("recv %d\n", c);
-			memcpy(doomcom.data + 1, TransmitBuffer + 1, c - 1);
+			Printf("Net decompression failed (zlib error %s)\n", M_ZLibError(msgsize).GetChars());
+			// Pretend no packet
+			doomcom.remotenode = -1;
+			return;
 		}
+		c = msgsize;
 	}
 	else if (c > 0)
 	{	//The packet is not from any in-game node, so we might as well discard it.
@@ -459,6 +597,7 @@ void CloseNetwork (void)
 		closesocket (mysocket);
 		mysocket = INVALID_SOCKET;
 	}
+	FreeCompression ();
 #ifdef __WIN32__
 	WSACleanup ();
 #endif
@@ -0,0 +1,289 @@
+/*
+** metrics.cpp
+** Engine metrics streamed as newline delimited JSON
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <string.h>
+#include <memory>
+#include "metrics.h"
+#include "files.h"
+#include "printf.h"
+#include "v_text.h"
+#include "i_time.h"
+
+bool MetricsActive;
+FMetric *FMetric::FirstMetric;
+
+static std::unique_ptr<FileWriter> metricsFile;
+static int metricsSocket = -1;
+static uint64_t metricsEpoch;
+static uint64_t metricsLastFrame;
+static uint64_t metricsFrames;
+static uint64_t metricsTics;
+static uint64_t metricsLinesWritten;
+static uint64_t metricsLinesDropped;
+
+static FHistogramMetric FrameTime("render.frame_ms", METRIC_Frame, { 4, 8, 12, 16.7, 20, 25, 33.4, 50, 100 });
+
+//==========================================================================
+//
+// FMetric
+//
+//==========================================================================
+
+FMetric::FMetric(const char *name, EMetricScope scope)
+	: Name(name), Scope(scope)
+{
+	m_Next = FirstMetric;
+	FirstMetric = this;
+}
+
+void FCounterMetric::Write(FString &out)
+{
+	out.AppendFormat("%llu", (unsigned long long)Value.load(std::memory_order_relaxed));
+}
+
+void FGaugeMetric::Write(FString &out)
+{
+	out.AppendFormat("%g", Value);
+}
+
+//==========================================================================
+//
+// FHistogramMetric
+//
+//==========================================================================
+
+FHistogramMetric::FHistogramMetric(const char *name, EMetricScope scope, std::initializer_list<double> bounds)
+	: FMetric(name, scope)
+{
+	for (double b : bounds)
+	{
+		if (NumBounds == MAX_BUCKETS) break;
+		Bounds[NumBounds++] = b;
+	}
+	Reset();
+}
+
+void FHistogramMetric::Reset()
+{
+	memset(Buckets, 0, sizeof(Buckets));
+	Count = 0;
+	Sum = Min = Max = 0;
+}
+
+void FHistogramMetric::Record(double value)
+{
+	if (!MetricsActive) return;
+
+	int i = 0;
+	while (i < NumBounds && value > Bounds[i]) i++;
+	Buckets[i]++;
+
+	if (Count == 0 || value < Min) Min = value;
+	if (Count == 0 || value > Max) Max = value;
+	Sum += value;
+	Count++;
+}
+
+void FHistogramMetric::Write(FString &out)
+{
+	out.AppendFormat("{\"count\":%u,\"sum\":%g,\"min\":%g,\"max\":%g,\"buckets\":[", Count, Sum, Min, Max);
+	for (int i = 0; i <= NumBounds; i++)
+	{
+		if (i > 0) out << ',';
+		if (i < NumBounds) out.AppendFormat("[%g,%u]", Bounds[i], Buckets[i]);
+		else out.AppendFormat("[null,%u]", Buckets[i]);
+	}
+	out << "]}";
+	Reset();
+}
+
+//==========================================================================
+//
+// A socket consumer that does not keep up loses lines instead of
+// stalling the game.
+//
+//==========================================================================
+
+static void WriteLine(const FString &line)
+{
+	if (metricsFile != nullptr)
+	{
+		metricsFile->Write(line.GetChars(), line.Len());
+		metricsLinesWritten++;
+	}
+#ifndef _WIN32
+	else if (metricsSocket >= 0)
+	{
+		ssize_t sent = send(metricsSocket, line.GetChars(), line.Len(), MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (sent == (ssize_t)line.Len())
+		{
+			metricsLinesWritten++;
+		}
+		else if (sent >= 0)
+		{
+			// A partial line would corrupt the stream, so block for the rest.
+			const char *rest = line.GetChars() + sent;
+			size_t left = line.Len() - sent;
+			while (left > 0)
+			{
+				sent = send(metricsSocket, rest, left, MSG_NOSIGNAL);
+				if (sent <= 0)
+				{
+					Printf(TEXTCOLOR_RED "Metrics consumer disconnected\n");
+					Metrics_Stop();
+					return;
+				}
+				rest += sent;
+				left -= sent;
+			}
+			metricsLinesWritten++;
+		}
+		else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			metricsLinesDropped++;
+		}
+		else
+		{
+			Printf(TEXTCOLOR_RED "Metrics consumer disconnected\n");
+			Metrics_Stop();
+		}
+	}
+#endif
+}
+
+static void WriteScope(EMetricScope scope, const char *type, uint64_t count)
+{
+	FString line;
+	line.Format("{\"type\":\"%s\",\"%s\":%llu,\"time\":%.3f,\"metrics\":{", type, type,
+		(unsigned long long)count, (I_nsTime() - metricsEpoch) / 1e6);
+
+	bool first = true;
+	for (FMetric *metric = FMetric::First(); metric != nullptr; metric = metric->Next())
+	{
+		if (metric->GetScope() != scope) continue;
+		if (!first) line << ',';
+		line.AppendFormat("\"%s\":", metric->GetName());
+		metric->Write(line);
+		first = false;
+	}
+	line << "}}\n";
+	WriteLine(line);
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void Metrics_Start(const char *target)
+{
+	if (target == nullptr || MetricsActive) return;
+
+	if (!strncmp(target, "unix:", 5))
+	{
+#ifndef _WIN32
+		sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+		if (strlen(target + 5) >= sizeof(addr.sun_path))
+		{
+			Printf(TEXTCOLOR_RED "Metrics socket path %s is too long\n", target + 5);
+			return;
+		}
+		strcpy(addr.sun_path, target + 5);
+
+		metricsSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (metricsSocket < 0 || connect(metricsSocket, (sockaddr *)&addr, sizeof(addr)) < 0)
+		{
+			Printf(TEXTCOLOR_RED "Unable to connect to metrics socket %s\n", target + 5);
+			if (metricsSocket >= 0) close(metricsSocket);
+			metricsSocket = -1;
+			return;
+		}
+#else
+		Printf(TEXTCOLOR_RED "Metrics sockets are not supported on this platform, use a file instead\n");
+		return;
+#endif
+	}
+	else
+	{
+		metricsFile.reset(FileWriter::Open(target));
+		if (metricsFile == nullptr)
+		{
+			Printf(TEXTCOLOR_RED "Unable to open metrics file %s\n", target);
+			return;
+		}
+	}
+
+	metricsEpoch = metricsLastFrame = I_nsTime();
+	metricsFrames = metricsTics = 0;
+	metricsLinesWritten = metricsLinesDropped = 0;
+	MetricsActive = true;
+}
+
+void Metrics_Stop()
+{
+	if (!MetricsActive) return;
+	MetricsActive = false;
+
+	metricsFile.reset();
+#ifndef _WIN32
+	if (metricsSocket >= 0) close(metricsSocket);
+	metricsSocket = -1;
+#endif
+	Printf("Metrics: wrote %llu lines, dropped %llu\n", (unsigned long long)metricsLinesWritten, (unsigned long long)metricsLinesDropped);
+}
+
+void Metrics_EndFrame()
+{
+	if (!MetricsActive) return;
+
+	uint64_t now = I_nsTime();
+	FrameTime.Record((now - metricsLastFrame) / 1e6);
+	metricsLastFrame = now;
+	WriteScope(METRIC_Frame, "frame", metricsFrames++);
+}
+
+void Metrics_EndTic()
+{
+	if (!MetricsActive) return;
+	WriteScope(METRIC_Tic, "tic", metricsTics++);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <initializer_list>
+#include "zstring.h"
+
+// Structured engine metrics for external tools. Counters, gauges and histograms
+// register themselves like stats do. With -metrics <file> or -metrics unix:<path>
+// one JSON object per line is written at the end of every frame and every tic,
+// containing all metrics of that scope. When metrics are off, updating a metric
+// only costs a branch.
+
+extern bool MetricsActive;
+
+enum EMetricScope
+{
+	METRIC_Frame,
+	METRIC_Tic,
+};
+
+class FMetric
+{
+public:
+	FMetric(const char *name, EMetricScope scope);
+	virtual ~FMetric() = default;
+
+	const char *GetName() const { return Name; }
+	EMetricScope GetScope() const { return Scope; }
+
+	// Appends the value as JSON and resets per-period data.
+	virtual void Write(FString &out) = 0;
+
+	static FMetric *First() { return FirstMetric; }
+	FMetric *Next() const { return m_Next; }
+
+private:
+	const char *Name;
+	EMetricScope Scope;
+	FMetric *m_Next;
+
+	static FMetric *FirstMetric;
+};
+
+// Monotonically increasing total. May be updated from any thread.
+class FCounterMetric : public FMetric
+{
+public:
+	FCounterMetric(const char *name, EMetricScope scope) : FMetric(name, scope) {}
+
+	void Add(uint64_t amount = 1)
+	{
+		if (MetricsActive) Value.fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	void Write(FString &out) override;
+
+private:
+	std::atomic<uint64_t> Value { 0 };
+};
+
+// The most recent value of something. Main thread only.
+class FGaugeMetric : public FMetric
+{
+public:
+	FGaugeMetric(const char *name, EMetricScope scope) : FMetric(name, scope) {}
+
+	void Set(double value)
+	{
+		Value = value;
+	}
+
+	void Write(FString &out) override;
+
+private:
+	double Value = 0;
+};
+
+// Distribution of values recorded during one frame or tic. Main thread only.
+// 'bounds' are the inclusive upper limits of the buckets and must be ascending,
+// everything above the last one goes into an overflow bucket.
+class FHistogramMetric : public FMetric
+{
+public:
+	enum { MAX_BUCKETS = 16 };
+
+	FHistogramMetric(const char *name, EMetricScope scope, std::initializer_list<double> bounds);
+
+	void Record(double value);
+	void Write(FString &out) override;
+
+private:
+	void Reset();
+
+	double Bounds[MAX_BUCKETS];
+	uint32_t Buckets[MAX_BUCKETS + 1];
+	int NumBounds = 0;
+	uint32_t Count;
+	double Sum, Min, Max;
+};
+
+void Metrics_Start(const char *target);
+void Metrics_Stop();
+void Metrics_EndFrame();
+void Metrics_EndTic();
@@ -0,0 +1,187 @@
+/*
+** profiler.cpp
+** Scoped timing zones with Chrome trace output
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "profiler.h"
+#include "files.h"
+#include "printf.h"
+#include "tarray.h"
+#include "v_text.h"
+#include "version.h"
+
+bool ProfilerActive;
+
+struct FProfileEvent
+{
+	const char *Name;
+	const char *Category;
+	FString Detail;
+	double Start;
+	double Duration;
+	int Thread;
+};
+
+static std::mutex profileMutex;
+static std::unique_ptr<FileWriter> profileFile;
+static TArray<FProfileEvent> profileEvents;
+static cycle_t profileEpoch;
+static std::atomic<int> profileThreadCount;
+static uint64_t profileZonesWritten;
+
+static thread_local int profileThreadId;
+static thread_local bool profileThreadNamed;
+
+enum
+{
+	PROFILE_FLUSH_EVENTS = 8192,
+};
+
+//==========================================================================
+//
+// Every thread gets a small number as soon as it records its first zone.
+//
+//==========================================================================
+
+static int GetThreadId()
+{
+	if (profileThreadId == 0) profileThreadId = ++profileThreadCount;
+	return profileThreadId;
+}
+
+static void WriteEscaped(const char *text)
+{
+	FString out;
+	for (const char *p = text; *p; p++)
+	{
+		if (*p == '"' || *p == '\\') out << '\\' << *p;
+		else if ((unsigned char)*p < 32) out.AppendFormat("\\u%04x", *p);
+		else out << *p;
+	}
+	profileFile->Write(out.GetChars(), out.Len());
+}
+
+// Must be called with the mutex held.
+static void FlushEvents()
+{
+	for (auto &ev : profileEvents)
+	{
+		profileFile->Printf(",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+			ev.Name, ev.Category, ev.Start, ev.Duration, ev.Thread);
+		if (ev.Detail.IsNotEmpty())
+		{
+			profileFile->Printf(",\"args\":{\"detail\":\"");
+			WriteEscaped(ev.Detail.GetChars());
+			profileFile->Printf("\"}");
+		}
+		profileFile->Printf("}");
+	}
+	profileZonesWritten += profileEvents.Size();
+	profileEvents.Clear();
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+double Profiler_Now()
+{
+	cycle_t now = profileEpoch;
+	now.Unclock();
+	return now.TimeMS() * 1000.;
+}
+
+void Profiler_Start(const char *filename)
+{
+	if (filename == nullptr || ProfilerActive) return;
+
+	profileFile.reset(FileWriter::Open(filename));
+	if (profileFile == nullptr)
+	{
+		Printf(TEXTCOLOR_RED "Unable to open profile trace file %s\n", filename);
+		return;
+	}
+	// The metadata entry means every event can be written with a leading comma.
+	profileFile->Printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"" GAMENAME "\"}}");
+	profileZonesWritten = 0;
+	profileEpoch.ResetAndClock();
+	ProfilerActive = true;
+	Profiler_SetThreadName("Main thread");
+}
+
+void Profiler_Stop()
+{
+	if (!ProfilerActive) return;
+
+	std::unique_lock<std::mutex> lock(profileMutex);
+	ProfilerActive = false;
+	FlushEvents();
+	profileFile->Printf("\n]}\n");
+	profileFile.reset();
+	Printf("Profiler: wrote %llu zones\n", (unsigned long long)profileZonesWritten);
+}
+
+void Profiler_SetThreadName(const char *name)
+{
+	if (!ProfilerActive || profileThreadNamed) return;
+	profileThreadNamed = true;
+
+	int tid = GetThreadId();
+	std::unique_lock<std::mutex> lock(profileMutex);
+	if (profileFile == nullptr) return;
+	profileFile->Printf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", tid);
+	WriteEscaped(name);
+	profileFile->Printf("\"}}");
+}
+
+void Profiler_AddZone(const char *name, const char *category, const char *detail, double start, double end)
+{
+	int tid = GetThreadId();
+	std::unique_lock<std::mutex> lock(profileMutex);
+	if (!ProfilerActive) return;
+
+	auto &ev = profileEvents[profileEvents.Reserve(1)];
+	ev.Name = name;
+	ev.Category = category;
+	if (detail) ev.Detail = detail;
+	ev.Start = start;
+	ev.Duration = end - start;
+	ev.Thread = tid;
+
+	if (profileEvents.Size() >= PROFILE_FLUSH_EVENTS) FlushEvents();
+}
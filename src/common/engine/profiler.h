@@ -0,0 +1,90 @@
+#pragma once
+
+#include "stats.h"
+#include "zstring.h"
+
+// Scoped timing zones for finding out where startup, map loading and frames
+// spend their time. Zones may be opened on any thread. With -profiletrace <file>
+// they are written as a Chrome trace that can be opened in chrome://tracing or
+// ui.perfetto.dev. When no trace is being written a zone only costs a branch.
+
+extern bool ProfilerActive;
+
+void Profiler_Start(const char *filename);
+void Profiler_Stop();
+void Profiler_SetThreadName(const char *name);
+double Profiler_Now();	// microseconds since Profiler_Start
+
+// 'name' and 'category' must be string literals, 'detail' gets copied.
+void Profiler_AddZone(const char *name, const char *category, const char *detail, double start, double end);
+
+class FProfileZone
+{
+public:
+	FProfileZone(const char *name, const char *category, const char *detail = nullptr)
+	{
+		if (ProfilerActive)
+		{
+			Name = name;
+			Category = category;
+			if (detail) Detail = detail;
+			Start = Profiler_Now();
+		}
+	}
+
+	~FProfileZone()
+	{
+		End();
+	}
+
+	void End()
+	{
+		if (Name != nullptr)
+		{
+			Profiler_AddZone(Name, Category, Detail.IsNotEmpty() ? Detail.GetChars() : nullptr, Start, Profiler_Now());
+			Name = nullptr;
+		}
+	}
+
+	FProfileZone(const FProfileZone &) = delete;
+	FProfileZone &operator=(const FProfileZone &) = delete;
+
+private:
+	const char *Name = nullptr;
+	const char *Category = nullptr;
+	FString Detail;
+	double Start = 0;
+};
+
+// Times consecutive steps of a longer function. Each step ends where the next one begins.
+class FProfileSequence
+{
+public:
+	explicit FProfileSequence(const char *category) : Category(category) {}
+
+	~FProfileSequence()
+	{
+		Next(nullptr);
+	}
+
+	void Next(const char *name)
+	{
+		if (!ProfilerActive) return;
+		double now = Profiler_Now();
+		if (Name != nullptr) Profiler_AddZone(Name, Category, nullptr, Start, now);
+		Name = name;
+		Start = now;
+	}
+
+	FProfileSequence(const FProfileSequence &) = delete;
+	FProfileSequence &operator=(const FProfileSequence &) = delete;
+
+private:
+	const char *Category;
+	const char *Name = nullptr;
+	double Start = 0;
+};
+
+#define PROFILE_ZONE_NAME2(a, b) a##b
+#define PROFILE_ZONE_NAME(a, b) PROFILE_ZONE_NAME2(a, b)
+#define PROFILE_ZONE(name, category) FProfileZone PROFILE_ZONE_NAME(profilezone_, __LINE__)(name, category)
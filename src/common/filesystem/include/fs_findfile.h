@@ -24,6 +24,7 @@ using FileList = std::vector<FileListEntry>;
 struct FCompressedBuffer;
 bool ScanDirectory(std::vector<FileListEntry>& list, const char* dirpath, const char* match, bool nosubdir = false, bool readhidden = false);
 bool FS_DirEntryExists(const char* pathname, bool* isdir);
+bool FS_GetFileInfo(const char* pathname, uint64_t* size, int64_t* mtime);
 
 inline void FixPathSeparator(char* path)
 {
@@ -27,6 +27,7 @@ struct LumpFilterInfo
 	std::vector<std::string> blockednames;			// File names that will never be accepted (e.g. dehacked.exe for Doom)
 	std::function<bool(const char*, const char*)> filenamecheck;	// for scanning directories, this allows to eliminate unwanted content.
 	std::function<void()> postprocessFunc;
+	std::string indexCacheDir;		// if set, parsed archive directories get cached here so they can be restored without parsing on the next run.
 };
 
 enum class FSMessageLevel
@@ -109,6 +110,8 @@ struct FResourceEntry
 
 void SetMainThread();
 
+struct FIndexCacheMapping;
+
 class FResourceFile
 {
 public:
@@ -125,6 +128,7 @@ protected:
 	uint32_t NumLumps;
 	char Hash[48];
 	StringPool* stringpool;
+	FIndexCacheMapping* IndexCache = nullptr;	// keeps the file names of a restored directory alive.
 
 	// for archives that can contain directories
 	virtual void SetEntryAddress(uint32_t entry)
@@ -133,6 +137,8 @@ protected:
 	}
 	bool IsFileInFolder(const char* const resPath);
 	void CheckEmbedded(uint32_t entry, LumpFilterInfo* lfi);
+	bool LoadIndexCache(LumpFilterInfo* filter, const void* header, size_t headersize);
+	void SaveIndexCache(LumpFilterInfo* filter, const void* header, size_t headersize);
 
 private:
 	uint32_t FirstLump;
@@ -180,6 +186,11 @@ public:
 		return (entry < NumLumps) ? Entries[entry].Namespace : (int)ns_hidden;
 	}
 
+	uint32_t GetEntryCRC32(uint32_t entry)
+	{
+		return (entry < NumLumps) ? Entries[entry].CRC32 : 0;
+	}
+
 	int GetEntryResourceID(uint32_t entry)
 	{
 		return (entry < NumLumps) ? Entries[entry].ResourceID : -1;
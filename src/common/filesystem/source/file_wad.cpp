@@ -95,7 +95,7 @@ FWadFile::FWadFile(const char *filename, FileReader &file, StringPool* sp)
 //
 //==========================================================================
 
-bool FWadFile::Open(LumpFilterInfo*, FileSystemMessageFunc Printf)
+bool FWadFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 {
 	wadinfo_t header;
 	uint32_t InfoTableOfs;
@@ -122,6 +122,11 @@ bool FWadFile::Open(LumpFilterInfo*, FileSystemMessageFunc Printf)
 		}
 	}
 
+	if (LoadIndexCache(filter, &header, sizeof(header)))
+	{
+		return true;
+	}
+
 	Reader.Seek(InfoTableOfs, FileReader::SeekSet);
 	auto fd = Reader.Read(NumLumps * sizeof(wadlump_t));
 	auto fileinfo = (const wadlump_t*)fd.data();
@@ -178,6 +183,7 @@ bool FWadFile::Open(LumpFilterInfo*, FileSystemMessageFunc Printf)
 	SetNamespace("vx_start", "vx_end", ns_voxels, Printf);
 	SkinHack(Printf);
 
+	SaveIndexCache(filter, &header, sizeof(header));
 	return true;
 }
 
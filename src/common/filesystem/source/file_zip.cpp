@@ -141,6 +141,9 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 	}
 
 	uint64_t dirsize, DirectoryOffset;
+	// The end of central directory record identifies the directory for the index cache.
+	uint8_t dirheader[sizeof(FZipEndOfCentralDirectory64)];
+	size_t dirheadersize;
 	if (!zip64)
 	{
 		FZipEndOfCentralDirectory info;
@@ -159,6 +162,7 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 		NumLumps = LittleShort(info.NumEntries);
 		dirsize = LittleLong(info.DirectorySize);
 		DirectoryOffset = LittleLong(info.DirectoryOffset);
+		memcpy(dirheader, &info, dirheadersize = sizeof(info));
 	}
 	else
 	{
@@ -178,7 +182,13 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 		NumLumps = (uint32_t)info.NumEntries;
 		dirsize = info.DirectorySize;
 		DirectoryOffset = info.DirectoryOffset;
+		memcpy(dirheader, &info, dirheadersize = sizeof(info));
 	}
+	if (LoadIndexCache(filter, dirheader, dirheadersize))
+	{
+		return true;
+	}
+
 	// Load the entire central directory. Too bad that this contains variable length entries...
 	void *directory = malloc(dirsize);
 	Reader.Seek(DirectoryOffset, FileReader::SeekSet);
@@ -320,6 +330,7 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 
 	GenerateHash();
 	PostProcessArchive(filter);
+	SaveIndexCache(filter, dirheader, dirheadersize);
 	return true;
 }
 
@@ -742,6 +742,25 @@ ptrdiff_t FileSystem::FileLength (int lump) const
 	return (int)lump_p.resfile->Length(lump_p.resindex);
 }
 
+//==========================================================================
+//
+// FileCRC32
+//
+// Returns the CRC the container stores for the lump, so that it can be
+// identified without reading it. Only Zip based containers have one.
+//
+//==========================================================================
+
+uint32_t FileSystem::FileCRC32 (int lump) const
+{
+	if ((size_t)lump >= NumEntries)
+	{
+		return 0;
+	}
+	const auto &lump_p = FileInfo[lump];
+	return lump_p.resfile->GetEntryCRC32(lump_p.resindex);
+}
+
 //==========================================================================
 //
 // 
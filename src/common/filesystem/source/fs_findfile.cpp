@@ -426,4 +426,32 @@ bool FS_DirEntryExists(const char* pathname, bool* isdir)
 	return res;
 }
 
+//==========================================================================
+//
+// FS_GetFileInfo
+//
+// Returns size and modification time of a file. This is used to validate
+// cached data derived from the file's contents.
+//
+//==========================================================================
+
+bool FS_GetFileInfo(const char* pathname, uint64_t* size, int64_t* mtime)
+{
+	if (pathname == NULL || *pathname == 0)
+		return false;
+
+#ifndef _WIN32
+	struct stat info;
+	bool res = stat(pathname, &info) == 0;
+#else
+	auto wstr = toWide(pathname);
+	struct _stat64 info;
+	bool res = _wstat64(wstr.c_str(), &info) == 0;
+#endif
+	if (!res || (info.st_mode & S_IFDIR)) return false;
+	if (size) *size = (uint64_t)info.st_size;
+	if (mtime) *mtime = (int64_t)info.st_mtime;
+	return true;
+}
+
 }
@@ -0,0 +1,375 @@
+/*
+** fs_indexcache.cpp
+** Persistent cache for parsed archive directories
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** The cache stores the final entry table of an archive, i.e. after sorting,
+** filtering and path stripping, so that a warm start only has to read the
+** archive's header and can skip the entire directory processing.
+** The file names are used straight from the mapped cache file.
+**
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "resourcefile.h"
+#include "fs_findfile.h"
+#include "fs_indexcache.h"
+
+#ifdef _WIN32
+#ifndef _WINNT_
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace FileSys {
+
+FILE* myfopen(const char* filename, const char* flags);
+std::string FS_FullPath(const char* directory);
+#ifdef _WIN32
+std::wstring toWide(const char* str);
+#endif
+
+// The cache is machine local so all data is stored in native byte order.
+static const uint32_t INDEXCACHE_MAGIC = 0x43495346;	// 'FSIC'
+static const uint32_t INDEXCACHE_VERSION = 1;
+
+struct FIndexCacheHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t FileSize;
+	int64_t FileTime;
+	uint64_t HeaderHash;
+	uint64_t FilterHash;
+	uint32_t NumEntries;
+	uint32_t PathLength;	// includes the terminating 0 and padding to 8 bytes.
+	uint32_t StringSize;
+	uint32_t Reserved;
+	char Hash[48];
+};
+
+struct FIndexCacheEntry
+{
+	uint64_t Length;
+	uint64_t CompressedSize;
+	uint64_t Position;
+	uint32_t NameOffset;
+	int32_t ResourceID;
+	uint32_t CRC32;
+	uint16_t Flags;
+	uint16_t Method;
+	int16_t Namespace;
+	uint16_t Reserved[3];
+};
+
+struct FIndexCacheMapping
+{
+	const uint8_t* memory = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE mapping = NULL;
+#endif
+};
+
+//==========================================================================
+//
+// FNV-1a, only needs to be good enough to detect changes.
+//
+//==========================================================================
+
+static uint64_t HashBytes(const void* data, size_t len, uint64_t hash = 0xcbf29ce484222325ull)
+{
+	auto p = (const uint8_t*)data;
+	for (size_t i = 0; i < len; i++)
+	{
+		hash = (hash ^ p[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static uint64_t HashStrings(const std::vector<std::string>& list, uint64_t hash)
+{
+	for (auto& str : list)
+	{
+		hash = HashBytes(str.c_str(), str.length() + 1, hash);
+	}
+	// separate the lists so that moving a string from one to the next changes the hash.
+	return HashBytes("\xff", 1, hash);
+}
+
+static uint64_t HashFilter(LumpFilterInfo* filter)
+{
+	uint64_t hash = HashBytes(nullptr, 0);
+	hash = HashStrings(filter->gameTypeFilter, hash);
+	hash = HashStrings(filter->reservedFolders, hash);
+	hash = HashStrings(filter->requiredPrefixes, hash);
+	hash = HashStrings(filter->embeddings, hash);
+	hash = HashStrings(filter->blockednames, hash);
+	return hash;
+}
+
+static std::string IndexCacheName(LumpFilterInfo* filter, const std::string& fullpath)
+{
+	char name[24];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)HashBytes(fullpath.c_str(), fullpath.length()));
+	std::string path = filter->indexCacheDir;
+	if (!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+	return path + name + ".fsi";
+}
+
+//==========================================================================
+//
+// platform specific mapping of the cache file
+//
+//==========================================================================
+
+#ifdef _WIN32
+
+static FIndexCacheMapping* MapIndexCache(const char* filename)
+{
+	auto wname = toWide(filename);
+	HANDLE file = CreateFileW(wname.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(FIndexCacheHeader))
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping) return nullptr;
+
+	auto memory = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!memory)
+	{
+		CloseHandle(mapping);
+		return nullptr;
+	}
+	auto map = new FIndexCacheMapping;
+	map->memory = memory;
+	map->size = (size_t)size.QuadPart;
+	map->mapping = mapping;
+	return map;
+}
+
+void CloseIndexCacheMapping(FIndexCacheMapping* map)
+{
+	if (map == nullptr) return;
+	UnmapViewOfFile(map->memory);
+	CloseHandle(map->mapping);
+	delete map;
+}
+
+#else
+
+static FIndexCacheMapping* MapIndexCache(const char* filename)
+{
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) return nullptr;
+
+	struct stat info;
+	if (fstat(fd, &info) < 0 || info.st_size < (off_t)sizeof(FIndexCacheHeader))
+	{
+		close(fd);
+		return nullptr;
+	}
+	void* memory = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) return nullptr;
+
+	auto map = new FIndexCacheMapping;
+	map->memory = (const uint8_t*)memory;
+	map->size = (size_t)info.st_size;
+	return map;
+}
+
+void CloseIndexCacheMapping(FIndexCacheMapping* map)
+{
+	if (map == nullptr) return;
+	munmap((void*)map->memory, map->size);
+	delete map;
+}
+
+#endif
+
+//==========================================================================
+//
+// FResourceFile :: LoadIndexCache
+//
+// Restores the entry table from the cache if it is still valid for the
+// file on disk. 'header' is the archive's own directory header which
+// gets hashed to catch modifications that did not alter size or time stamp.
+//
+//==========================================================================
+
+bool FResourceFile::LoadIndexCache(LumpFilterInfo* filter, const void* header, size_t headersize)
+{
+	if (filter == nullptr || filter->indexCacheDir.empty() || IndexCache != nullptr) return false;
+
+	uint64_t filesize;
+	int64_t filetime;
+	if (!FS_GetFileInfo(FileName, &filesize, &filetime)) return false;	// not a file on disk, e.g. an embedded WAD.
+
+	auto fullpath = FS_FullPath(FileName);
+	auto map = MapIndexCache(IndexCacheName(filter, fullpath).c_str());
+	if (map == nullptr) return false;
+
+	auto head = (const FIndexCacheHeader*)map->memory;
+	size_t pathlen = fullpath.length() + 1;
+	size_t entryofs = sizeof(FIndexCacheHeader) + head->PathLength;
+	size_t stringofs = entryofs + (size_t)head->NumEntries * sizeof(FIndexCacheEntry);
+	auto strings = (const char*)map->memory + stringofs;
+
+	if (head->Magic != INDEXCACHE_MAGIC || head->Version != INDEXCACHE_VERSION ||
+		head->FileSize != filesize || head->FileTime != filetime ||
+		head->HeaderHash != HashBytes(header, headersize) || head->FilterHash != HashFilter(filter) ||
+		head->PathLength < pathlen || stringofs + head->StringSize != map->size || head->StringSize == 0 ||
+		memcmp(map->memory + sizeof(FIndexCacheHeader), fullpath.c_str(), pathlen) != 0 ||
+		strings[head->StringSize - 1] != 0)
+	{
+		CloseIndexCacheMapping(map);
+		return false;
+	}
+
+	auto cached = (const FIndexCacheEntry*)(map->memory + entryofs);
+	AllocateEntries(head->NumEntries);
+	for (uint32_t i = 0; i < NumLumps; i++)
+	{
+		if (cached[i].NameOffset >= head->StringSize)
+		{
+			// corrupt cache. Leave it to the caller to reparse the directory.
+			NumLumps = 0;
+			Entries = nullptr;
+			CloseIndexCacheMapping(map);
+			return false;
+		}
+		auto& entry = Entries[i];
+		entry.Length = (size_t)cached[i].Length;
+		entry.CompressedSize = (size_t)cached[i].CompressedSize;
+		entry.Position = (size_t)cached[i].Position;
+		entry.FileName = strings + cached[i].NameOffset;
+		entry.ResourceID = cached[i].ResourceID;
+		entry.CRC32 = cached[i].CRC32;
+		entry.Flags = cached[i].Flags;
+		entry.Method = cached[i].Method;
+		entry.Namespace = cached[i].Namespace;
+	}
+	memcpy(Hash, head->Hash, sizeof(Hash));
+	Hash[sizeof(Hash) - 1] = 0;
+	IndexCache = map;
+	return true;
+}
+
+//==========================================================================
+//
+// FResourceFile :: SaveIndexCache
+//
+// Must be called after all post processing of the entry table is complete.
+// Failure to write the cache is not an error, it will just be retried.
+//
+//==========================================================================
+
+void FResourceFile::SaveIndexCache(LumpFilterInfo* filter, const void* header, size_t headersize)
+{
+	if (filter == nullptr || filter->indexCacheDir.empty() || IndexCache != nullptr) return;
+
+	uint64_t filesize;
+	int64_t filetime;
+	if (!FS_GetFileInfo(FileName, &filesize, &filetime)) return;
+
+	auto fullpath = FS_FullPath(FileName);
+
+	FIndexCacheHeader head = {};
+	head.Magic = INDEXCACHE_MAGIC;
+	head.Version = INDEXCACHE_VERSION;
+	head.FileSize = filesize;
+	head.FileTime = filetime;
+	head.HeaderHash = HashBytes(header, headersize);
+	head.FilterHash = HashFilter(filter);
+	head.NumEntries = NumLumps;
+	head.PathLength = uint32_t((fullpath.length() + 8) & ~7);
+	memcpy(head.Hash, Hash, sizeof(head.Hash));
+
+	std::vector<FIndexCacheEntry> cached(NumLumps);
+	std::vector<char> strings;
+	for (uint32_t i = 0; i < NumLumps; i++)
+	{
+		auto& entry = Entries[i];
+		auto name = entry.FileName ? entry.FileName : "";
+		memset(&cached[i], 0, sizeof(cached[i]));
+		cached[i].Length = entry.Length;
+		cached[i].CompressedSize = entry.CompressedSize;
+		cached[i].Position = entry.Position;
+		cached[i].NameOffset = (uint32_t)strings.size();
+		cached[i].ResourceID = entry.ResourceID;
+		cached[i].CRC32 = entry.CRC32;
+		cached[i].Flags = entry.Flags;
+		cached[i].Method = entry.Method;
+		cached[i].Namespace = entry.Namespace;
+		strings.insert(strings.end(), name, name + strlen(name) + 1);
+	}
+	if (strings.empty()) strings.push_back(0);
+	head.StringSize = (uint32_t)strings.size();
+
+	std::vector<char> path(head.PathLength, 0);
+	memcpy(path.data(), fullpath.c_str(), fullpath.length());
+
+	// The file system library cannot use the engine's WriteFileReplace, so it renames the file itself.
+	auto cachename = IndexCacheName(filter, fullpath);
+	auto tempname = cachename + ".tmp";
+	FILE* f = myfopen(tempname.c_str(), "wb");
+	if (f == nullptr) return;
+	bool ok = fwrite(&head, sizeof(head), 1, f) == 1 &&
+		fwrite(path.data(), path.size(), 1, f) == 1 &&
+		(cached.empty() || fwrite(cached.data(), cached.size() * sizeof(FIndexCacheEntry), 1, f) == 1) &&
+		fwrite(strings.data(), strings.size(), 1, f) == 1;
+	ok = (fclose(f) == 0) && ok;
+#ifndef _WIN32
+	if (ok) ok = rename(tempname.c_str(), cachename.c_str()) == 0;
+	if (!ok) remove(tempname.c_str());
+#else
+	auto wtemp = toWide(tempname.c_str());
+	if (ok) ok = !!MoveFileExW(wtemp.c_str(), toWide(cachename.c_str()).c_str(), MOVEFILE_REPLACE_EXISTING);
+	if (!ok) DeleteFileW(wtemp.c_str());
+#endif
+}
+
+}
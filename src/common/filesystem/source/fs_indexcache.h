@@ -0,0 +1,8 @@
+#pragma once
+
+namespace FileSys {
+
+struct FIndexCacheMapping;
+void CloseIndexCacheMapping(FIndexCacheMapping* map);
+
+}
@@ -43,6 +43,7 @@
 #include "unicode.h"
 #include "fs_findfile.h"
 #include "fs_decompress.h"
+#include "fs_indexcache.h"
 #include "wildcards.hpp"
 #include <algorithm>
 
@@ -213,6 +214,7 @@ FResourceFile::FResourceFile(const char *filename, FileReader &r, StringPool* sp
 
 FResourceFile::~FResourceFile()
 {
+	CloseIndexCacheMapping(IndexCache);
 	if (!stringpool->shared) delete stringpool;
 }
 
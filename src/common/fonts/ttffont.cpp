@@ -1,4 +1,6 @@
 #include <cmath>
+#include <memory>
+#include <miniz.h>
 
 #include "engineerrors.h"
 #include "textures.h"
@@ -10,24 +12,310 @@
 #include "texturemanager.h"
 #include "fontinternals.h"
 #include "schrift.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "files.h"
+
+CVAR(Bool, ttf_glyphcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+static const uint8_t GlyphCacheMagic[4] = { 'T', 'T', 'F', '3' };
+
+//==========================================================================
+//
+// All glyphs of a font share one atlas. The pages get rasterized when the
+// font is created, unless the cache directory has them from an earlier run.
+// Glyphs the rasterizer fails on are recorded in the cache, so both ways
+// leave out the same glyphs.
+//
+//==========================================================================
+
+class FTTFGlyphAtlas
+{
+public:
+	enum { PAGE_SIZE = 512 };
+
+	FTTFGlyphAtlas(FileSys::FileData &&data, int height) : FontData(std::move(data))
+	{
+		sft.xScale = height;
+		sft.yScale = height;
+		sft.flags = SFT_DOWNWARD_Y;
+		sft.font = sft_loadmem(FontData.data(), FontData.size());
+		if (!sft.font)
+			I_FatalError("Could not load truetype font file");
+	}
+
+	~FTTFGlyphAtlas()
+	{
+		sft_freefont(sft.font);
+	}
+
+	const SFT &GetSFT() const { return sft; }
+
+	//==========================================================================
+	//
+	// Simple shelf packing. Glyphs of one font have similar heights so little
+	// space gets wasted. Each glyph keeps one blank pixel to its neighbors so
+	// that filtering does not pick up parts of them.
+	//
+	//==========================================================================
+
+	int Add(SFT_Glyph gid, int width, int height)
+	{
+		if (width + 1 > PAGE_SIZE || height + 1 > PAGE_SIZE) return -1;
+		if (ShelfX + width + 1 > PAGE_SIZE)
+		{
+			ShelfX = 0;
+			ShelfY += ShelfHeight;
+			ShelfHeight = 0;
+		}
+		if (ShelfY + height + 1 > PAGE_SIZE || Pages.Size() == 0)
+		{
+			Pages.Reserve(1);
+			PageHeights.Push(0);
+			ShelfX = ShelfY = ShelfHeight = 0;
+		}
+		FEntry entry = { gid, (int)Pages.Size() - 1, ShelfX, ShelfY, width, height, GLYPH_Unrendered };
+		ShelfX += width + 1;
+		ShelfHeight = max(ShelfHeight, height + 1);
+		PageHeights.Last() = max(PageHeights.Last(), ShelfY + height);
+		return Entries.Push(entry);
+	}
+
+	//==========================================================================
+	//
+	// Must be called after all glyphs have been added.
+	//
+	//==========================================================================
+
+	void Build(const char *fontname, int height, int lump)
+	{
+		FString cachefile;
+		if (ttf_glyphcache)
+		{
+			// Fonts in Zips come with a CRC. Everything else is small enough to compute one.
+			// The name contains the CRC so that different fonts with the same name do not overwrite each other's cache.
+			uint32_t crc = fileSystem.FileCRC32(lump);
+			if (crc == 0) crc = crc32(0, (const uint8_t *)FontData.data(), (unsigned)FontData.size());
+			cachefile.Format("%s/%s-%d-%08x.ttc", GetCacheSubPath("fontcache").GetChars(), fontname, height, crc);
+			InitCacheHeader((uint32_t)fileSystem.FileLength(lump), crc, height);
+			if (LoadCache(cachefile)) return;
+		}
+
+		for (unsigned i = 0; i < Pages.Size(); i++)
+		{
+			Pages[i].Resize(PAGE_SIZE * PageHeights[i]);
+			memset(Pages[i].Data(), 0, Pages[i].Size());
+		}
+		for (auto &entry : Entries)
+		{
+			Render(entry);
+		}
+		if (cachefile.IsNotEmpty()) SaveCache(cachefile);
+	}
+
+	bool IsFailed(int index) const
+	{
+		return Entries[index].State == GLYPH_Failed;
+	}
+
+	int GetPageCount() const { return Pages.Size(); }
+	int GetPageHeight(int page) const { return PageHeights[page]; }
+	const uint8_t *GetPage(int page) const { return Pages[page].Data(); }
+
+	// Returns the glyph's page and its rectangle on it.
+	int GetRect(int index, int *x, int *y) const
+	{
+		auto &entry = Entries[index];
+		*x = entry.X;
+		*y = entry.Y;
+		return entry.Page;
+	}
+
+	void GetPixels(int index, uint8_t *dest) const
+	{
+		auto &entry = Entries[index];
+		auto &page = Pages[entry.Page];
+		for (int y = 0; y < entry.Height; y++)
+		{
+			memcpy(dest + y * entry.Width, &page[(entry.Y + y) * PAGE_SIZE + entry.X], entry.Width);
+		}
+	}
+
+private:
+	enum
+	{
+		GLYPH_Unrendered,
+		GLYPH_Rendered,
+		GLYPH_Failed
+	};
+
+	struct FEntry
+	{
+		SFT_Glyph Glyph;
+		int Page;
+		int X, Y;
+		int Width, Height;
+		uint8_t State;
+	};
+
+	// Everything the cached pages depend on. The layout follows from these, too.
+	struct FCacheHeader
+	{
+		uint8_t Magic[4];
+		uint32_t FileSize;
+		uint32_t FileCRC;
+		int32_t Height;
+		int32_t PageSize;
+		uint32_t NumEntries;
+		uint32_t NumPages;
+	};
+
+	void Render(FEntry &entry)
+	{
+		auto &page = Pages[entry.Page];
+		TArray<uint8_t> pixels(entry.Width * entry.Height, true);
+		memset(pixels.Data(), 0, pixels.Size());
+		SFT_Image img = {};
+		img.width = entry.Width;
+		img.height = entry.Height;
+		img.pixels = pixels.Data();
+		if (sft_render(&sft, entry.Glyph, img) < 0)
+		{
+			entry.State = GLYPH_Failed;
+			return;
+		}
+		entry.State = GLYPH_Rendered;
+		for (int y = 0; y < entry.Height; y++)
+		{
+			memcpy(&page[(entry.Y + y) * PAGE_SIZE + entry.X], &pixels[y * entry.Width], entry.Width);
+		}
+	}
+
+	void InitCacheHeader(uint32_t filesize, uint32_t crc, int height)
+	{
+		memcpy(Header.Magic, GlyphCacheMagic, 4);
+		Header.FileSize = filesize;
+		Header.FileCRC = crc;
+		Header.Height = height;
+		Header.PageSize = PAGE_SIZE;
+		Header.NumEntries = Entries.Size();
+		Header.NumPages = Pages.Size();
+	}
+
+	bool LoadCache(const FString &cachefile)
+	{
+		FileReader fr;
+		if (!fr.OpenFile(cachefile.GetChars())) return false;
+
+		FCacheHeader header;
+		if (fr.Read(&header, sizeof(header)) != (FileReader::Size)sizeof(header) || memcmp(&header, &Header, sizeof(header))) return false;
+
+		TArray<uint8_t> states(Entries.Size(), true);
+		if (fr.Read(states.Data(), states.Size()) != (FileReader::Size)states.Size()) return false;
+
+		TArray<TArray<uint8_t>> pages(Pages.Size(), true);
+		for (unsigned i = 0; i < Pages.Size(); i++)
+		{
+			pages[i].Resize(PAGE_SIZE * PageHeights[i]);
+			if (fr.Read(pages[i].Data(), pages[i].Size()) != (FileReader::Size)pages[i].Size()) return false;
+		}
+		for (auto state : states)
+		{
+			if (state != GLYPH_Rendered && state != GLYPH_Failed) return false;
+		}
+
+		Pages = std::move(pages);
+		for (unsigned i = 0; i < Entries.Size(); i++) Entries[i].State = states[i];
+		return true;
+	}
+
+	void SaveCache(const FString &cachefile)
+	{
+		TArray<uint8_t> states(Entries.Size(), true);
+		for (unsigned i = 0; i < Entries.Size(); i++) states[i] = Entries[i].State;
+
+		WriteFileReplace(cachefile.GetChars(), [&](FileWriter *fw)
+		{
+			bool ok = fw->Write(&Header, sizeof(Header)) == sizeof(Header) && fw->Write(states.Data(), states.Size()) == states.Size();
+			for (unsigned i = 0; i < Pages.Size() && ok; i++)
+			{
+				ok = fw->Write(Pages[i].Data(), Pages[i].Size()) == Pages[i].Size();
+			}
+			return ok;
+		});
+	}
+
+	FileSys::FileData FontData;
+	SFT sft = {};
+	TArray<TArray<uint8_t>> Pages;
+	TArray<int> PageHeights;
+	TArray<FEntry> Entries;
+	int ShelfX = 0, ShelfY = 0, ShelfHeight = 0;
+	FCacheHeader Header = {};
+};
+
+//==========================================================================
+//
+// An atlas page. 2D drawing of the glyphs samples from this texture.
+//
+//==========================================================================
+
+class FTTFAtlasPage : public FImageSource
+{
+public:
+	FTTFAtlasPage(std::shared_ptr<FTTFGlyphAtlas> atlas, int page, PalEntry* palette)
+	{
+		Width = FTTFGlyphAtlas::PAGE_SIZE;
+		Height = atlas->GetPageHeight(page);
+		Atlas = std::move(atlas);
+		Page = page;
+		Palette = palette;
+	}
+
+	PalettedPixels CreatePalettedPixels(int conversion, int frame = 0) override
+	{
+		PalettedPixels OutPixels(Width * Height);
+		memcpy(OutPixels.Data(), Atlas->GetPage(Page), Width * Height);
+		return OutPixels;
+	}
+
+	int CopyPixels(FBitmap* bmp, int conversion)
+	{
+		bmp->CopyPixelData(0, 0, Atlas->GetPage(Page), Width, Height, 1, Width, 0, Palette);
+		return 0;
+	}
+
+private:
+	std::shared_ptr<FTTFGlyphAtlas> Atlas;
+	int Page;
+	PalEntry* Palette = nullptr;
+};
+
+//==========================================================================
+//
+// A single glyph. This is only used when the glyph texture gets drawn
+// some other way than as a plain 2D image, e.g. as a fill pattern.
+//
+//==========================================================================
 
 class FTTFGlyph : public FImageSource
 {
 public:
-	FTTFGlyph(int width, int height, int leftoffset, int topoffset, TArray<uint8_t> pixels, PalEntry* palette)
+	FTTFGlyph(int width, int height, int leftoffset, int topoffset, std::shared_ptr<FTTFGlyphAtlas> atlas, int index, PalEntry* palette)
 	{
 		Width = width;
 		Height = height;
 		LeftOffset = leftoffset;
 		TopOffset = topoffset;
-		Pixels = std::move(pixels);
+		Atlas = std::move(atlas);
+		Index = index;
 		Palette = palette;
 	}
 
 	PalettedPixels CreatePalettedPixels(int conversion, int frame = 0) override
 	{
-		PalettedPixels OutPixels(Pixels.Size());
-		memcpy(OutPixels.Data(), Pixels.Data(), Pixels.Size());
+		PalettedPixels OutPixels(Width * Height);
+		Atlas->GetPixels(Index, OutPixels.Data());
 		return OutPixels;
 	}
 
@@ -42,7 +330,8 @@ public:
 	}
 
 private:
-	TArray<uint8_t> Pixels;
+	std::shared_ptr<FTTFGlyphAtlas> Atlas;
+	int Index;
 	PalEntry* Palette = nullptr;
 };
 
@@ -51,15 +340,8 @@ class FTTFFont : public FFont
 public:
 	FTTFFont(const char* fontname, int height, int lump) : FFont(lump)
 	{
-		auto lumpdata = fileSystem.ReadFile(lump);
-
-		SFT sft = {};
-		sft.xScale = height;
-		sft.yScale = height;
-		sft.flags = SFT_DOWNWARD_Y;
-		sft.font = sft_loadmem(lumpdata.data(), lumpdata.size());
-		if (!sft.font)
-			I_FatalError("Could not load truetype font file");
+		Atlas = std::make_shared<FTTFGlyphAtlas>(fileSystem.ReadFile(lump), height);
+		auto &sft = Atlas->GetSFT();
 
 		SFT_LMetrics lmtx;
 		if (sft_lmetrics(&sft, &lmtx) < 0)
@@ -90,6 +372,14 @@ public:
 			palette[i] = PalEntry(i, 255, 255, 255);
 		}
 
+		struct FPendingGlyph
+		{
+			int Char;
+			int Index;
+			int Width, Height;
+			SFT_GMetrics Metrics;
+		};
+		TArray<FPendingGlyph> glyphs;
 		Chars.Resize(LastChar - FirstChar + 1);
 		for (int i = FirstChar; i <= LastChar; i++)
 		{
@@ -104,18 +394,37 @@ public:
 			if (mtx.minWidth <= 0 || mtx.minHeight <= 0)
 				continue;
 
-			SFT_Image img = {};
-			img.width = (mtx.minWidth + 3) & ~3;
-			img.height = mtx.minHeight;
+			int width = (mtx.minWidth + 3) & ~3;
+			int height = mtx.minHeight;
+			int index = Atlas->Add(gid, width, height);
+			if (index < 0)
+				continue;
 
-			TArray<uint8_t> pixels(img.width * img.height, true);
-			img.pixels = pixels.Data();
-			if (sft_render(&sft, gid, img) < 0)
+			glyphs.Push({ i, index, width, height, mtx });
+		}
+		Atlas->Build(fontname, height, lump);
+
+		TArray<FGameTexture*> pages(Atlas->GetPageCount(), true);
+		for (int i = 0; i < Atlas->GetPageCount(); i++)
+		{
+			pages[i] = MakeGameTexture(new FImageTexture(new FTTFAtlasPage(Atlas, i, palette)), nullptr, ETextureType::FontChar);
+			TexMan.AddGameTexture(pages[i]);
+		}
+
+		for (auto &glyph : glyphs)
+		{
+			if (Atlas->IsFailed(glyph.Index))
 				continue;
 
-			Chars[i - FirstChar].OriginalPic = MakeGameTexture(new FImageTexture(CreateGlyph(lmtx, mtx, img.width, img.height, std::move(pixels))), nullptr, ETextureType::FontChar);
-			Chars[i - FirstChar].XMove = (int)std::floor(mtx.advanceWidth) + 1;
-			TexMan.AddGameTexture(Chars[i - FirstChar].OriginalPic);
+			int x, y;
+			int page = Atlas->GetRect(glyph.Index, &x, &y);
+			float pagewidth = pages[page]->GetTexelWidth(), pageheight = pages[page]->GetTexelHeight();
+
+			auto &ch = Chars[glyph.Char - FirstChar];
+			ch.OriginalPic = MakeGameTexture(new FImageTexture(CreateGlyph(lmtx, glyph.Metrics, glyph.Width, glyph.Height, glyph.Index)), nullptr, ETextureType::FontChar);
+			ch.OriginalPic->SetAtlas(pages[page], { x / pagewidth, y / pageheight, glyph.Width / pagewidth, glyph.Height / pageheight });
+			ch.XMove = (int)std::floor(glyph.Metrics.advanceWidth) + 1;
+			TexMan.AddGameTexture(ch.OriginalPic);
 		}
 	}
 
@@ -132,11 +441,12 @@ public:
 		}
 	}
 
-	virtual FTTFGlyph* CreateGlyph(const SFT_LMetrics& lmtx, const SFT_GMetrics& mtx, int width, int height, TArray<uint8_t> pixels)
+	virtual FTTFGlyph* CreateGlyph(const SFT_LMetrics& lmtx, const SFT_GMetrics& mtx, int width, int height, int index)
 	{
-		return new FTTFGlyph(width, height, (int)std::round(-mtx.leftSideBearing), -mtx.yOffset - (int)std::round(lmtx.ascender + lmtx.descender + lmtx.lineGap * 0.5), std::move(pixels), palette);
+		return new FTTFGlyph(width, height, (int)std::round(-mtx.leftSideBearing), -mtx.yOffset - (int)std::round(lmtx.ascender + lmtx.descender + lmtx.lineGap * 0.5), Atlas, index, palette);
 	}
 
+	std::shared_ptr<FTTFGlyphAtlas> Atlas;
 	PalEntry palette[256];
 };
 
@@ -63,6 +63,7 @@
 #include "stats.h"
 #include "printf.h"
 #include "cmdlib.h"
+#include "metrics.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -172,6 +173,8 @@ bool HadToDestroy;
 
 static FAveragizer AllocHistory;// Tracks allocation rate over time
 static cycle_t GCTime;			// Track time spent in GC
+static FGaugeMetric AllocMetric("gc.alloc_kb", METRIC_Tic);
+static FGaugeMetric ThresholdMetric("gc.threshold_kb", METRIC_Tic);
 
 // CODE --------------------------------------------------------------------
 
@@ -192,6 +195,11 @@ void CheckGC()
 	{
 		Step();
 	}
+	if (MetricsActive)
+	{
+		AllocMetric.Set((AllocBytes + 1023) >> 10);
+		ThresholdMetric.Set((Threshold + 1023) >> 10);
+	}
 }
 
 //==========================================================================
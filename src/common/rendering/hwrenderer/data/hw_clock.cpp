@@ -40,6 +40,7 @@
 #include "i_time.h"
 #include "i_interface.h"
 #include "printf.h"
+#include "metrics.h"
 
 glcycle_t RenderWall,SetupWall,ClipWall;
 glcycle_t RenderFlat,SetupFlat;
@@ -56,6 +57,15 @@ int vertexcount, flatvertices, flatprimitives;
 int rendered_lines,rendered_flats,rendered_sprites,render_vertexsplit,render_texsplit,rendered_decals, rendered_portals, rendered_commandbuffers;
 int iter_dlightf, iter_dlight, draw_dlight, draw_dlightf;
 
+FCounterMetric DrawCallMetric("render.drawcalls", METRIC_Frame);
+FCounterMetric TextureUploadMetric("render.texture_uploads", METRIC_Frame);
+FCounterMetric TextureUploadBytesMetric("render.texture_upload_bytes", METRIC_Frame);
+static FHistogramMetric SceneTimeMetric("render.scene_ms", METRIC_Frame, { 2, 4, 8, 12, 16.7, 25, 33.4 });
+static FGaugeMetric WallMetric("render.walls", METRIC_Frame);
+static FGaugeMetric FlatMetric("render.flats", METRIC_Frame);
+static FGaugeMetric SpriteMetric("render.sprites", METRIC_Frame);
+static FGaugeMetric PortalMetric("render.portals", METRIC_Frame);
+
 void ResetProfilingData()
 {
 	All.Reset();
@@ -80,6 +90,22 @@ void ResetProfilingData()
 	render_texsplit=render_vertexsplit=rendered_lines=rendered_flats=rendered_sprites=rendered_decals=rendered_portals = 0;
 }
 
+//-----------------------------------------------------------------------------
+//
+// Must be called after the scene has been rendered and 'All' is unclocked.
+//
+//-----------------------------------------------------------------------------
+
+void RecordRenderMetrics()
+{
+	if (!MetricsActive) return;
+	SceneTimeMetric.Record(All.TimeMS());
+	WallMetric.Set(rendered_lines);
+	FlatMetric.Set(rendered_flats);
+	SpriteMetric.Set(rendered_sprites);
+	PortalMetric.Set(rendered_portals);
+}
+
 //-----------------------------------------------------------------------------
 //
 // Rendering statistics
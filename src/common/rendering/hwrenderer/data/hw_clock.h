@@ -3,6 +3,7 @@
 
 #include "stats.h"
 #include "m_fixed.h"
+#include "metrics.h"
 
 extern glcycle_t RenderWall,SetupWall,ClipWall;
 extern glcycle_t RenderFlat,SetupFlat;
@@ -20,7 +21,10 @@ extern int rendered_portals;
 
 extern int vertexcount, flatvertices, flatprimitives;
 
+extern FCounterMetric TextureUploadMetric, TextureUploadBytesMetric;
+
 void ResetProfilingData();
+void RecordRenderMetrics();
 void CheckBench();
 void  checkBenchActive();
 
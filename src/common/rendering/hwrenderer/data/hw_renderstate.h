@@ -9,6 +9,7 @@
 #include "i_interface.h"
 #include "hw_viewpointuniforms.h"
 #include "hw_cvars.h"
+#include "metrics.h"
 
 #include <atomic>
 
@@ -129,6 +130,8 @@ struct Fogball
 	float Fog;
 };
 
+extern FCounterMetric DrawCallMetric;
+
 class FRenderState
 {
 protected:
@@ -732,6 +735,7 @@ public:
 
 	void Draw(int dt, int index, int count, bool apply = true)
 	{
+		DrawCallMetric.Add();
 		if(mWireframe == 0)
 		{
 			mSurfaceUniforms.uObjectColor = uObjectColor;
@@ -758,6 +762,7 @@ public:
 
 	void DrawIndexed(int dt, int index, int count, bool apply = true)
 	{
+		DrawCallMetric.Add();
 		if(mWireframe == 0)
 		{
 			mSurfaceUniforms.uObjectColor = uObjectColor;
@@ -26,6 +26,7 @@
 #include "buffers.h"
 #include "hwrenderer/postprocessing/hw_postprocess.h"
 #include "v_video.h"
+#include "metrics.h"
 
 /*
 	The 1D shadow maps are stored in a 1024x1024 texture as float depth values (R32F).
@@ -59,6 +60,10 @@ cycle_t ShadowMap::UpdateCycles;
 int ShadowMap::LightsProcessed;
 int ShadowMap::LightsShadowmapped;
 
+static FGaugeMetric ShadowmapTimeMetric("shadowmap.upload_ms", METRIC_Frame);
+static FGaugeMetric ShadowmapLightsMetric("shadowmap.lights", METRIC_Frame);
+static FGaugeMetric ShadowmapShadowedMetric("shadowmap.shadowmapped", METRIC_Frame);
+
 ADD_STAT(shadowmap)
 {
 	FString out;
@@ -94,6 +99,13 @@ void ShadowMap::PerformUpdate()
 
 		UpdateCycles.Unclock();
 	}
+
+	if (MetricsActive)
+	{
+		ShadowmapTimeMetric.Set(UpdateCycles.TimeMS());
+		ShadowmapLightsMetric.Set(LightsProcessed);
+		ShadowmapShadowedMetric.Set(LightsShadowmapped);
+	}
 }
 
 ShadowMap::~ShadowMap()
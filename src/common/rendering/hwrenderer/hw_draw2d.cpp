@@ -84,6 +84,7 @@ void Draw2D(F2DDrawer* drawer, FRenderState& state, int x, int y, int width, int
 
 	if (drawer->mIsFirstPass)
 	{
+		drawer->OptimizeBatches();
 		for (auto &v : vertices)
 		{
 			// Change from BGRA to RGBA
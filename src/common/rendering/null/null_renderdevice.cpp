@@ -0,0 +1,291 @@
+/*
+**  Null render backend
+**  Copyright (c) 2016-2020 Magnus Norddahl
+**  Copyright (c) 2026 agent
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+
+#include "null_renderdevice.h"
+#include "v_draw.h"
+#include "v_2ddrawer.h"
+#include "hw_skydome.h"
+#include "hw_shadowmap.h"
+#include "hw_material.h"
+#include "hw_clock.h"
+#include "m_argv.h"
+#include "printf.h"
+#include "stats.h"
+#include "files.h"
+
+//==========================================================================
+//
+// NullBuffer
+//
+// Keeps a CPU copy of the data because some users read back from the
+// mapped memory.
+//
+//==========================================================================
+
+void NullBuffer::SetData(size_t size, const void* data, BufferUsageType type)
+{
+	mData.resize(size);
+	if (data != nullptr)
+	{
+		memcpy(mData.data(), data, size);
+		fb->Stats().BufferUploads++;
+		fb->Stats().BufferBytes += size;
+	}
+	buffersize = size;
+	map = mData.data();
+}
+
+void NullBuffer::SetSubData(size_t offset, size_t size, const void* data)
+{
+	memcpy(mData.data() + offset, data, size);
+	fb->Stats().BufferUploads++;
+	fb->Stats().BufferBytes += size;
+}
+
+void* NullBuffer::Lock(unsigned int size)
+{
+	if (mData.size() < size)
+	{
+		mData.resize(size);
+		buffersize = size;
+		map = mData.data();
+	}
+	return map;
+}
+
+void NullBuffer::Unlock()
+{
+	fb->Stats().BufferUploads++;
+	fb->Stats().BufferBytes += buffersize;
+}
+
+void NullBuffer::Upload(size_t start, size_t size)
+{
+	fb->Stats().BufferUploads++;
+	fb->Stats().BufferBytes += size;
+}
+
+//==========================================================================
+//
+// NullHardwareTexture
+//
+//==========================================================================
+
+void NullHardwareTexture::AllocateBuffer(int w, int h, int texelsize)
+{
+	mTexelsize = texelsize;
+	mBuffer.Resize(w * h * texelsize);
+	bufferpitch = w;
+}
+
+uint8_t* NullHardwareTexture::MapBuffer()
+{
+	return mBuffer.Data();
+}
+
+unsigned int NullHardwareTexture::CreateTexture(unsigned char* buffer, int w, int h, int texunit, bool mipmap, const char* name)
+{
+	if (buffer)
+	{
+		fb->Stats().TextureUploads++;
+		fb->Stats().TextureBytes += w * h * mTexelsize;
+		TextureUploadMetric.Add();
+		TextureUploadBytesMetric.Add(w * h * mTexelsize);
+	}
+	return 0;
+}
+
+//==========================================================================
+//
+// Does the same work a real backend does when a texture is first used,
+// only the resulting pixels get discarded.
+//
+//==========================================================================
+
+void NullHardwareTexture::Bind(FTexture* tex, int translation, int flags)
+{
+	if (mCreated) return;
+	mCreated = true;
+
+	if (tex->isHardwareCanvas()) return;
+
+	FTextureBuffer texbuffer = tex->CreateTexBuffer(translation, flags | CTF_ProcessData);
+	CreateTexture(texbuffer.mBuffer, texbuffer.mWidth, texbuffer.mHeight, 0, false, nullptr);
+}
+
+//==========================================================================
+//
+// NullRenderDevice
+//
+//==========================================================================
+
+NullRenderDevice::NullRenderDevice(int width, int height) : DFrameBuffer(width, height), mClientWidth(width), mClientHeight(height)
+{
+}
+
+NullRenderDevice::~NullRenderDevice()
+{
+	delete mSkyData;
+	delete mShadowMap;
+	mSkyData = nullptr;
+	mShadowMap = nullptr;
+}
+
+void NullRenderDevice::InitializeState()
+{
+	vendorstring = "Null";
+
+	mSkyData = new FSkyVertexBuffer(this);
+	mShadowMap = new ShadowMap(this);
+
+	mRenderState = std::make_unique<NullRenderState>(this);
+
+	const char* tracefile = Args->CheckValue("-rendertrace");
+	if (tracefile != nullptr)
+	{
+		mTrace.reset(FileWriter::Open(tracefile));
+		if (mTrace == nullptr)
+		{
+			Printf(TEXTCOLOR_RED "Unable to open render trace file %s\n", tracefile);
+		}
+		else
+		{
+			mTrace->Printf("frame,draws,indexeddraws,vertices,indices,pipelinechanges,materialchanges,streamvertices,"
+				"viewpoints,lights,bones,fogballs,uniformbytes,bufferuploads,bufferbytes,textureuploads,texturebytes,clears\n");
+		}
+	}
+
+	Printf("Using the null render device. Nothing will be displayed.\n");
+}
+
+void NullRenderDevice::SetWindowSize(int w, int h)
+{
+	mClientWidth = w;
+	mClientHeight = h;
+}
+
+void NullRenderDevice::BeginFrame()
+{
+	SetViewportRects(nullptr);
+	mRenderState->BeginFrame();
+}
+
+void NullRenderDevice::Update()
+{
+	Draw2D();
+	twod->Clear();
+
+	mLastFrame = mStats;
+	mFrameCount++;
+	WriteTrace();
+	mStats.Reset();
+
+	DFrameBuffer::Update();
+}
+
+void NullRenderDevice::WriteTrace()
+{
+	if (mTrace == nullptr) return;
+
+	const FNullRenderStats& s = mLastFrame;
+	mTrace->Printf("%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+		(unsigned long long)mFrameCount, (unsigned long long)s.DrawCalls, (unsigned long long)s.IndexedDrawCalls,
+		(unsigned long long)s.Vertices, (unsigned long long)s.Indices, (unsigned long long)s.PipelineChanges,
+		(unsigned long long)s.MaterialChanges, (unsigned long long)s.StreamVertices, (unsigned long long)s.ViewpointUploads,
+		(unsigned long long)s.LightUploads, (unsigned long long)s.BoneUploads, (unsigned long long)s.FogballUploads,
+		(unsigned long long)s.UniformBytes, (unsigned long long)s.BufferUploads, (unsigned long long)s.BufferBytes,
+		(unsigned long long)s.TextureUploads, (unsigned long long)s.TextureBytes, (unsigned long long)s.Clears);
+}
+
+IHardwareTexture* NullRenderDevice::CreateHardwareTexture(int numchannels)
+{
+	return new NullHardwareTexture(this, numchannels);
+}
+
+void NullRenderDevice::PrecacheMaterial(FMaterial* mat, int translation)
+{
+	if (mat->Source()->GetUseType() == ETextureType::SWCanvas) return;
+
+	MaterialLayerInfo* layer;
+
+	auto systex = static_cast<NullHardwareTexture*>(mat->GetLayer(0, translation, &layer));
+	systex->Bind(layer->layerTexture, translation, layer->scaleFlags);
+
+	int numLayers = mat->NumLayers();
+	for (int i = 1; i < numLayers; i++)
+	{
+		auto syslayer = static_cast<NullHardwareTexture*>(mat->GetLayer(i, 0, &layer));
+		syslayer->Bind(layer->layerTexture, 0, layer->scaleFlags);
+	}
+}
+
+IBuffer* NullRenderDevice::CreateVertexBuffer(int numBindingPoints, int numAttributes, size_t stride, const FVertexBufferAttribute* attrs)
+{
+	return new NullBuffer(this);
+}
+
+IBuffer* NullRenderDevice::CreateIndexBuffer()
+{
+	return new NullBuffer(this);
+}
+
+FRenderState* NullRenderDevice::RenderState()
+{
+	return mRenderState.get();
+}
+
+void NullRenderDevice::Draw2D()
+{
+	::Draw2D(twod, *mRenderState);
+}
+
+void NullRenderDevice::RenderTextureView(FCanvasTexture* tex, std::function<void(IntRect&)> renderFunc)
+{
+	IntRect bounds;
+	bounds.left = bounds.top = 0;
+	bounds.width = tex->GetWidth();
+	bounds.height = tex->GetHeight();
+
+	renderFunc(bounds);
+
+	tex->SetUpdated(true);
+}
+
+ADD_STAT(nullrender)
+{
+	FString out;
+	auto fb = dynamic_cast<NullRenderDevice*>(screen);
+	if (fb == nullptr)
+	{
+		out = "Null render device not active";
+		return out;
+	}
+	const FNullRenderStats& s = fb->LastFrameStats();
+	out.Format("Draws=%llu (indexed %llu), vertices=%llu, indices=%llu, pipeline changes=%llu, material changes=%llu\n"
+		"Uniform bytes=%llu, buffer bytes=%llu, texture uploads=%llu (%llu bytes)",
+		(unsigned long long)s.DrawCalls, (unsigned long long)s.IndexedDrawCalls, (unsigned long long)s.Vertices, (unsigned long long)s.Indices,
+		(unsigned long long)s.PipelineChanges, (unsigned long long)s.MaterialChanges, (unsigned long long)s.UniformBytes,
+		(unsigned long long)s.BufferBytes, (unsigned long long)s.TextureUploads, (unsigned long long)s.TextureBytes);
+	return out;
+}
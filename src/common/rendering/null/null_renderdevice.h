@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "v_video.h"
+#include "buffers.h"
+#include "hw_ihwtexture.h"
+#include "null_renderstate.h"
+#include "i_video.h"
+
+// A render device that runs the complete CPU side of the hardware renderer
+// without talking to any graphics API. Draw calls, state changes and uploads
+// are only counted so that renderer CPU cost can be measured on machines
+// without a GPU. Selected with -nullrenderer, -rendertrace <file> writes
+// one CSV row per frame.
+
+class FileWriter;
+
+class NullBuffer : public IBuffer
+{
+public:
+	NullBuffer(NullRenderDevice* fb) : fb(fb) { }
+
+	void SetData(size_t size, const void* data, BufferUsageType type) override;
+	void SetSubData(size_t offset, size_t size, const void* data) override;
+	void* Lock(unsigned int size) override;
+	void Unlock() override;
+	void Upload(size_t start, size_t size) override;
+
+private:
+	NullRenderDevice* fb;
+	std::vector<uint8_t> mData;
+};
+
+class NullHardwareTexture : public IHardwareTexture
+{
+public:
+	NullHardwareTexture(NullRenderDevice* fb, int numchannels) : fb(fb), mTexelsize(numchannels) { }
+
+	void AllocateBuffer(int w, int h, int texelsize) override;
+	uint8_t* MapBuffer() override;
+	unsigned int CreateTexture(unsigned char* buffer, int w, int h, int texunit, bool mipmap, const char* name) override;
+
+	void Bind(FTexture* tex, int translation, int flags);
+
+private:
+	NullRenderDevice* fb;
+	int mTexelsize;
+	bool mCreated = false;
+	TArray<uint8_t> mBuffer;
+};
+
+class NullRenderDevice : public DFrameBuffer
+{
+public:
+	NullRenderDevice(int width, int height);
+	~NullRenderDevice();
+
+	void InitializeState() override;
+	void Update() override;
+	void BeginFrame() override;
+	bool IsFullscreen() override { return false; }
+	int GetClientWidth() override { return mClientWidth; }
+	int GetClientHeight() override { return mClientHeight; }
+	void SetWindowSize(int w, int h) override;
+	const char* DeviceName() const override { return "Null"; }
+
+	IHardwareTexture* CreateHardwareTexture(int numchannels) override;
+	void PrecacheMaterial(FMaterial* mat, int translation) override;
+	IBuffer* CreateVertexBuffer(int numBindingPoints, int numAttributes, size_t stride, const FVertexBufferAttribute* attrs) override;
+	IBuffer* CreateIndexBuffer() override;
+	FRenderState* RenderState() override;
+	void Draw2D() override;
+	void RenderTextureView(FCanvasTexture* tex, std::function<void(IntRect&)> renderFunc) override;
+
+	FNullRenderStats& Stats() { return mStats; }
+	const FNullRenderStats& LastFrameStats() const { return mLastFrame; }
+	uint64_t FrameCount() const { return mFrameCount; }
+
+private:
+	void WriteTrace();
+
+	int mClientWidth;
+	int mClientHeight;
+	std::unique_ptr<NullRenderState> mRenderState;
+	FNullRenderStats mStats = {};
+	FNullRenderStats mLastFrame = {};
+	uint64_t mFrameCount = 0;
+	std::unique_ptr<FileWriter> mTrace;
+};
+
+// Stands in for the platform's video interface so that no window gets created.
+class NullVideo : public IVideo
+{
+public:
+	NullVideo(int width, int height) : mWidth(width), mHeight(height) {}
+
+	DFrameBuffer *CreateFrameBuffer() override { return new NullRenderDevice(mWidth, mHeight); }
+
+private:
+	int mWidth;
+	int mHeight;
+};
@@ -0,0 +1,341 @@
+/*
+**  Null render backend
+**  Copyright (c) 2016-2020 Magnus Norddahl
+**  Copyright (c) 2026 agent
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+
+#include "null_renderstate.h"
+#include "null_renderdevice.h"
+#include "hw_viewpointuniforms.h"
+#include "hw_dynlightdata.h"
+#include "engineerrors.h"
+
+NullRenderState::NullRenderState(NullRenderDevice* fb) : fb(fb), mStats(&fb->Stats())
+{
+	mVertices.Resize(BUFFER_SIZE);
+	Reset();
+}
+
+//==========================================================================
+//
+// Draw commands
+//
+//==========================================================================
+
+void NullRenderState::ClearScreen()
+{
+	int width = fb->GetWidth();
+	int height = fb->GetHeight();
+
+	auto vertices = AllocVertices(4);
+	FFlatVertex* v = vertices.first;
+	v[0].Set(0, 0, 0, 0, 0);
+	v[1].Set(0, (float)height, 0, 0, 1);
+	v[2].Set((float)width, 0, 0, 1, 0);
+	v[3].Set((float)width, (float)height, 0, 1, 1);
+
+	Set2DViewpoint(width, height);
+	SetColor(0, 0, 0);
+	Apply(DT_TriangleStrip);
+
+	mStats->DrawCalls++;
+	mStats->Vertices += 4;
+}
+
+void NullRenderState::DoDraw(int dt, int index, int count, bool apply)
+{
+	Apply(dt);
+	mStats->DrawCalls++;
+	mStats->Vertices += count;
+}
+
+void NullRenderState::DoDrawIndexed(int dt, int index, int count, bool apply)
+{
+	Apply(dt);
+	mStats->IndexedDrawCalls++;
+	mStats->Indices += count;
+}
+
+//==========================================================================
+//
+// Collects the state a real backend would create a pipeline for and
+// counts how often it changes between draws.
+//
+//==========================================================================
+
+void NullRenderState::Apply(int dt)
+{
+	FNullPipelineKey key;
+	memset(&key, 0, sizeof(key));	// the padding must be cleared for the comparison.
+	key.RenderStyle = mRenderStyle.AsDWORD;
+	key.DrawType = dt;
+	key.ShaderIndex = mSpecialEffect > EFF_NONE ? -mSpecialEffect : mTextureEnabled ? getShaderIndex() : SHADER_NoTexture;
+	key.TextureMode = GetTextureModeAndFlags((mMaterial.mMaterial && mMaterial.mMaterial->Source()->isHardwareCanvas()) ? TM_OPAQUE : TM_NORMAL);
+	key.VertexBuffer = mVertexBuffer;
+	key.DepthTest = mDepthTest;
+	key.DepthWrite = mDepthTest && mDepthWrite;
+	key.DepthFunc = mDepthFunc;
+	key.DepthClamp = mDepthClamp;
+	key.StencilTest = mStencilTest;
+	key.StencilOp = mStencilOp;
+	key.ColorMask = mColorMask;
+	key.CullMode = mCullMode;
+
+	if (memcmp(&key, &mPipelineKey, sizeof(key)) != 0)
+	{
+		mPipelineKey = key;
+		mStats->PipelineChanges++;
+	}
+
+	ApplyMaterial();
+
+	// Surface uniforms are written for every draw by the real backends.
+	mStats->UniformBytes += sizeof(SurfaceUniforms);
+}
+
+//==========================================================================
+//
+// Binding a material creates its textures exactly like a real backend so
+// that texture creation cost shows up in the measurements.
+//
+//==========================================================================
+
+void NullRenderState::ApplyMaterial()
+{
+	if (!mMaterial.mChanged) return;
+	mMaterial.mChanged = false;
+	mStats->MaterialChanges++;
+
+	auto mat = mMaterial.mMaterial;
+	if (mat == nullptr) return;
+
+	auto source = mat->Source();
+	if (source->isHardwareCanvas())
+		static_cast<FCanvasTexture*>(source->GetTexture())->NeedUpdate();
+
+	MaterialLayerInfo* layer;
+	auto systex = static_cast<NullHardwareTexture*>(mat->GetLayer(0, mMaterial.mTranslation, &layer));
+	systex->Bind(layer->layerTexture, mMaterial.mTranslation, layer->scaleFlags);
+
+	int translation = (layer->scaleFlags & CTF_Indexed) ? mMaterial.mTranslation : 0;
+	int numLayers = mat->NumLayers();
+	for (int i = 1; i < numLayers; i++)
+	{
+		auto syslayer = static_cast<NullHardwareTexture*>(mat->GetLayer(i, translation, &layer));
+		syslayer->Bind(layer->layerTexture, 0, layer->scaleFlags);
+	}
+}
+
+//==========================================================================
+//
+// Immediate render state changes
+//
+//==========================================================================
+
+bool NullRenderState::SetDepthClamp(bool on)
+{
+	bool lastValue = mDepthClamp;
+	mDepthClamp = on;
+	return lastValue;
+}
+
+void NullRenderState::SetDepthMask(bool on)
+{
+	mDepthWrite = on;
+}
+
+void NullRenderState::SetDepthFunc(int func)
+{
+	mDepthFunc = func;
+}
+
+void NullRenderState::SetDepthRange(float min, float max)
+{
+}
+
+void NullRenderState::SetColorMask(bool r, bool g, bool b, bool a)
+{
+	mColorMask = (int)r | (int)g << 1 | (int)b << 2 | (int)a << 3;
+}
+
+void NullRenderState::SetStencil(int offs, int op, int flags)
+{
+	mStencilOp = op;
+
+	if (flags != -1)
+	{
+		bool cmon = !(flags & SF_ColorMaskOff);
+		SetColorMask(cmon, cmon, cmon, cmon);
+		mDepthWrite = !(flags & SF_DepthMaskOff);
+	}
+}
+
+void NullRenderState::SetCulling(int mode)
+{
+	mCullMode = mode;
+}
+
+void NullRenderState::Clear(int targets)
+{
+	mStats->Clears++;
+}
+
+void NullRenderState::EnableStencil(bool on)
+{
+	mStencilTest = on;
+}
+
+void NullRenderState::SetScissor(int x, int y, int w, int h)
+{
+}
+
+void NullRenderState::SetViewport(int x, int y, int w, int h)
+{
+}
+
+void NullRenderState::EnableDepthTest(bool on)
+{
+	mDepthTest = on;
+}
+
+void NullRenderState::EnableLineSmooth(bool on)
+{
+}
+
+void NullRenderState::EnableDrawBuffers(int count, bool apply)
+{
+}
+
+//==========================================================================
+//
+// Buffers
+//
+//==========================================================================
+
+int NullRenderState::SetViewpoint(const HWViewpointUniforms& vp)
+{
+	mStats->ViewpointUploads++;
+	mStats->UniformBytes += sizeof(HWViewpointUniforms);
+	return mViewpointCount++;
+}
+
+void NullRenderState::SetViewpoint(int index)
+{
+}
+
+void NullRenderState::SetModelMatrix(const VSMatrix& matrix, const VSMatrix& normalMatrix)
+{
+	mStats->UniformBytes += 2 * sizeof(VSMatrix);
+}
+
+void NullRenderState::SetTextureMatrix(const VSMatrix& matrix)
+{
+	mStats->UniformBytes += sizeof(VSMatrix);
+}
+
+int NullRenderState::UploadLights(const FDynLightData& data)
+{
+	std::lock_guard<std::mutex> lock(mWorkerMutex);
+	unsigned totalsize = data.arrays[LIGHTARRAY_NORMAL].Size() + data.arrays[LIGHTARRAY_SUBTRACTIVE].Size() + data.arrays[LIGHTARRAY_ADDITIVE].Size();
+	mStats->LightUploads++;
+	mStats->UniformBytes += 4 * sizeof(int) + totalsize * sizeof(FDynLightInfo);
+	return mLightCount++;
+}
+
+int NullRenderState::UploadBones(const TArray<VSMatrix>& bones)
+{
+	if (bones.Size() == 0)
+	{
+		return -1;
+	}
+	mStats->BoneUploads++;
+	mStats->UniformBytes += bones.Size() * sizeof(VSMatrix);
+	int index = mBoneCount;
+	mBoneCount += bones.Size();
+	return index;
+}
+
+int NullRenderState::UploadFogballs(const TArray<Fogball>& balls)
+{
+	if (balls.Size() == 0)
+	{
+		return -1;
+	}
+	mStats->FogballUploads++;
+	mStats->UniformBytes += (balls.Size() + 1) * sizeof(Fogball);
+	int index = mFogballCount;
+	mFogballCount += balls.Size() + 1;
+	return index;
+}
+
+//==========================================================================
+//
+// Vertices
+//
+//==========================================================================
+
+std::pair<FFlatVertex*, unsigned int> NullRenderState::AllocVertices(unsigned int count)
+{
+	std::lock_guard<std::mutex> lock(mWorkerMutex);
+	unsigned int index = mCurIndex;
+	if (index + count >= BUFFER_SIZE_TO_USE)
+	{
+		I_FatalError("Out of vertex memory. Tried to allocate more than %u vertices for a single frame", index + count);
+	}
+	mCurIndex += count;
+	mStats->StreamVertices += count;
+	return std::make_pair(&mVertices[index], index);
+}
+
+void NullRenderState::SetShadowData(const TArray<FFlatVertex>& vertices, const TArray<uint32_t>& indexes)
+{
+	UpdateShadowData(0, vertices.Data(), vertices.Size());
+	mShadowDataSize = vertices.Size();
+	mCurIndex = mShadowDataSize;
+
+	if (indexes.Size() > 0)
+	{
+		mStats->BufferUploads++;
+		mStats->BufferBytes += indexes.Size() * sizeof(uint32_t);
+	}
+}
+
+void NullRenderState::UpdateShadowData(unsigned int index, const FFlatVertex* vertices, unsigned int count)
+{
+	memcpy(&mVertices[index], vertices, count * sizeof(FFlatVertex));
+	mStats->BufferUploads++;
+	mStats->BufferBytes += count * sizeof(FFlatVertex);
+}
+
+void NullRenderState::ResetVertices()
+{
+	mCurIndex = mShadowDataSize;
+}
+
+void NullRenderState::BeginFrame()
+{
+	mMaterial.Reset();
+	memset(&mPipelineKey, 0, sizeof(mPipelineKey));
+	mViewpointCount = 0;
+	mLightCount = 0;
+	mBoneCount = 0;
+	mFogballCount = 0;
+}
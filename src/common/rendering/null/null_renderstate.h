@@ -0,0 +1,127 @@
+#pragma once
+
+#include <mutex>
+#include "hw_renderstate.h"
+#include "hw_material.h"
+#include "flatvertices.h"
+
+class NullRenderDevice;
+
+// Everything the null render device counts. All values are per frame.
+struct FNullRenderStats
+{
+	uint64_t DrawCalls;
+	uint64_t IndexedDrawCalls;
+	uint64_t Vertices;
+	uint64_t Indices;
+	uint64_t PipelineChanges;
+	uint64_t MaterialChanges;
+	uint64_t StreamVertices;
+	uint64_t ViewpointUploads;
+	uint64_t LightUploads;
+	uint64_t BoneUploads;
+	uint64_t FogballUploads;
+	uint64_t UniformBytes;
+	uint64_t BufferUploads;
+	uint64_t BufferBytes;
+	uint64_t TextureUploads;
+	uint64_t TextureBytes;
+	uint64_t Clears;
+
+	void Reset() { memset(this, 0, sizeof(*this)); }
+};
+
+// The state a real backend would need a separate pipeline object for.
+struct FNullPipelineKey
+{
+	uint32_t RenderStyle;
+	int DrawType;
+	int ShaderIndex;
+	int TextureMode;
+	IBuffer* VertexBuffer;
+	uint8_t DepthTest;
+	uint8_t DepthWrite;
+	uint8_t DepthFunc;
+	uint8_t DepthClamp;
+	uint8_t StencilTest;
+	uint8_t StencilOp;
+	uint8_t ColorMask;
+	uint8_t CullMode;
+};
+
+class NullRenderState : public FRenderState
+{
+public:
+	NullRenderState(NullRenderDevice* fb);
+	virtual ~NullRenderState() = default;
+
+	// Draw commands
+	void ClearScreen() override;
+	void DoDraw(int dt, int index, int count, bool apply) override;
+	void DoDrawIndexed(int dt, int index, int count, bool apply) override;
+
+	// Immediate render state change commands.
+	bool SetDepthClamp(bool on) override;
+	void SetDepthMask(bool on) override;
+	void SetDepthFunc(int func) override;
+	void SetDepthRange(float min, float max) override;
+	void SetColorMask(bool r, bool g, bool b, bool a) override;
+	void SetStencil(int offs, int op, int flags = -1) override;
+	void SetCulling(int mode) override;
+	void Clear(int targets) override;
+	void EnableStencil(bool on) override;
+	void SetScissor(int x, int y, int w, int h) override;
+	void SetViewport(int x, int y, int w, int h) override;
+	void EnableDepthTest(bool on) override;
+	void EnableLineSmooth(bool on) override;
+	void EnableDrawBuffers(int count, bool apply) override;
+
+	// Buffers
+	int SetViewpoint(const HWViewpointUniforms& vp) override;
+	void SetViewpoint(int index) override;
+	void SetModelMatrix(const VSMatrix& matrix, const VSMatrix& normalMatrix) override;
+	void SetTextureMatrix(const VSMatrix& matrix) override;
+	int UploadLights(const FDynLightData& lightdata) override;
+	int UploadBones(const TArray<VSMatrix>& bones) override;
+	int UploadFogballs(const TArray<Fogball>& balls) override;
+
+	// Vertices
+	std::pair<FFlatVertex*, unsigned int> AllocVertices(unsigned int count) override;
+	void SetShadowData(const TArray<FFlatVertex>& vertices, const TArray<uint32_t>& indexes) override;
+	void UpdateShadowData(unsigned int index, const FFlatVertex* vertices, unsigned int count) override;
+	void ResetVertices() override;
+
+	void BeginFrame();
+
+protected:
+	void Apply(int dt);
+	void ApplyMaterial();
+
+	NullRenderDevice* fb = nullptr;
+	FNullRenderStats* mStats = nullptr;
+
+	std::mutex mWorkerMutex;	// AllocVertices and UploadLights can be called by several BSP workers at once.
+	FNullPipelineKey mPipelineKey = {};
+	bool mDepthClamp = true;
+	bool mDepthTest = false;
+	bool mDepthWrite = false;
+	bool mStencilTest = false;
+	int mDepthFunc = 0;
+	int mStencilOp = 0;
+	int mColorMask = 15;
+	int mCullMode = 0;
+
+	// Same size as the Vulkan backend's flat buffer so that overflows show up here as well.
+	enum
+	{
+		BUFFER_SIZE = 2000000,
+		BUFFER_SIZE_TO_USE = BUFFER_SIZE - 500
+	};
+	TArray<FFlatVertex> mVertices;
+	unsigned int mCurIndex = 0;
+	unsigned int mShadowDataSize = 0;
+	int mViewpointCount = 0;
+	int mLightCount = 0;
+	int mBoneCount = 0;
+	int mFogballCount = 0;
+};
@@ -58,6 +58,7 @@
 #include "r_videoscale.h"
 #include "i_time.h"
 #include "version.h"
+#include "null/null_renderdevice.h"
 #include "texturemanager.h"
 #include "i_interface.h"
 #include "v_draw.h"
@@ -362,7 +363,11 @@ void V_Init2()
 	ticker->SetGenericRepDefault(val, CVAR_Bool);
 
 
-	I_InitGraphics();
+	// The null device needs neither a window nor a display, so the platform's video setup is skipped entirely.
+	if (Args->CheckParm("-nullrenderer"))
+		Video = new NullVideo(vid_defwidth, vid_defheight);
+	else
+		I_InitGraphics();
 
 	Video->SetResolution();	// this only fails via exceptions.
 	if (!RunningAsTool)
@@ -35,6 +35,9 @@
 #include "vulkan/textures/vk_texture.h"
 #include "vulkan/descriptorsets/vk_descriptorset.h"
 #include "vulkan/shaders/vk_shader.h"
+#include "hw_texstreamer.h"
+#include "hw_texcompress.h"
+#include "hw_clock.h"
 #include "vk_hwtexture.h"
 
 VkHardwareTexture::VkHardwareTexture(VulkanRenderDevice* fb, int numchannels) : fb(fb)
@@ -51,6 +54,12 @@ VkHardwareTexture::~VkHardwareTexture()
 
 void VkHardwareTexture::Reset()
 {
+	if (mStreamJob)
+	{
+		mStreamJob->Cancel();
+		mStreamJob.reset();
+	}
+
 	if (fb)
 	{
 		if (mappedSWFB)
@@ -64,15 +73,51 @@ void VkHardwareTexture::Reset()
 	}
 }
 
-VkTextureImage *VkHardwareTexture::GetImage(FTexture *tex, int translation, int flags)
+VkTextureImage *VkHardwareTexture::GetImage(FTexture *tex, int translation, int flags, bool compress)
 {
 	if (!mImage.Image)
 	{
-		CreateImage(tex, translation, flags);
+		compress = compress && !(flags & CTF_Indexed) && CanCompress();
+		if (!mStreamJob && FTextureStreamer::CanStream(tex, translation, flags))
+		{
+			mStreamJob = FTextureStreamer::Queue(tex, translation, flags, compress);
+		}
+
+		if (!mStreamJob)
+		{
+			CreateImage(tex, translation, flags, compress);
+		}
+		else if (!UploadStreamedImage())
+		{
+			return fb->GetTextureManager()->GetPlaceholder();
+		}
 	}
 	return &mImage;
 }
 
+bool VkHardwareTexture::UploadStreamedImage()
+{
+	if (mStreamJob->IsPending() || !fb->GetTextureManager()->TakeStreamUpload())
+		return false;
+
+	auto job = std::move(mStreamJob);
+	FTextureBuffer texbuffer;
+	FCompressedTexture compressed;
+	if (job->TakeResult(texbuffer, compressed))
+	{
+		if (compressed.Format != TEXCOMPRESS_None)
+			CreateCompressedTexture(compressed);
+		else
+			CreateTexture(texbuffer.mWidth, texbuffer.mHeight, 4, VK_FORMAT_B8G8R8A8_UNORM, texbuffer.mBuffer, true);
+	}
+	else
+	{
+		// The worker could not create the buffer, so do it here so that any error gets reported the normal way.
+		CreateImage(job->GetTexture(), job->GetTranslation(), job->GetFlags(), job->GetCompress());
+	}
+	return true;
+}
+
 VkTextureImage *VkHardwareTexture::GetDepthStencil(FTexture *tex)
 {
 	if (!mDepthStencil.View)
@@ -103,13 +148,17 @@ VkTextureImage *VkHardwareTexture::GetDepthStencil(FTexture *tex)
 	return &mDepthStencil;
 }
 
-void VkHardwareTexture::CreateImage(FTexture *tex, int translation, int flags)
+void VkHardwareTexture::CreateImage(FTexture *tex, int translation, int flags, bool compress)
 {
 	if (!tex->isHardwareCanvas())
 	{
 		FTextureBuffer texbuffer = tex->CreateTexBuffer(translation, flags | CTF_ProcessData);
 		bool indexed = flags & CTF_Indexed;
-		CreateTexture(texbuffer.mWidth, texbuffer.mHeight,indexed? 1 : 4, indexed? VK_FORMAT_R8_UNORM : VK_FORMAT_B8G8R8A8_UNORM, texbuffer.mBuffer, !indexed);
+		FCompressedTexture compressed;
+		if (compress && CompressTexture(compressed, texbuffer.mBuffer, texbuffer.mWidth, texbuffer.mHeight, true))
+			CreateCompressedTexture(compressed);
+		else
+			CreateTexture(texbuffer.mWidth, texbuffer.mHeight,indexed? 1 : 4, indexed? VK_FORMAT_R8_UNORM : VK_FORMAT_B8G8R8A8_UNORM, texbuffer.mBuffer, !indexed);
 	}
 	else
 	{
@@ -141,6 +190,8 @@ void VkHardwareTexture::CreateTexture(int w, int h, int pixelsize, VkFormat form
 		throw CVulkanError("Trying to create zero size texture");
 
 	int totalSize = w * h * pixelsize;
+	TextureUploadMetric.Add();
+	TextureUploadBytesMetric.Add(totalSize);
 
 	auto stagingBuffer = BufferBuilder()
 		.Size(totalSize)
@@ -186,6 +237,82 @@ void VkHardwareTexture::CreateTexture(int w, int h, int pixelsize, VkFormat form
 		fb->GetCommands()->WaitForCommands(false, true);
 }
 
+//==========================================================================
+//
+// Block compression of material textures, if enabled and supported.
+// The mip chain comes from the CPU since compressed formats cannot be
+// blitted to.
+//
+//==========================================================================
+
+bool VkHardwareTexture::CanCompress() const
+{
+	return IsTextureCompressionEnabled() && fb->GetDevice()->EnabledFeatures.Features.textureCompressionBC;
+}
+
+void VkHardwareTexture::CreateCompressedTexture(const FCompressedTexture &texture)
+{
+	int w = texture.Mips[0].Width;
+	int h = texture.Mips[0].Height;
+	VkFormat format = texture.Format == TEXCOMPRESS_BC1 ? VK_FORMAT_BC1_RGBA_UNORM_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+	int totalSize = texture.Data.Size();
+	int levels = texture.Mips.Size();
+	TextureUploadMetric.Add();
+	TextureUploadBytesMetric.Add(totalSize);
+
+	auto stagingBuffer = BufferBuilder()
+		.Size(totalSize)
+		.Usage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY)
+		.DebugName("VkHardwareTexture.mStagingBuffer")
+		.Create(fb->GetDevice());
+
+	uint8_t *data = (uint8_t*)stagingBuffer->Map(0, totalSize);
+	memcpy(data, texture.Data.Data(), totalSize);
+	stagingBuffer->Unmap();
+
+	mImage.Image = ImageBuilder()
+		.Format(format)
+		.Size(w, h, levels)
+		.Usage(VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)
+		.DebugName("VkHardwareTexture.mImage")
+		.Create(fb->GetDevice());
+
+	mImage.View = ImageViewBuilder()
+		.Image(mImage.Image.get(), format)
+		.DebugName("VkHardwareTexture.mImageView")
+		.Create(fb->GetDevice());
+
+	auto cmdbuffer = fb->GetCommands()->GetTransferCommands();
+
+	VkImageTransition()
+		.AddImage(&mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true, 0, levels)
+		.Execute(cmdbuffer);
+
+	TArray<VkBufferImageCopy> regions(levels, true);
+	for (int i = 0; i < levels; i++)
+	{
+		VkBufferImageCopy& region = regions[i];
+		region = {};
+		region.bufferOffset = texture.Mips[i].Offset;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = i;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent.depth = 1;
+		region.imageExtent.width = texture.Mips[i].Width;
+		region.imageExtent.height = texture.Mips[i].Height;
+	}
+	cmdbuffer->copyBufferToImage(stagingBuffer->buffer, mImage.Image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levels, regions.Data());
+
+	VkImageTransition()
+		.AddImage(&mImage, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false, 0, levels)
+		.Execute(cmdbuffer);
+
+	// If we queued more than 64 MB of data already: wait until the uploads finish before continuing
+	fb->GetCommands()->TransferDeleteList->Add(std::move(stagingBuffer));
+	if (fb->GetCommands()->TransferDeleteList->TotalSize > 64 * 1024 * 1024)
+		fb->GetCommands()->WaitForCommands(false, true);
+}
+
 int VkHardwareTexture::GetMipLevels(int w, int h)
 {
 	int levels = 1;
@@ -333,28 +460,61 @@ VkMaterial::DescriptorEntry& VkMaterial::GetDescriptorEntry(const FMaterialState
 
 	clampmode = base->GetClampMode(clampmode);
 
+	TArray<LayerBinding> bindings;
 	for (auto& set : mDescriptorSets)
 	{
-		if (set.clampmode == clampmode && set.remap == translationp && set.globalShaderAddr == globalShaderAddr) return set;
+		if (set.clampmode == clampmode && set.remap == translationp && set.globalShaderAddr == globalShaderAddr)
+		{
+			// Once all streamed layers are uploaded the placeholders get replaced by a new set of bindless slots.
+			// The old ones cannot be overwritten because they may still be in use by the GPU.
+			if (set.placeholder && !CollectLayers(state, clampmode, bindings))
+			{
+				set.bindlessIndex = AddBindlessLayers(bindings);
+				set.placeholder = false;
+			}
+			return set;
+		}
 	}
 
+	bool placeholder = CollectLayers(state, clampmode, bindings);
+	int bindlessIndex = AddBindlessLayers(bindings);
+	mDescriptorSets.emplace_back(clampmode, translationp, bindlessIndex, globalShaderAddr, placeholder);
+	return mDescriptorSets.back();
+}
+
+//==========================================================================
+//
+// Gathers the images for all layers of the material.
+// Returns true if any of them is a placeholder for a streamed texture.
+//
+//==========================================================================
+
+bool VkMaterial::CollectLayers(const FMaterialState& state, int clampmode, TArray<LayerBinding>& bindings)
+{
+	int translation = state.mTranslation;
+	GlobalShaderAddr globalShaderAddr = state.globalShaderAddr;
 	auto globalshader = GetGlobalShader(globalShaderAddr);
 	int numLayersMat = *globalshader ? NumNonMaterialLayers() : NumLayers();
-	auto descriptors = fb->GetDescriptorSetManager();
-	auto* sampler = fb->GetSamplerManager()->Get(clampmode);
+	auto placeholderimage = fb->GetTextureManager()->GetPlaceholder();
+	bool placeholder = false;
+
+	bindings.Clear();
 
 	MaterialLayerInfo *layer;
 	auto systex = static_cast<VkHardwareTexture*>(GetLayer(0, state.mTranslation, &layer));
-	auto systeximage = systex->GetImage(layer->layerTexture, state.mTranslation, layer->scaleFlags);
-	int bindlessIndex = descriptors->AddBindlessTextureIndex(systeximage->View.get(), fb->GetSamplerManager()->Get(GetLayerFilter(0), clampmode));
+	bool compress = IsCompressibleTexture(Source());
+	auto systeximage = systex->GetImage(layer->layerTexture, state.mTranslation, layer->scaleFlags, compress);
+	placeholder |= systeximage == placeholderimage;
+	bindings.Push({ systeximage->View.get(), fb->GetSamplerManager()->Get(GetLayerFilter(0), clampmode) });
 
 	if (!(layer->scaleFlags & CTF_Indexed))
 	{
 		for (int i = 1; i < numLayersMat; i++)
 		{
 			auto syslayer = static_cast<VkHardwareTexture*>(GetLayer(i, 0, &layer));
-			auto syslayerimage = syslayer->GetImage(layer->layerTexture, 0, layer->scaleFlags);
-			descriptors->AddBindlessTextureIndex(syslayerimage->View.get(), fb->GetSamplerManager()->Get(GetLayerFilter(i), clampmode));
+			auto syslayerimage = syslayer->GetImage(layer->layerTexture, 0, layer->scaleFlags, compress);
+			placeholder |= syslayerimage == placeholderimage;
+			bindings.Push({ syslayerimage->View.get(), fb->GetSamplerManager()->Get(GetLayerFilter(i), clampmode) });
 		}
 
 		if(*globalshader)
@@ -366,7 +526,8 @@ VkMaterial::DescriptorEntry& VkMaterial::GetDescriptorEntry(const FMaterialState
 				{
 					VkHardwareTexture *tex = static_cast<VkHardwareTexture*>(texture.get()->GetHardwareTexture(0, 0));
 					VkTextureImage *img = tex->GetImage(texture.get(), 0, 0);
-					descriptors->AddBindlessTextureIndex(img->View.get(), fb->GetSamplerManager()->Get(globalshader->CustomShaderTextureSampling[i], clampmode));
+					placeholder |= img == placeholderimage;
+					bindings.Push({ img->View.get(), fb->GetSamplerManager()->Get(globalshader->CustomShaderTextureSampling[i], clampmode) });
 				}
 				i++;
 			}
@@ -378,10 +539,20 @@ VkMaterial::DescriptorEntry& VkMaterial::GetDescriptorEntry(const FMaterialState
 		{
 			auto syslayer = static_cast<VkHardwareTexture*>(GetLayer(i, translation, &layer));
 			auto syslayerimage = syslayer->GetImage(layer->layerTexture, 0, layer->scaleFlags);
-			descriptors->AddBindlessTextureIndex(syslayerimage->View.get(), fb->GetSamplerManager()->Get(GetLayerFilter(i), clampmode));
+			placeholder |= syslayerimage == placeholderimage;
+			bindings.Push({ syslayerimage->View.get(), fb->GetSamplerManager()->Get(GetLayerFilter(i), clampmode) });
 		}
 	}
+	return placeholder;
+}
 
-	mDescriptorSets.emplace_back(clampmode, translationp, bindlessIndex, globalShaderAddr);
-	return mDescriptorSets.back();
+int VkMaterial::AddBindlessLayers(const TArray<LayerBinding>& bindings)
+{
+	auto descriptors = fb->GetDescriptorSetManager();
+	int bindlessIndex = descriptors->AddBindlessTextureIndex(bindings[0].view, bindings[0].sampler);
+	for (unsigned i = 1; i < bindings.Size(); i++)
+	{
+		descriptors->AddBindlessTextureIndex(bindings[i].view, bindings[i].sampler);
+	}
+	return bindlessIndex;
 }
@@ -13,6 +13,7 @@
 #include "vk_imagetransition.h"
 #include "hw_material.h"
 #include <list>
+#include <memory>
 
 struct FMaterialState;
 class VulkanDescriptorSet;
@@ -21,6 +22,8 @@ class VulkanImageView;
 class VulkanBuffer;
 class VulkanRenderDevice;
 class FGameTexture;
+class FTextureStreamJob;
+struct FCompressedTexture;
 
 class VkHardwareTexture : public IHardwareTexture
 {
@@ -39,16 +42,19 @@ public:
 	// Wipe screen
 	void CreateWipeTexture(int w, int h, const char *name);
 
-	VkTextureImage *GetImage(FTexture *tex, int translation, int flags);
+	VkTextureImage *GetImage(FTexture *tex, int translation, int flags, bool compress = false);
 	VkTextureImage *GetDepthStencil(FTexture *tex);
 
 	VulkanRenderDevice* fb = nullptr;
 	std::list<VkHardwareTexture*>::iterator it;
 
 private:
-	void CreateImage(FTexture *tex, int translation, int flags);
+	void CreateImage(FTexture *tex, int translation, int flags, bool compress);
+	bool UploadStreamedImage();
 
 	void CreateTexture(int w, int h, int pixelsize, VkFormat format, const void *pixels, bool mipmap);
+	bool CanCompress() const;
+	void CreateCompressedTexture(const FCompressedTexture &texture);
 	static int GetMipLevels(int w, int h);
 
 	VkTextureImage mImage;
@@ -57,6 +63,8 @@ private:
 	VkTextureImage mDepthStencil;
 
 	uint8_t* mappedSWFB = nullptr;
+
+	std::shared_ptr<FTextureStreamJob> mStreamJob;
 };
 
 class VkMaterial : public FMaterial
@@ -79,17 +87,27 @@ private:
 		intptr_t remap;
 		int bindlessIndex;
 		GlobalShaderAddr globalShaderAddr;
+		bool placeholder;	// at least one layer is still being created in the background.
 
-		DescriptorEntry(int cm, intptr_t f, int index, GlobalShaderAddr addr)
+		DescriptorEntry(int cm, intptr_t f, int index, GlobalShaderAddr addr, bool ph)
 		{
 			clampmode = cm;
 			remap = f;
 			bindlessIndex = index;
 			globalShaderAddr = addr;
+			placeholder = ph;
 		}
 	};
 
+	struct LayerBinding
+	{
+		VulkanImageView* view;
+		VulkanSampler* sampler;
+	};
+
 	DescriptorEntry& GetDescriptorEntry(const FMaterialState& state);
+	bool CollectLayers(const FMaterialState& state, int clampmode, TArray<LayerBinding>& bindings);
+	int AddBindlessLayers(const TArray<LayerBinding>& bindings);
 
 	std::vector<DescriptorEntry> mDescriptorSets;
 };
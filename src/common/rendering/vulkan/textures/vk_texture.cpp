@@ -26,10 +26,14 @@
 #include "vk_renderbuffers.h"
 #include "vulkan/vk_postprocess.h"
 #include "hw_cvars.h"
+#include "hw_texstreamer.h"
+
+EXTERN_CVAR(Int, gl_texture_stream_maxuploads)
 
 VkTextureManager::VkTextureManager(VulkanRenderDevice* fb) : fb(fb)
 {
 	CreateNullTexture();
+	CreatePlaceholder();
 	CreateShadowmap();
 	CreateLightmap();
 	CreateIrradiancemap();
@@ -50,10 +54,15 @@ void VkTextureManager::Deinit()
 		RemoveTexture(Textures.back());
 	while (!PPTextures.empty())
 		RemovePPTexture(PPTextures.back());
+
+	// All pending jobs were cancelled by removing the textures above.
+	FTextureStreamer::Shutdown();
 }
 
 void VkTextureManager::BeginFrame()
 {
+	StreamUploads = 0;
+
 	if (!Shadowmap.Image || Shadowmap.Image->width != gl_shadowmap_quality)
 	{
 		Shadowmap.Reset(fb);
@@ -166,6 +175,59 @@ void VkTextureManager::CreateNullTexture()
 		.Execute(fb->GetCommands()->GetTransferCommands(), VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 }
 
+void VkTextureManager::CreatePlaceholder()
+{
+	Placeholder.Image = ImageBuilder()
+		.Format(VK_FORMAT_B8G8R8A8_UNORM)
+		.Size(1, 1)
+		.Usage(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+		.DebugName("VkTextureManager.Placeholder")
+		.Create(fb->GetDevice());
+
+	Placeholder.View = ImageViewBuilder()
+		.Image(Placeholder.Image.get(), VK_FORMAT_B8G8R8A8_UNORM)
+		.DebugName("VkTextureManager.PlaceholderView")
+		.Create(fb->GetDevice());
+
+	auto cmdbuffer = fb->GetCommands()->GetTransferCommands();
+
+	VkImageTransition()
+		.AddImage(&Placeholder, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true)
+		.Execute(cmdbuffer);
+
+	VkImageSubresourceRange range = {};
+	range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	range.layerCount = 1;
+	range.levelCount = 1;
+
+	// Neutral gray with zero alpha: opaque surfaces show up gray while alpha tested sprites stay invisible.
+	VkClearColorValue value = {};
+	value.float32[0] = 0.5f;
+	value.float32[1] = 0.5f;
+	value.float32[2] = 0.5f;
+	value.float32[3] = 0.0f;
+	cmdbuffer->clearColorImage(Placeholder.Image->image, Placeholder.Layout, &value, 1, &range);
+
+	VkImageTransition()
+		.AddImage(&Placeholder, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false)
+		.Execute(cmdbuffer);
+}
+
+//==========================================================================
+//
+// Limits how many streamed textures get uploaded per frame so that a
+// large batch of finished jobs does not cause a hitch of its own.
+//
+//==========================================================================
+
+bool VkTextureManager::TakeStreamUpload()
+{
+	if (gl_texture_stream_maxuploads > 0 && StreamUploads >= gl_texture_stream_maxuploads)
+		return false;
+	StreamUploads++;
+	return true;
+}
+
 void VkTextureManager::CreateShadowmap()
 {
 	Shadowmap.Image = ImageBuilder()
@@ -40,6 +40,10 @@ public:
 	VulkanImage* GetNullTexture() { return NullTexture.get(); }
 	VulkanImageView* GetNullTextureView() { return NullTextureView.get(); }
 
+	// Used in place of textures which are still being created in the background.
+	VkTextureImage* GetPlaceholder() { return &Placeholder; }
+	bool TakeStreamUpload();
+
 	int GetHWTextureCount() { return (int)Textures.size(); }
 
 	VkTextureImage Shadowmap;
@@ -55,6 +59,7 @@ public:
 
 private:
 	void CreateNullTexture();
+	void CreatePlaceholder();
 	void CreateShadowmap();
 	void CreateLightmap();
 	void CreateIrradiancemap();
@@ -69,4 +74,7 @@ private:
 
 	std::unique_ptr<VulkanImage> NullTexture;
 	std::unique_ptr<VulkanImageView> NullTextureView;
+
+	VkTextureImage Placeholder;
+	int StreamUploads = 0;
 };
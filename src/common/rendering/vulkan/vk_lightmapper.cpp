@@ -8,12 +8,17 @@
 #include "zvulkan/vulkanbuilders.h"
 #include "filesystem.h"
 #include "cmdlib.h"
+#include "metrics.h"
 
 static int lastSurfaceCount;
 static glcycle_t lightmapRaytraceLast;
 
 static uint32_t lastPixelCount;
 
+static FHistogramMetric RaytraceTimeMetric("lightmap.raytrace_ms", METRIC_Frame, { 0.5, 1, 2, 4, 8, 16 });
+static FCounterMetric SurfacesBakedMetric("lightmap.surfaces_baked", METRIC_Frame);
+static FCounterMetric PixelsBakedMetric("lightmap.pixels_baked", METRIC_Frame);
+
 ADD_STAT(lightmapper)
 {
 	FString out;
@@ -107,9 +112,13 @@ void VkLightmapper::Raytrace(const TArray<LightmapTile*>& tiles)
 			CopyResult();
 
 			fb->GetCommands()->PopGroup(fb->GetCommands()->GetTransferCommands());
+
+			SurfacesBakedMetric.Add(lastSurfaceCount);
+			PixelsBakedMetric.Add(lastPixelCount);
 		}
 
 		lightmapRaytraceLast.Unclock();
+		RaytraceTimeMetric.Record(lightmapRaytraceLast.TimeMS());
 	}
 }
 
@@ -39,6 +39,7 @@
 #include "hw_skydome.h"
 #include "flatvertices.h"
 #include "hw_meshbuilder.h"
+#include "hw_texcompress.h"
 
 #include "vk_renderdevice.h"
 #include "vulkan/vk_renderstate.h"
@@ -339,14 +340,15 @@ void VulkanRenderDevice::PrecacheMaterial(FMaterial *mat, int translation)
 
 	MaterialLayerInfo* layer;
 
+	bool compress = IsCompressibleTexture(mat->Source());
 	auto systex = static_cast<VkHardwareTexture*>(mat->GetLayer(0, translation, &layer));
-	systex->GetImage(layer->layerTexture, translation, layer->scaleFlags);
+	systex->GetImage(layer->layerTexture, translation, layer->scaleFlags, compress);
 
 	int numLayers = mat->NumLayers();
 	for (int i = 1; i < numLayers; i++)
 	{
 		auto syslayer = static_cast<VkHardwareTexture*>(mat->GetLayer(i, 0, &layer));
-		syslayer->GetImage(layer->layerTexture, 0, layer->scaleFlags);
+		syslayer->GetImage(layer->layerTexture, 0, layer->scaleFlags, compress);
 	}
 }
 
@@ -606,6 +606,8 @@ void VkRenderState::SetTextureMatrix(const VSMatrix& matrix)
 
 int VkRenderState::UploadLights(const FDynLightData& data)
 {
+	std::lock_guard<std::mutex> lock(mWorkerMutex);
+
 	// All meaasurements here are in vec4's.
 	int size0 = data.arrays[LIGHTARRAY_NORMAL].Size();
 	int size1 = data.arrays[LIGHTARRAY_SUBTRACTIVE].Size();
@@ -692,6 +694,8 @@ int VkRenderState::UploadFogballs(const TArray<Fogball>& balls)
 
 std::pair<FFlatVertex*, unsigned int> VkRenderState::AllocVertices(unsigned int count)
 {
+	std::lock_guard<std::mutex> lock(mWorkerMutex);
+
 	unsigned int index = mRSBuffers->Flatbuffer.CurIndex;
 	if (index + count >= mRSBuffers->Flatbuffer.BUFFER_SIZE_TO_USE)
 	{
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <mutex>
 #include "vulkan/buffers/vk_hwbuffer.h"
 #include "vulkan/buffers/vk_rsbuffers.h"
 #include "vulkan/shaders/vk_shader.h"
@@ -97,6 +98,7 @@ protected:
 	VulkanRenderDevice* fb = nullptr;
 
 	VkRSBuffers* mRSBuffers = nullptr;
+	std::mutex mWorkerMutex;	// AllocVertices and UploadLights can be called by several BSP workers at once.
 
 	bool mDepthClamp = true;
 	VulkanCommandBuffer *mCommandBuffer = nullptr;
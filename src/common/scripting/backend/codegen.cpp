@@ -1619,6 +1619,8 @@ FxExpression* FxTranslationCast::Resolve(FCompileContext& ctx)
 		if (basex->isConstant())
 		{
 			ExpVal constval = static_cast<FxConstant*>(basex)->GetValue();
+			// Custom translations are not part of the script cache's key.
+			ctx.NoCache = true;
 			FxExpression* x = new FxConstant(R_FindCustomTranslation(constval.GetName()), ScriptPosition);
 			x->ValueType = TypeTranslationID;
 			delete this;
@@ -3481,7 +3483,7 @@ texcheck:
 	auto * countptr = &ptr->Count;
 	ExpEmit bndp(build, REGT_POINTER);
 	ExpEmit bndc(build, REGT_INT);
-	build->Emit(OP_LKP, bndp.RegNum, build->GetConstantAddress(countptr));
+	build->Emit(OP_LKP, bndp.RegNum, build->GetConstantStaticAddress(countptr));
 	build->Emit(OP_LW, bndc.RegNum, bndp.RegNum, build->GetConstantInt(0));
 	build->Emit(OP_BOUND_R, to.RegNum, bndc.RegNum);
 	bndp.Free(build);
@@ -7340,7 +7342,8 @@ ExpEmit FxGlobalVariable::Emit(VMFunctionBuilder *build)
 {
 	ExpEmit obj(build, REGT_POINTER);
 
-	build->Emit(OP_LKP, obj.RegNum, build->GetConstantAddress((void*)(intptr_t)membervar->Offset));
+	void *addr = (void*)(intptr_t)membervar->Offset;
+	build->Emit(OP_LKP, obj.RegNum, (membervar->Flags & VARF_Native) ? build->GetConstantStaticAddress(addr) : build->GetConstantAddress(addr));
 	if (AddressRequested)
 	{
 		return obj;
@@ -7423,27 +7426,27 @@ ExpEmit FxCVar::Emit(VMFunctionBuilder *build)
 	switch (CVar->GetRealType())
 	{
 	case CVAR_Int:
-		build->Emit(OP_LKP, addr.RegNum, build->GetConstantAddress(&static_cast<FIntCVar *>(CVar)->Value));
+		build->Emit(OP_LKP, addr.RegNum, build->GetConstantCVarAddress(CVar, &static_cast<FIntCVar *>(CVar)->Value));
 		build->Emit(OP_LW, dest.RegNum, addr.RegNum, nul);
 		break;
 
 	case CVAR_Color:
-		build->Emit(OP_LKP, addr.RegNum, build->GetConstantAddress(&static_cast<FColorCVar *>(CVar)->Value));
+		build->Emit(OP_LKP, addr.RegNum, build->GetConstantCVarAddress(CVar, &static_cast<FColorCVar *>(CVar)->Value));
 		build->Emit(OP_LW, dest.RegNum, addr.RegNum, nul);
 		break;
 
 	case CVAR_Float:
-		build->Emit(OP_LKP, addr.RegNum, build->GetConstantAddress(&static_cast<FFloatCVar *>(CVar)->Value));
+		build->Emit(OP_LKP, addr.RegNum, build->GetConstantCVarAddress(CVar, &static_cast<FFloatCVar *>(CVar)->Value));
 		build->Emit(OP_LSP, dest.RegNum, addr.RegNum, nul);
 		break;
 
 	case CVAR_Bool:
-		build->Emit(OP_LKP, addr.RegNum, build->GetConstantAddress(&static_cast<FBoolCVar *>(CVar)->Value));
+		build->Emit(OP_LKP, addr.RegNum, build->GetConstantCVarAddress(CVar, &static_cast<FBoolCVar *>(CVar)->Value));
 		build->Emit(OP_LBU, dest.RegNum, addr.RegNum, nul);
 		break;
 
 	case CVAR_String:
-		build->Emit(OP_LKP, addr.RegNum, build->GetConstantAddress(&static_cast<FStringCVar *>(CVar)->mValue));
+		build->Emit(OP_LKP, addr.RegNum, build->GetConstantCVarAddress(CVar, &static_cast<FStringCVar *>(CVar)->mValue));
 		build->Emit(OP_LS, dest.RegNum, addr.RegNum, nul);
 		break;
 
@@ -7453,7 +7456,7 @@ ExpEmit FxCVar::Emit(VMFunctionBuilder *build)
 		auto cv = static_cast<FFlagCVar *>(CVar);
 		auto vcv = &cv->ValueVar;
 		pVal = &vcv->Value;
-		build->Emit(OP_LKP, addr.RegNum, build->GetConstantAddress(pVal));
+		build->Emit(OP_LKP, addr.RegNum, build->GetConstantCVarAddress(vcv, pVal));
 		build->Emit(OP_LW, dest.RegNum, addr.RegNum, nul);
 		build->Emit(OP_SRL_RI, dest.RegNum, dest.RegNum, cv->BitNum);
 		build->Emit(OP_AND_RK, dest.RegNum, dest.RegNum, build->GetConstantInt(1));
@@ -7463,7 +7466,7 @@ ExpEmit FxCVar::Emit(VMFunctionBuilder *build)
 	case CVAR_Mask:
 	{
 		auto cv = static_cast<FMaskCVar *>(CVar);
-		build->Emit(OP_LKP, addr.RegNum, build->GetConstantAddress(&cv->ValueVar.Value));
+		build->Emit(OP_LKP, addr.RegNum, build->GetConstantCVarAddress(&cv->ValueVar, &cv->ValueVar.Value));
 		build->Emit(OP_LW, dest.RegNum, addr.RegNum, nul);
 		build->Emit(OP_AND_RK, dest.RegNum, dest.RegNum, build->GetConstantInt(cv->BitVal));
 		build->Emit(OP_SRL_RI, dest.RegNum, dest.RegNum, cv->BitNum);
@@ -88,6 +88,7 @@ struct FCompileContext
 	int StateCount;			// amount of states an anoymous function is being used on (must be 1 for state indices to be allowed.)
 	int Lump;
 	bool Unsafe = false;
+	bool NoCache = false;	// the generated code depends on data the script cache cannot validate
 	TDeletingArray<FxLocalVariableDeclaration *> FunctionArgs;
 	PNamespace *CurGlobals;
 	VersionInfo Version;
@@ -33,6 +33,7 @@
 */
 
 #include "vmbuilder.h"
+#include "vmcache.h"
 #include "codegen.h"
 #include "m_argv.h"
 #include "c_cvars.h"
@@ -295,6 +296,49 @@ unsigned VMFunctionBuilder::GetConstantAddress(void *ptr)
 }
 
 
+//==========================================================================
+//
+// VMFunctionBuilder :: GetConstantCVarAddress
+//
+// Same as GetConstantAddress, but remembers which CVar the address
+// belongs to. Script defined CVars are not at a fixed location.
+//
+//==========================================================================
+
+unsigned VMFunctionBuilder::GetConstantCVarAddress(FBaseCVar *cvar, void *ptr)
+{
+	AddressOrigins.Insert(ptr, { FAddressOrigin::CVar, unsigned((char*)ptr - (char*)cvar), 0, cvar });
+	return GetConstantAddress(ptr);
+}
+
+//==========================================================================
+//
+// VMFunctionBuilder :: GetConstantStaticAddress
+//
+// For addresses of native global variables.
+//
+//==========================================================================
+
+unsigned VMFunctionBuilder::GetConstantStaticAddress(void *ptr)
+{
+	AddressOrigins.Insert(ptr, { FAddressOrigin::Static, 0, 0, nullptr });
+	return GetConstantAddress(ptr);
+}
+
+//==========================================================================
+//
+// VMFunctionBuilder :: GetConstantArenaData
+//
+// For data the code generator allocates in ClassDataAllocator.
+//
+//==========================================================================
+
+unsigned VMFunctionBuilder::GetConstantArenaData(void *ptr, unsigned size)
+{
+	AddressOrigins.Insert(ptr, { FAddressOrigin::ArenaData, 0, size, nullptr });
+	return GetConstantAddress(ptr);
+}
+
 //==========================================================================
 //
 // VMFunctionBuilder :: FindConstantInt
@@ -840,14 +884,33 @@ void FFunctionBuildList::Build()
 {
 	VMDisassemblyDumper disasmdump(VMDisassemblyDumper::Overwrite);
 
-	for (auto &item : mItems)
+	TArray<FString> names(mItems.Size(), true);
+	for (unsigned i = 0; i < mItems.Size(); i++) names[i] = mItems[i].PrintableName;
+	ScriptCache.BeginBuild(names);
+
+	for (unsigned itemindex = 0; itemindex < mItems.Size(); itemindex++)
 	{
+		auto &item = mItems[itemindex];
 		// [Player701] Do not emit code for abstract functions
 		bool isAbstract = item.Func->Variants[0].Implementation->VarFlags & VARF_Abstract;
 		if (isAbstract) continue;
 
 		assert(item.Code != NULL);
 
+		if (ScriptCache.Restore(itemindex, item.Function, item.Func))
+		{
+			disasmdump.Write(item.Function, item.PrintableName);
+			#if HAVE_VM_JIT
+				if(vm_jit && vm_jit_aot)
+				{
+					item.Function->JitCompile();
+				}
+			#endif
+			delete item.Code;
+			disasmdump.Flush();
+			continue;
+		}
+
 		// We don't know the return type in advance for anonymous functions.
 		FCompileContext ctx(item.CurGlobals, item.Func, item.Func->SymbolName == NAME_None ? nullptr : item.Func->Variants[0].Proto, item.FromDecorate, item.StateIndex, item.StateCount, item.Lump, item.Version);
 
@@ -903,8 +966,9 @@ void FFunctionBuildList::Build()
 
 			// Generate prototype for anonymous functions.
 			VMScriptFunction *sfunc = item.Function;
+			bool newproto = sfunc->Proto == nullptr;
 			// create a new prototype from the now known return type and the argument list of the function's template prototype.
-			if (sfunc->Proto == nullptr)
+			if (newproto)
 			{
 				sfunc->Proto = NewPrototype(item.Proto->ReturnTypes, item.Func->Variants[0].Proto->ArgumentTypes);
 				sfunc->ArgFlags = item.Func->Variants[0].ArgFlags;
@@ -940,6 +1004,7 @@ void FFunctionBuildList::Build()
 				disasmdump.Write(sfunc, item.PrintableName);
 
 				sfunc->Unsafe = ctx.Unsafe;
+				ScriptCache.Store(itemindex, sfunc, buildit, newproto, ctx.NoCache);
 
 				#if HAVE_VM_JIT
 					if(vm_jit && vm_jit_aot)
@@ -957,6 +1022,7 @@ void FFunctionBuildList::Build()
 		delete item.Code;
 		disasmdump.Flush();
 	}
+	ScriptCache.EndBuild();
 	VMFunction::CreateRegUseInfo();
 	FScriptPosition::StrictErrors = strictdecorate;
 
@@ -1127,7 +1193,7 @@ ExpEmit FunctionCallEmitter::EmitCall(VMFunctionBuilder *build, TArray<ExpEmit>
 		// It would really be nicer to actually pass real types but that'd require a far more complex interface on the compiler side than what we have.
 		uint8_t *regbuffer = (uint8_t*)ClassDataAllocator.Alloc(reginfo.Size());	// Allocate in the arena so that the pointer does not need to be maintained.
 		memcpy(regbuffer, reginfo.Data(), reginfo.Size());
-		build->Emit(OP_PARAM, REGT_POINTER | REGT_KONST, build->GetConstantAddress(regbuffer));
+		build->Emit(OP_PARAM, REGT_POINTER | REGT_KONST, build->GetConstantArenaData(regbuffer, reginfo.Size()));
 		paramcount++;
 	}
 
@@ -9,6 +9,7 @@
 class VMFunctionBuilder;
 class FxExpression;
 class FxLocalVariableDeclaration;
+class FBaseCVar;
 
 struct ExpEmit
 {
@@ -24,6 +25,22 @@ struct ExpEmit
 	bool Konst, Fixed, Final, Target;
 };
 
+// Where an address constant points to, for addresses whose target cannot be
+// identified from the value alone. Only needed by the script cache.
+struct FAddressOrigin
+{
+	enum
+	{
+		CVar,		// Offset is relative to the CVar object
+		Static,		// an object with static storage duration
+		ArenaData,	// Size bytes allocated in ClassDataAllocator while building the function
+	};
+	int Kind;
+	unsigned Offset;
+	unsigned Size;
+	FBaseCVar *Owner;
+};
+
 class VMFunctionBuilder
 {
 public:
@@ -64,6 +81,10 @@ public:
 	unsigned GetConstantFloat(double val);
 	unsigned GetConstantAddress(void *ptr);
 	unsigned GetConstantString(FString str);
+	unsigned GetConstantCVarAddress(FBaseCVar *cvar, void *ptr);
+	unsigned GetConstantStaticAddress(void *ptr);
+	unsigned GetConstantArenaData(void *ptr, unsigned size);
+	const FAddressOrigin *GetAddressOrigin(void *ptr) { return AddressOrigins.CheckKey(ptr); }
 
 	int FindConstantInt(unsigned index);
 	//double FindConstantFloat(unsigned index);
@@ -123,6 +144,7 @@ private:
 	TMap<double, unsigned> FloatConstantMap;
 	TMap<void *, unsigned> AddressConstantMap;
 	TMap<FString, unsigned> StringConstantMap;
+	TMap<void *, FAddressOrigin> AddressOrigins;
 
 	int MaxParam;
 	int ActiveParam;
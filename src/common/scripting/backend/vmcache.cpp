@@ -0,0 +1,751 @@
+/*
+** vmcache.cpp
+** Caches the code generator output for script functions
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+#include "vmcache.h"
+#include "vmbuilder.h"
+#include "types.h"
+#include "symbols.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "files.h"
+#include "filesystem.h"
+#include "fs_findfile.h"
+#include "i_specialpaths.h"
+#include "md5.h"
+#include "printf.h"
+#include "s_soundinternal.h"
+#include "texturemanager.h"
+#include "version.h"
+
+CVAR(Bool, vm_scriptcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+EXTERN_CVAR(Bool, strictdecorate)
+
+FScriptCache ScriptCache;
+
+static const uint8_t ScriptCacheMagic[4] = { 'Z', 'S', 'C', '1' };
+
+static uint64_t exeSize;
+static int64_t exeTime;
+
+// How an address constant gets stored.
+enum
+{
+	RELOC_Raw,			// null or a small integer that is used as a pointer
+	RELOC_Function,		// index in VMFunction::AllFunctions
+	RELOC_Type,			// index in TypeTable.AllTypes
+	RELOC_Class,		// index in PClass::AllClasses
+	RELOC_Arena,		// block and offset in ClassDataAllocator
+	RELOC_Static,		// offset to ScriptCache, which also has static storage duration
+	RELOC_CVar,			// CVar name and offset in the CVar object
+	RELOC_ArenaData,	// contents of the data
+};
+
+enum
+{
+	CACHEF_Unsafe = 1,
+	CACHEF_NewProto = 2,
+};
+
+//==========================================================================
+//
+// Serialization helpers. The cache is only valid for the exact same binary
+// so all data is stored in native byte order.
+//
+//==========================================================================
+
+static void PutData(TArray<uint8_t> &out, const void *data, size_t size)
+{
+	if (size == 0) return;
+	unsigned start = out.Reserve((unsigned)size);
+	memcpy(&out[start], data, size);
+}
+
+template<class T> static void Put(TArray<uint8_t> &out, T value)
+{
+	PutData(out, &value, sizeof(T));
+}
+
+static void PutString(TArray<uint8_t> &out, const char *str)
+{
+	uint32_t len = (uint32_t)strlen(str);
+	Put(out, len);
+	PutData(out, str, len);
+}
+
+struct FCacheReader
+{
+	const uint8_t *Pos;
+	const uint8_t *End;
+	bool Failed = false;
+
+	void Get(void *dest, size_t size)
+	{
+		if (size > size_t(End - Pos))
+		{
+			memset(dest, 0, size);
+			Pos = End;
+			Failed = true;
+			return;
+		}
+		memcpy(dest, Pos, size);
+		Pos += size;
+	}
+
+	template<class T> T Get()
+	{
+		T value;
+		Get(&value, sizeof(T));
+		return value;
+	}
+
+	FString GetString()
+	{
+		uint32_t len = Get<uint32_t>();
+		if (len > size_t(End - Pos))
+		{
+			Pos = End;
+			Failed = true;
+			return "";
+		}
+		FString str((const char *)Pos, len);
+		Pos += len;
+		return str;
+	}
+};
+
+//==========================================================================
+//
+// FScriptCache :: AddSource
+//
+// Called by the script parsers for every lump they read.
+//
+//==========================================================================
+
+void FScriptCache::AddSource(int lump)
+{
+	Sources.Push(lump);
+}
+
+//==========================================================================
+//
+// Static addresses are stored relative to the ScriptCache object, so the
+// cache may only be used by the exact binary that wrote it. The git hash
+// does not change for local builds, so the size and time stamp of the
+// executable are part of the key, too.
+//
+//==========================================================================
+
+static bool GetExecutableInfo(uint64_t *size, int64_t *time)
+{
+	FString path;
+#ifdef _WIN32
+	wchar_t buffer[1024];
+	DWORD len = GetModuleFileNameW(nullptr, buffer, 1024);
+	if (len == 0 || len >= 1024) return false;
+	path = FString(buffer);
+#elif defined __APPLE__
+	char buffer[1024];
+	uint32_t len = sizeof(buffer);
+	if (_NSGetExecutablePath(buffer, &len) != 0) return false;
+	path = buffer;
+#else
+	path = "/proc/self/exe";
+#endif
+	return FileSys::FS_GetFileInfo(path.GetChars(), size, time);
+}
+
+//==========================================================================
+//
+// FScriptCache :: ComputeKey
+//
+// The key covers everything the generated code depends on: the engine
+// binary, the script sources and all tables that constants refer to by
+// index. The file name only depends on the loaded resource files so that
+// editing a mod replaces its cache file instead of adding a new one.
+//
+//==========================================================================
+
+void FScriptCache::ComputeKey(const TArray<FString> &functions, uint8_t *key, FString &filename)
+{
+	MD5Context md5;
+	auto addint = [&](int64_t value) { md5.Update((const uint8_t *)&value, sizeof(value)); };
+	auto addstring = [&](const char *str) { md5.Update((const uint8_t *)str, (unsigned)strlen(str) + 1); };
+	auto addlump = [&](int lump)
+	{
+		auto data = fileSystem.ReadFile(lump);
+		addstring(fileSystem.GetFileFullName(lump, false));
+		addint(data.size());
+		md5.Update((const uint8_t *)data.data(), (unsigned)data.size());
+	};
+
+	md5.Update(ScriptCacheMagic, 4);
+	addstring(GetVersionString());
+	addstring(GetGitHash());
+	addint(exeSize);
+	addint(exeTime);
+	addint(sizeof(void *));
+	// Native globals are stored relative to this object, so a different layout of the binary must invalidate the cache.
+	addint((char *)&TexMan - (char *)this);
+	addint((char *)&VMFunction::AllFunctions - (char *)this);
+	addint(strictdecorate);
+
+	for (auto lump : Sources) addlump(lump);
+	int lastlump = 0, lump;
+	while ((lump = fileSystem.FindLump("CVARINFO", &lastlump)) != -1) addlump(lump);
+
+	addint(NameCount);
+	for (int i = 0; i < NameCount; i++)
+	{
+		addstring(FName(ENamedName(i)).GetChars());
+	}
+	if (soundEngine != nullptr)
+	{
+		int numsounds = soundEngine->GetNumSounds();
+		addint(numsounds);
+		for (int i = 1; i < numsounds; i++)
+		{
+			addstring(soundEngine->GetSoundName(FSoundID::fromInt(i)));
+		}
+	}
+	addint(FunctionCount);
+	addint(TypeCount);
+	addint(ClassCount);
+	for (auto size : ArenaUsage) addint(size);
+	addint(functions.Size());
+	for (auto &name : functions) addstring(name.GetChars());
+	md5.Final(key);
+
+	MD5Context namemd5;
+	for (int i = 0; i < fileSystem.GetNumWads(); i++)
+	{
+		const char *name = fileSystem.GetResourceFileFullName(i);
+		namemd5.Update((const uint8_t *)name, (unsigned)strlen(name) + 1);
+	}
+	uint8_t namekey[16];
+	namemd5.Final(namekey);
+
+	filename = M_GetCachePath(true) + "/scriptcache";
+	CreatePath(filename.GetChars());
+	filename += '/';
+	for (int i = 0; i < 8; i++) filename.AppendFormat("%02x", namekey[i]);
+	filename += ".zsc";
+}
+
+//==========================================================================
+//
+// FScriptCache :: BeginBuild
+//
+//==========================================================================
+
+void FScriptCache::BeginBuild(const TArray<FString> &functions)
+{
+	Active = vm_scriptcache && FScriptPosition::ErrorCounter == 0 && Sources.Size() > 0 && GetExecutableInfo(&exeSize, &exeTime);
+	Loaded = false;
+	Restored = 0;
+	if (!Active) return;
+
+	NameCount = FName::GetNumNames();
+	WarnCount = FScriptPosition::WarnCounter;
+	FunctionCount = VMFunction::AllFunctions.Size();
+	TypeCount = TypeTable.AllTypes.Size();
+	ClassCount = PClass::AllClasses.Size();
+	ClassDataAllocator.GetBlockUsage(ArenaUsage);
+
+	try
+	{
+		ComputeKey(functions, Key, Filename);
+		Loaded = Load(Key);
+	}
+	catch (...)
+	{
+		Active = false;
+	}
+	if (!Loaded)
+	{
+		Data.Clear();
+		RecordStart.Clear();
+		RecordSize.Clear();
+	}
+}
+
+//==========================================================================
+//
+// FScriptCache :: Load
+//
+//==========================================================================
+
+bool FScriptCache::Load(const uint8_t *key)
+{
+	FileReader fr;
+	if (!fr.OpenFile(Filename.GetChars())) return false;
+
+	Data.Resize((unsigned)fr.GetLength());
+	if (fr.Read(Data.Data(), Data.Size()) != (FileReader::Size)Data.Size()) return false;
+
+	FCacheReader rd = { Data.Data(), Data.Data() + Data.Size() };
+	uint8_t magic[4], filekey[16];
+	rd.Get(magic, 4);
+	rd.Get(filekey, 16);
+	if (rd.Failed || memcmp(magic, ScriptCacheMagic, 4) || memcmp(filekey, key, 16)) return false;
+
+	// Names the code generator created must end up with the same indices as before.
+	uint32_t numnames = rd.Get<uint32_t>();
+	for (uint32_t i = 0; i < numnames && !rd.Failed; i++)
+	{
+		FName name = rd.GetString();
+		if (name.GetIndex() != NameCount + (int)i) return false;
+	}
+
+	uint32_t numrecords = rd.Get<uint32_t>();
+	for (uint32_t i = 0; i < numrecords && !rd.Failed; i++)
+	{
+		uint32_t size = rd.Get<uint32_t>();
+		if (size > size_t(rd.End - rd.Pos)) return false;
+		RecordStart.Push(unsigned(rd.Pos - Data.Data()));
+		RecordSize.Push(size);
+		rd.Pos += size;
+	}
+	return !rd.Failed;
+}
+
+//==========================================================================
+//
+// FScriptCache :: Restore
+//
+// Fills in a function from the cache. Returns false if it has to be
+// compiled normally.
+//
+//==========================================================================
+
+bool FScriptCache::Restore(unsigned index, VMScriptFunction *func, PFunction *pfunc)
+{
+	if (!Loaded || index >= RecordSize.Size() || RecordSize[index] == 0) return false;
+
+	FCacheReader rd = { &Data[RecordStart[index]], &Data[RecordStart[index]] + RecordSize[index] };
+	auto gettype = [&]() -> PType *
+	{
+		uint32_t type = rd.Get<uint32_t>();
+		if (type >= TypeCount) rd.Failed = true;
+		return rd.Failed ? nullptr : TypeTable.AllTypes[type];
+	};
+
+	uint8_t flags = rd.Get<uint8_t>();
+	uint8_t numargs = rd.Get<uint8_t>();
+	uint8_t numregs[4];
+	rd.Get(numregs, 4);
+	uint16_t maxparam = rd.Get<uint16_t>();
+	int32_t extraspace = rd.Get<int32_t>();
+	uint32_t codesize = rd.Get<uint32_t>();
+	uint32_t numlines = rd.Get<uint32_t>();
+	uint32_t numkonstd = rd.Get<uint32_t>();
+	uint32_t numkonstf = rd.Get<uint32_t>();
+	uint32_t numkonsts = rd.Get<uint32_t>();
+	uint32_t numkonsta = rd.Get<uint32_t>();
+	FString sourcefile = rd.GetString();
+	if (rd.Failed || codesize == 0 || codesize > 65535 * 256 || numlines > 65535 ||
+		numkonstd > 65535 || numkonstf > 65535 || numkonsts > 65535 || numkonsta > 65535)
+	{
+		return false;
+	}
+
+	TArray<PType *> rettypes, argtypes;
+	if (flags & CACHEF_NewProto)
+	{
+		uint32_t count = rd.Get<uint32_t>();
+		for (uint32_t i = 0; i < count && !rd.Failed; i++) rettypes.Push(gettype());
+		count = rd.Get<uint32_t>();
+		for (uint32_t i = 0; i < count && !rd.Failed; i++) argtypes.Push(gettype());
+	}
+
+	TArray<FTypeAndOffset> specialinits;
+	uint32_t numinits = rd.Get<uint32_t>();
+	for (uint32_t i = 0; i < numinits && !rd.Failed; i++)
+	{
+		PType *type = gettype();
+		unsigned offset = rd.Get<uint32_t>();
+		specialinits.Push(std::make_pair(type, offset));
+	}
+	if (rd.Failed) return false;
+
+	// The code, line info, int and float constants are read directly into the function afterward.
+	size_t rawsize = codesize * sizeof(VMOP) + numlines * sizeof(FStatementInfo) + numkonstd * sizeof(int) + numkonstf * sizeof(double);
+	if (rawsize > size_t(rd.End - rd.Pos)) return false;
+	const uint8_t *raw = rd.Pos;
+	rd.Pos += rawsize;
+
+	TArray<FString> konsts;
+	for (uint32_t i = 0; i < numkonsts && !rd.Failed; i++)
+	{
+		konsts.Push(rd.GetString());
+	}
+
+	TArray<void *> konsta;
+	for (uint32_t i = 0; i < numkonsta && !rd.Failed; i++)
+	{
+		void *ptr = nullptr;
+		uint32_t idx;
+		switch (rd.Get<uint8_t>())
+		{
+		case RELOC_Raw:
+			ptr = (void *)(intptr_t)rd.Get<int64_t>();
+			break;
+
+		case RELOC_Function:
+			idx = rd.Get<uint32_t>();
+			if (idx < FunctionCount) ptr = VMFunction::AllFunctions[idx];
+			else rd.Failed = true;
+			break;
+
+		case RELOC_Type:
+			idx = rd.Get<uint32_t>();
+			if (idx < TypeCount) ptr = TypeTable.AllTypes[idx];
+			else rd.Failed = true;
+			break;
+
+		case RELOC_Class:
+			idx = rd.Get<uint32_t>();
+			if (idx < ClassCount) ptr = PClass::AllClasses[idx];
+			else rd.Failed = true;
+			break;
+
+		case RELOC_Arena:
+		{
+			idx = rd.Get<uint32_t>();
+			uint64_t offset = rd.Get<uint64_t>();
+			if (idx < ArenaUsage.Size() && offset < ArenaUsage[idx]) ptr = ClassDataAllocator.GetAddress(idx, (size_t)offset);
+			if (ptr == nullptr) rd.Failed = true;
+			break;
+		}
+
+		case RELOC_Static:
+			ptr = (char *)this + rd.Get<int64_t>();
+			break;
+
+		case RELOC_CVar:
+		{
+			FString name = rd.GetString();
+			uint32_t offset = rd.Get<uint32_t>();
+			FBaseCVar *cvar = rd.Failed ? nullptr : FindCVar(name.GetChars(), nullptr);
+			if (cvar != nullptr) ptr = (char *)cvar + offset;
+			else rd.Failed = true;
+			break;
+		}
+
+		case RELOC_ArenaData:
+		{
+			uint32_t size = rd.Get<uint32_t>();
+			if (size > size_t(rd.End - rd.Pos))
+			{
+				rd.Failed = true;
+				break;
+			}
+			ptr = ClassDataAllocator.Alloc(size);
+			memcpy(ptr, rd.Pos, size);
+			rd.Pos += size;
+			break;
+		}
+
+		default:
+			rd.Failed = true;
+			break;
+		}
+		konsta.Push(ptr);
+	}
+	if (rd.Failed) return false;
+
+	func->Alloc(codesize, numkonstd, numkonstf, numkonsts, numkonsta, numlines);
+	memcpy(func->Code, raw, codesize * sizeof(VMOP));
+	raw += codesize * sizeof(VMOP);
+	if (numlines > 0) memcpy(func->LineInfo, raw, numlines * sizeof(FStatementInfo));
+	raw += numlines * sizeof(FStatementInfo);
+	if (numkonstd > 0) memcpy(func->KonstD, raw, numkonstd * sizeof(int));
+	raw += numkonstd * sizeof(int);
+	if (numkonstf > 0) memcpy(func->KonstF, raw, numkonstf * sizeof(double));
+	for (uint32_t i = 0; i < numkonsts; i++) func->KonstS[i] = konsts[i];
+	for (uint32_t i = 0; i < numkonsta; i++) func->KonstA[i].v = konsta[i];
+
+	if (flags & CACHEF_NewProto)
+	{
+		func->Proto = NewPrototype(rettypes, argtypes);
+		func->ArgFlags = pfunc->Variants[0].ArgFlags;
+	}
+	func->SourceFileName = sourcefile;
+	func->NumRegD = numregs[REGT_INT];
+	func->NumRegF = numregs[REGT_FLOAT];
+	func->NumRegS = numregs[REGT_STRING];
+	func->NumRegA = numregs[REGT_POINTER];
+	func->MaxParam = maxparam;
+	func->ExtraSpace = extraspace;
+	func->SpecialInits = std::move(specialinits);
+	func->StackSize = VMFrame::FrameSize(func->NumRegD, func->NumRegF, func->NumRegS, func->NumRegA, func->MaxParam, func->ExtraSpace);
+	func->NumArgs = numargs;
+	func->Unsafe = !!(flags & CACHEF_Unsafe);
+	Restored++;
+	return true;
+}
+
+//==========================================================================
+//
+// FScriptCache :: WriteType
+//
+//==========================================================================
+
+bool FScriptCache::WriteType(TArray<uint8_t> &out, const PType *type)
+{
+	auto index = TypeIndex.CheckKey(type);
+	if (index == nullptr) return false;
+	Put<uint32_t>(out, *index);
+	return true;
+}
+
+//==========================================================================
+//
+// FScriptCache :: WriteAddress
+//
+// Returns false for addresses that cannot be found again in another
+// session. Functions using such addresses are always compiled.
+//
+//==========================================================================
+
+bool FScriptCache::WriteAddress(TArray<uint8_t> &out, void *ptr, VMFunctionBuilder &build)
+{
+	if (auto origin = build.GetAddressOrigin(ptr))
+	{
+		switch (origin->Kind)
+		{
+		case FAddressOrigin::CVar:
+			Put<uint8_t>(out, RELOC_CVar);
+			PutString(out, origin->Owner->GetName());
+			Put<uint32_t>(out, origin->Offset);
+			return true;
+
+		case FAddressOrigin::Static:
+			Put<uint8_t>(out, RELOC_Static);
+			Put<int64_t>(out, (char *)ptr - (char *)this);
+			return true;
+
+		case FAddressOrigin::ArenaData:
+			Put<uint8_t>(out, RELOC_ArenaData);
+			Put<uint32_t>(out, origin->Size);
+			PutData(out, ptr, origin->Size);
+			return true;
+		}
+		return false;
+	}
+
+	if ((uintptr_t)ptr < 0x10000)
+	{
+		Put<uint8_t>(out, RELOC_Raw);
+		Put<int64_t>(out, (intptr_t)ptr);
+		return true;
+	}
+	if (auto index = FunctionIndex.CheckKey(ptr))
+	{
+		Put<uint8_t>(out, RELOC_Function);
+		Put<uint32_t>(out, *index);
+		return true;
+	}
+	if (auto index = TypeIndex.CheckKey(ptr))
+	{
+		Put<uint8_t>(out, RELOC_Type);
+		Put<uint32_t>(out, *index);
+		return true;
+	}
+	if (auto index = ClassIndex.CheckKey(ptr))
+	{
+		Put<uint8_t>(out, RELOC_Class);
+		Put<uint32_t>(out, *index);
+		return true;
+	}
+
+	// Anything allocated in the arena before the build started, e.g. states or static arrays.
+	unsigned block;
+	size_t offset;
+	if (ClassDataAllocator.GetLocation(ptr, block, offset) && block < ArenaUsage.Size() && offset < ArenaUsage[block])
+	{
+		Put<uint8_t>(out, RELOC_Arena);
+		Put<uint32_t>(out, block);
+		Put<uint64_t>(out, offset);
+		return true;
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// FScriptCache :: Store
+//
+// Records a freshly compiled function. Must be called in build order.
+//
+//==========================================================================
+
+void FScriptCache::Store(unsigned index, VMScriptFunction *func, VMFunctionBuilder &build, bool newproto, bool nocache)
+{
+	if (!Active || Loaded) return;
+
+	if (FunctionIndex.CountUsed() == 0)
+	{
+		for (unsigned i = 0; i < FunctionCount; i++) FunctionIndex.Insert(VMFunction::AllFunctions[i], i);
+		for (unsigned i = 0; i < TypeCount; i++) TypeIndex.Insert(TypeTable.AllTypes[i], i);
+		for (unsigned i = 0; i < ClassCount; i++) ClassIndex.Insert(PClass::AllClasses[i], i);
+	}
+
+	// Functions that were skipped or failed to compile get an empty record.
+	while (RecordSize.Size() < index)
+	{
+		RecordStart.Push(Data.Size());
+		RecordSize.Push(0);
+	}
+
+	unsigned start = Data.Size();
+	bool ok = !nocache;
+	if (ok)
+	{
+		Put<uint8_t>(Data, (func->Unsafe ? CACHEF_Unsafe : 0) | (newproto ? CACHEF_NewProto : 0));
+		Put<uint8_t>(Data, func->NumArgs);
+		Put<uint8_t>(Data, func->NumRegD);
+		Put<uint8_t>(Data, func->NumRegF);
+		Put<uint8_t>(Data, func->NumRegS);
+		Put<uint8_t>(Data, func->NumRegA);
+		Put<uint16_t>(Data, func->MaxParam);
+		Put<int32_t>(Data, func->ExtraSpace);
+		Put<uint32_t>(Data, func->CodeSize);
+		Put<uint32_t>(Data, func->LineInfoCount);
+		Put<uint32_t>(Data, func->NumKonstD);
+		Put<uint32_t>(Data, func->NumKonstF);
+		Put<uint32_t>(Data, func->NumKonstS);
+		Put<uint32_t>(Data, func->NumKonstA);
+		PutString(Data, func->SourceFileName.GetChars());
+
+		if (newproto)
+		{
+			Put<uint32_t>(Data, func->Proto->ReturnTypes.Size());
+			for (auto type : func->Proto->ReturnTypes) ok &= WriteType(Data, type);
+			Put<uint32_t>(Data, func->Proto->ArgumentTypes.Size());
+			for (auto type : func->Proto->ArgumentTypes) ok &= WriteType(Data, type);
+		}
+
+		Put<uint32_t>(Data, func->SpecialInits.Size());
+		for (auto &init : func->SpecialInits)
+		{
+			ok &= WriteType(Data, init.first);
+			Put<uint32_t>(Data, init.second);
+		}
+
+		PutData(Data, func->Code, func->CodeSize * sizeof(VMOP));
+		PutData(Data, func->LineInfo, func->LineInfoCount * sizeof(FStatementInfo));
+		PutData(Data, func->KonstD, func->NumKonstD * sizeof(int));
+		PutData(Data, func->KonstF, func->NumKonstF * sizeof(double));
+		for (int i = 0; i < func->NumKonstS; i++) PutString(Data, func->KonstS[i].GetChars());
+		for (int i = 0; i < func->NumKonstA && ok; i++) ok = WriteAddress(Data, func->KonstA[i].v, build);
+	}
+
+	if (!ok) Data.Resize(start);
+	RecordStart.Push(start);
+	RecordSize.Push(Data.Size() - start);
+}
+
+//==========================================================================
+//
+// FScriptCache :: Save
+//
+//==========================================================================
+
+void FScriptCache::Save(const uint8_t *key)
+{
+	TArray<uint8_t> header;
+	PutData(header, ScriptCacheMagic, 4);
+	PutData(header, key, 16);
+	Put<uint32_t>(header, FName::GetNumNames() - NameCount);
+	for (int i = NameCount; i < FName::GetNumNames(); i++)
+	{
+		PutString(header, FName(ENamedName(i)).GetChars());
+	}
+	Put<uint32_t>(header, RecordSize.Size());
+
+	WriteFileReplace(Filename.GetChars(), [&](FileWriter* fw)
+	{
+		bool ok = fw->Write(header.Data(), header.Size()) == header.Size();
+		for (unsigned i = 0; i < RecordSize.Size() && ok; i++)
+		{
+			uint32_t size = RecordSize[i];
+			ok = fw->Write(&size, sizeof(size)) == sizeof(size) && (size == 0 || fw->Write(&Data[RecordStart[i]], size) == size);
+		}
+		return ok;
+	});
+}
+
+//==========================================================================
+//
+// FScriptCache :: EndBuild
+//
+// The cache only gets written if the build did not produce any errors or
+// warnings, because restored functions cannot report them again.
+//
+//==========================================================================
+
+void FScriptCache::EndBuild()
+{
+	if (Loaded)
+	{
+		DPrintf(DMSG_NOTIFY, "Restored %u script functions from %s\n", Restored, Filename.GetChars());
+	}
+	else if (Active && FScriptPosition::ErrorCounter == 0 && FScriptPosition::WarnCounter == WarnCount)
+	{
+		try
+		{
+			Save(Key);
+		}
+		catch (...)
+		{
+		}
+	}
+
+	Active = Loaded = false;
+	Sources.Clear();
+	Data.Reset();
+	RecordStart.Reset();
+	RecordSize.Reset();
+	FunctionIndex.Clear();
+	TypeIndex.Clear();
+	ClassIndex.Clear();
+	ArenaUsage.Reset();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "tarray.h"
+#include "zstring.h"
+
+class VMScriptFunction;
+class VMFunctionBuilder;
+class PFunction;
+class PType;
+
+// Stores the code generator's output for all script functions on disk so that
+// later sessions with the same scripts can skip resolving and emitting them.
+// The cache is only used if the scripts, the engine binary and all global
+// tables the generated code refers to by index are identical.
+
+class FScriptCache
+{
+public:
+	void AddSource(int lump);
+
+	void BeginBuild(const TArray<FString> &functions);
+	bool Restore(unsigned index, VMScriptFunction *func, PFunction *pfunc);
+	void Store(unsigned index, VMScriptFunction *func, VMFunctionBuilder &build, bool newproto, bool nocache);
+	void EndBuild();
+
+private:
+	void ComputeKey(const TArray<FString> &functions, uint8_t *key, FString &filename);
+	bool Load(const uint8_t *key);
+	void Save(const uint8_t *key);
+	bool WriteAddress(TArray<uint8_t> &out, void *ptr, VMFunctionBuilder &build);
+	bool WriteType(TArray<uint8_t> &out, const PType *type);
+
+	TArray<int> Sources;
+	FString Filename;
+	uint8_t Key[16];
+	bool Active = false;
+	bool Loaded = false;
+
+	// State of the global tables when the build started. Everything
+	// created after this point cannot be referenced by index.
+	int NameCount;
+	int WarnCount;
+	unsigned FunctionCount;
+	unsigned TypeCount;
+	unsigned ClassCount;
+	TArray<size_t> ArenaUsage;
+
+	TMap<const void *, unsigned> FunctionIndex;
+	TMap<const void *, unsigned> TypeIndex;
+	TMap<const void *, unsigned> ClassIndex;
+
+	TArray<uint8_t> Data;
+	TArray<unsigned> RecordStart;
+	TArray<unsigned> RecordSize;
+	unsigned Restored;
+};
+
+extern FScriptCache ScriptCache;
@@ -3594,6 +3594,7 @@ void FTypeTable::AddType(PType *type, FName type_name, intptr_t parm1, intptr_t
 	type->TypeTableType = type_name;
 	type->HashNext = TypeHash[bucket];
 	TypeHash[bucket] = type;
+	AllTypes.Push(type);
 }
 
 //==========================================================================
@@ -3615,6 +3616,7 @@ void FTypeTable::AddType(PType *type, FName type_name)
 
 	type->HashNext = TypeHash[bucket];
 	TypeHash[bucket] = type;
+	AllTypes.Push(type);
 }
 
 //==========================================================================
@@ -3683,6 +3685,7 @@ void FTypeTable::Clear()
 		}
 	}
 	memset(TypeHash, 0, sizeof(TypeHash));
+	AllTypes.Clear();
 }
 
 #include "c_dispatch.h"
@@ -758,6 +758,7 @@ struct FTypeTable
 	enum { HASH_SIZE = 1021 };
 
 	PType *TypeHash[HASH_SIZE];
+	TArray<PType *> AllTypes;	// in order of creation
 
 	PType *FindType(FName type_name, intptr_t parm1, intptr_t parm2, size_t *bucketnum);
 	void AddType(PType *type, FName type_name, intptr_t parm1, intptr_t parm2, size_t bucket);
@@ -31,6 +31,10 @@
 **
 */
 
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "dobject.h"
 #include "sc_man.h"
 #include "filesystem.h"
@@ -40,6 +44,8 @@
 #include "version.h"
 #include "zcc_parser.h"
 #include "zcc_compile.h"
+#include "vmcache.h"
+#include "ctpl.h"
 
 
 TArray<FString> Includes;
@@ -406,6 +412,42 @@ parse_end:
 	state.sc = nullptr;
 }
 
+//**--------------------------------------------------------------------------
+//
+// The text of one include file. Reading and decompressing a lump does not
+// touch any global state, so unlike scanning, which the grammar switches
+// into state mode partway through a file, this can run on a worker thread.
+//
+//**--------------------------------------------------------------------------
+
+static std::unique_ptr<ctpl::thread_pool> includeReadPool;
+
+struct FZCCIncludeFile
+{
+	int Lump = -1;
+	bool Failed = false;
+	FString ScriptName;
+	FString Text;
+};
+
+static void ReadIncludeFile(FZCCIncludeFile &file)
+{
+	try
+	{
+		auto len = fileSystem.FileLength(file.Lump);
+		auto buff = file.Text.LockNewBuffer(len);
+		fileSystem.ReadFile(file.Lump, buff);
+		buff[len] = 0;
+		file.Text.UnlockBuffer();
+		file.ScriptName = fileSystem.GetFileFullPath(file.Lump).c_str();
+	}
+	catch (...)
+	{
+		// The main thread reads the file again and reports the error.
+		file.Failed = true;
+	}
+}
+
 //**--------------------------------------------------------------------------
 
 PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
@@ -437,6 +479,7 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 #endif
 
 	sc.OpenLumpNum(lumpnum);
+	ScriptCache.AddSource(lumpnum);
 	sc.SetParseVersion({ 2, 4 });	// To get 'version' we need parse version 2.4 for the initial test
 	auto saved = sc.SavePos();
 
@@ -478,9 +521,32 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 	}
 
 	ParseSingleFile(&sc, nullptr, lumpnum, parser, state);
+
+	// Include files get read on worker threads while the parser works through the list
+	// in its original order. Includes found along the way get queued as soon as the
+	// parser sees them. Scanning stays here because the parser controls the scanner mode.
+	if (!includeReadPool)
+	{
+		includeReadPool.reset(new ctpl::thread_pool(clamp<int>(std::thread::hardware_concurrency() - 1, 1, 8)));
+	}
+	std::vector<std::shared_ptr<FZCCIncludeFile>> loaded;
+	std::vector<std::future<void>> readJobs;
+
 	for (unsigned i = 0; i < Includes.Size(); i++)
 	{
-		lumpnum = fileSystem.CheckNumForFullName(Includes[i].GetChars(), true);
+		for (unsigned j = loaded.size(); j < Includes.Size(); j++)
+		{
+			auto file = std::make_shared<FZCCIncludeFile>();
+			file->Lump = fileSystem.CheckNumForFullName(Includes[j].GetChars(), true);
+			loaded.push_back(file);
+			if (file->Lump != -1)
+			{
+				readJobs.push_back(includeReadPool->push([=](int) { ReadIncludeFile(*file); }));
+			}
+			else readJobs.emplace_back();
+		}
+
+		lumpnum = loaded[i]->Lump;
 		if (lumpnum == -1)
 		{
 			IncludeLocs[i].Message(MSG_ERROR, "Include script lump %s not found", Includes[i].GetChars());
@@ -494,7 +560,21 @@ PNamespace *ParseOneScript(const int baselump, ZCCParseState &state)
 					fileSystem.GetResourceFileFullName(fileSystem.GetFileContainer(lumpnum)), Includes[i].GetChars());
 			}
 
-			ParseSingleFile(nullptr, nullptr, lumpnum, parser, state);
+			ScriptCache.AddSource(lumpnum);
+			readJobs[i].wait();
+			if (loaded[i]->Failed)
+			{
+				// Read it again here so that the error gets reported the normal way.
+				ParseSingleFile(nullptr, nullptr, lumpnum, parser, state);
+			}
+			else
+			{
+				FScanner isc;
+				isc.OpenString(loaded[i]->ScriptName.GetChars(), std::move(loaded[i]->Text));
+				isc.LumpNum = lumpnum;
+				ParseSingleFile(&isc, nullptr, lumpnum, parser, state);
+			}
+			loaded[i].reset();
 		}
 	}
 	Includes.Clear();
@@ -43,6 +43,7 @@
 #include "jit.h"
 #include "c_cvars.h"
 #include "version.h"
+#include "metrics.h"
 
 #ifdef HAVE_VM_JIT
 #ifdef __DragonFly__
@@ -68,6 +69,7 @@ void JitRelease() {}
 
 cycle_t VMCycles[10];
 int VMCalls[10];
+static FCounterMetric VMCallMetric("vm.calls", METRIC_Frame);
 
 #if 0
 IMPLEMENT_CLASS(VMException, false, false)
@@ -592,6 +594,7 @@ int VMCall(VMFunction *func, VMValue *params, int numparams, VMReturn *results,
 			else
 			{
 				VMCycles[0].Clock();
+				VMCallMetric.Add();
 
 				auto sfunc = static_cast<VMScriptFunction *>(func);
 				int numret = sfunc->ScriptCall(sfunc, params, numparams, results, numresults);
@@ -35,6 +35,14 @@
 #include "bitmap.h"
 #include "palutil.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+#define BITMAP_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <emmintrin.h>
+#endif
+
 uint8_t IcePalette[16][3] =
 {
 	{  10,  8, 18 },
@@ -383,6 +391,85 @@ bool FClipRect::Intersect(int ix, int iy, int iw, int ih)
 	return width > 0 && height > 0;
 }
 
+//===========================================================================
+//
+// Fast paths for plain copies, which are by far the most common operation
+// when compositing textures. Instead of going through the generic per
+// channel templates, pixels are moved as whole 32 bit words, four at a time
+// with SSE2. Transparent source pixels leave the destination untouched
+// unless the operation is an overwrite.
+//
+// These depend on PalEntry and BGRA pixels having the same memory layout.
+//
+//===========================================================================
+
+#ifndef __BIG_ENDIAN__
+
+static void CopyPalettedRow(uint32_t *dest, const uint8_t *src, int count, int step, const uint32_t *palette, bool overwrite)
+{
+	int i = 0;
+#ifdef BITMAP_SSE2
+	const __m128i alphamask = _mm_set1_epi32((int)0xff000000);
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= count; i += 4, src += step * 4)
+	{
+		__m128i color = _mm_set_epi32((int)palette[src[step * 3]], (int)palette[src[step * 2]], (int)palette[src[step]], (int)palette[src[0]]);
+		if (!overwrite)
+		{
+			__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(color, alphamask), zero);
+			__m128i old = _mm_loadu_si128((const __m128i *)(dest + i));
+			color = _mm_or_si128(_mm_and_si128(transparent, old), _mm_andnot_si128(transparent, color));
+		}
+		_mm_storeu_si128((__m128i *)(dest + i), color);
+	}
+#endif
+	for (; i < count; i++, src += step)
+	{
+		uint32_t color = palette[*src];
+		if (overwrite || (color & 0xff000000)) dest[i] = color;
+	}
+}
+
+static void CopyTrueColorRow(uint32_t *dest, const uint8_t *src, int count, int step, bool swaprb, bool overwrite)
+{
+	int i = 0;
+#ifdef BITMAP_SSE2
+	if (step == 4)
+	{
+		const __m128i alphamask = _mm_set1_epi32((int)0xff000000);
+		const __m128i greenalphamask = _mm_set1_epi32((int)0xff00ff00);
+		const __m128i lowmask = _mm_set1_epi32(0xff);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 4 <= count; i += 4, src += 16)
+		{
+			__m128i color = _mm_loadu_si128((const __m128i *)src);
+			if (swaprb)
+			{
+				__m128i red = _mm_and_si128(color, lowmask);
+				__m128i blue = _mm_and_si128(_mm_srli_epi32(color, 16), lowmask);
+				color = _mm_or_si128(_mm_and_si128(color, greenalphamask), _mm_or_si128(_mm_slli_epi32(red, 16), blue));
+			}
+			if (!overwrite)
+			{
+				__m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(color, alphamask), zero);
+				__m128i old = _mm_loadu_si128((const __m128i *)(dest + i));
+				color = _mm_or_si128(_mm_and_si128(transparent, old), _mm_andnot_si128(transparent, color));
+			}
+			_mm_storeu_si128((__m128i *)(dest + i), color);
+		}
+	}
+#endif
+	for (; i < count; i++, src += step)
+	{
+		uint32_t color;
+		memcpy(&color, src, 4);
+		if (swaprb) color = (color & 0xff00ff00) | ((color >> 16) & 0xff) | ((color & 0xff) << 16);
+		if (overwrite || (color & 0xff000000)) dest[i] = color;
+	}
+}
+
+#endif
+
 //===========================================================================
 //
 // True Color texture copy function
@@ -396,6 +483,16 @@ void FBitmap::CopyPixelDataRGB(int originx, int originy, const uint8_t *patch, i
 	{
 		uint8_t *buffer = data + 4 * originx + Pitch * originy;
 		int op = inf==NULL? OP_COPY : inf->op;
+#ifndef __BIG_ENDIAN__
+		if ((op == OP_COPY || op == OP_OVERWRITE) && (inf == nullptr || inf->blend == BLEND_NONE) && (ct == CF_BGRA || ct == CF_RGBA))
+		{
+			for (int y = 0; y < srcheight; y++)
+			{
+				CopyTrueColorRow((uint32_t*)&buffer[y*Pitch], &patch[y*step_y], srcwidth, step_x, ct == CF_RGBA, op == OP_OVERWRITE);
+			}
+			return;
+		}
+#endif
 		for (int y=0;y<srcheight;y++)
 		{
 			copyfuncs[op][ct](&buffer[y*Pitch], &patch[y*step_y], srcwidth, step_x, inf, r, g, b);
@@ -473,7 +570,18 @@ void FBitmap::CopyPixelData(int originx, int originy, const uint8_t * patch, int
 			}
 		}
 
-		copypalettedfuncs[inf==NULL? OP_COPY : inf->op](buffer, patch, srcwidth, srcheight, Pitch, 
+		int op = inf == NULL ? OP_COPY : inf->op;
+#ifndef __BIG_ENDIAN__
+		if (op == OP_COPY || op == OP_OVERWRITE)
+		{
+			for (int y = 0; y < srcheight; y++)
+			{
+				CopyPalettedRow((uint32_t*)(buffer + y*Pitch), patch + y*step_y, srcwidth, step_x, (const uint32_t*)palette, op == OP_OVERWRITE);
+			}
+			return;
+		}
+#endif
+		copypalettedfuncs[op](buffer, patch, srcwidth, srcheight, Pitch, 
 														step_x, step_y, rotate, palette, inf);
 	}
 }
@@ -149,6 +149,10 @@ class FGameTexture
 	ETextureType UseType = ETextureType::Wall;	// This texture's primary purpose
 	SpritePositioningInfo* spi = nullptr;
 
+	// Texture this one is a part of, if any, and the part's rectangle in texture coordinates.
+	FGameTexture* Atlas = nullptr;
+	FloatRect AtlasRect = { 0.f, 0.f, 1.f, 1.f };
+
 	ISoftwareTexture* SoftwareTexture = nullptr;
 	FMaterial* Material[5] = {  };
 
@@ -350,6 +354,14 @@ public:
 	{
 		Base = Tex;
 	}
+	// Lets 2D drawing sample this texture from a rectangle of a shared one, so that consecutive draws can be batched.
+	void SetAtlas(FGameTexture* atlas, const FloatRect& rect)
+	{
+		Atlas = atlas;
+		AtlasRect = rect;
+	}
+	FGameTexture* GetAtlas() const { return Atlas; }
+	const FloatRect& GetAtlasRect() const { return AtlasRect; }
 	void SetOffsets(int which, int x, int y)
 	{
 		LeftOffset[which] = x;
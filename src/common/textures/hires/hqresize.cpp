@@ -46,6 +46,14 @@
 #include "textures.h"
 #include "texturemanager.h"
 #include "printf.h"
+#include "c_dispatch.h"
+#include "cmdlib.h"
+#include "files.h"
+#include "fs_findfile.h"
+#include "superfasthash.h"
+#include <miniz.h>
+#include <mutex>
+#include <algorithm>
 
 int upscalemask;
 
@@ -103,6 +111,12 @@ CUSTOM_CVAR(Int, gl_texture_hqresize_mt_height, 4, CVAR_ARCHIVE | CVAR_GLOBALCON
 
 CVAR(Int, xbrz_colorformat, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
 
+CVAR(Bool, gl_texture_hqresize_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CUSTOM_CVAR(Int, gl_texture_hqresize_cachesize, 512, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// in MB, 0 means no limit
+{
+	if (self < 0) self = 0;
+}
+
 void UpdateUpscaleMask()
 {
 	if (!gl_texture_hqresizemode || gl_texture_hqresizemult == 1) upscalemask = 0;
@@ -414,6 +428,190 @@ static void xbrzOldScale(size_t factor, const uint32_t* src, uint32_t* trg, int
 }
 
 
+//===========================================================================
+// 
+// Upscaled texture cache
+//
+// Upscaling is slow enough to cause noticeable hitches when new textures
+// come into view, so the results are stored on disk and reused by later
+// sessions. Files are keyed by the source pixels and every setting which
+// affects the output. Once the directory grows past the size limit, the
+// oldest files get removed.
+//
+//===========================================================================
+
+struct FUpscaleCacheHeader
+{
+	char Magic[4];
+	uint32_t PixelCRC;
+	uint32_t PixelHash;
+	int32_t InWidth;
+	int32_t InHeight;
+	int32_t Type;
+	int32_t Mult;
+	float XbrzOptions[5];
+	int32_t XbrzColorFormat;
+	// everything above is the key.
+	int32_t OutWidth;
+	int32_t OutHeight;
+	uint32_t CompressedSize;
+};
+
+static const char UpscaleCacheMagic[4] = { 'H', 'Q', 'R', '2' };
+
+static const FString& GetUpscaleCachePath()
+{
+	static const FString path = GetCacheSubPath("hqresize");
+	return path;
+}
+
+static void InitUpscaleCacheKey(FUpscaleCacheHeader& header, const unsigned char* buffer, int width, int height, int type, int mult)
+{
+	size_t size = size_t(width) * height * 4;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.Magic, UpscaleCacheMagic, 4);
+	header.PixelCRC = crc32(0, buffer, size);
+	header.PixelHash = SuperFastHash((const char*)buffer, size);
+	header.InWidth = width;
+	header.InHeight = height;
+	header.Type = type;
+	header.Mult = mult;
+	if (type == 4 || type == 5)
+	{
+		header.XbrzOptions[0] = xbrz_luminanceweight;
+		header.XbrzOptions[1] = xbrz_equalcolortolerance;
+		header.XbrzOptions[2] = xbrz_centerdirectionbias;
+		header.XbrzOptions[3] = xbrz_dominantdirectionthreshold;
+		header.XbrzOptions[4] = xbrz_steepdirectionthreshold;
+		header.XbrzColorFormat = xbrz_colorformat;
+	}
+}
+
+static FString GetUpscaleCacheFileName(const FUpscaleCacheHeader& key)
+{
+	uint32_t keycrc = crc32(0, (const unsigned char*)&key, offsetof(FUpscaleCacheHeader, OutWidth));
+	FString filename;
+	filename.Format("%s/%08x%08x.hqr", GetUpscaleCachePath().GetChars(), key.PixelCRC, keycrc);
+	return filename;
+}
+
+static unsigned char* LoadUpscaledBuffer(const FUpscaleCacheHeader& key, const FString& filename, int& outWidth, int& outHeight)
+{
+	FileReader fr;
+	if (!fr.OpenFile(filename.GetChars())) return nullptr;
+
+	FUpscaleCacheHeader header;
+	if (fr.Read(&header, sizeof(header)) != (FileReader::Size)sizeof(header)) return nullptr;
+	if (memcmp(&header, &key, offsetof(FUpscaleCacheHeader, OutWidth)) != 0) return nullptr;
+	if (header.OutWidth != key.InWidth * key.Mult || header.OutHeight != key.InHeight * key.Mult) return nullptr;
+
+	if (header.CompressedSize == 0 || header.CompressedSize > fr.GetLength() - (FileReader::Size)sizeof(header)) return nullptr;
+
+	TArray<uint8_t> compressed(header.CompressedSize, true);
+	if (fr.Read(compressed.Data(), header.CompressedSize) != (FileReader::Size)header.CompressedSize) return nullptr;
+
+	size_t size = size_t(header.OutWidth) * header.OutHeight * 4;
+	auto buffer = new unsigned char[size];
+	mz_ulong destlen = (mz_ulong)size;
+	if (uncompress(buffer, &destlen, compressed.Data(), header.CompressedSize) != Z_OK || destlen != size)
+	{
+		delete[] buffer;
+		return nullptr;
+	}
+	outWidth = header.OutWidth;
+	outHeight = header.OutHeight;
+	return buffer;
+}
+
+static std::mutex upscaleCacheSizeMutex;
+static int64_t upscaleCacheBytes = -1;	// -1 until the directory was scanned
+
+// Removes the oldest files until the cache is down to 3/4 of the limit. Returns the new size.
+static int64_t TrimUpscaleCache(int64_t limit)
+{
+	struct FCacheFile
+	{
+		std::string Path;
+		uint64_t Size;
+		int64_t Time;
+	};
+	std::vector<FileSys::FileListEntry> list;
+	std::vector<FCacheFile> files;
+	int64_t total = 0;
+	if (FileSys::ScanDirectory(list, GetUpscaleCachePath().GetChars(), "*.hqr", true))
+	{
+		for (auto& entry : list)
+		{
+			uint64_t size = 0;
+			int64_t time = 0;
+			if (entry.isDirectory || !FileSys::FS_GetFileInfo(entry.FilePath.c_str(), &size, &time)) continue;
+			files.push_back({ entry.FilePath, size, time });
+			total += size;
+		}
+	}
+	if (limit <= 0 || total <= limit) return total;
+
+	std::sort(files.begin(), files.end(), [](const FCacheFile& a, const FCacheFile& b) { return a.Time < b.Time; });
+	for (auto& file : files)
+	{
+		if (total <= limit / 4 * 3) break;
+		RemoveFile(file.Path.c_str());
+		total -= file.Size;
+	}
+	return total;
+}
+
+static void AddToUpscaleCacheSize(int64_t bytes)
+{
+	std::lock_guard<std::mutex> lock(upscaleCacheSizeMutex);
+	int64_t limit = int64_t(gl_texture_hqresize_cachesize) << 20;
+	if (upscaleCacheBytes < 0)
+	{
+		upscaleCacheBytes = TrimUpscaleCache(limit);
+	}
+	upscaleCacheBytes += bytes;
+	if (limit > 0 && upscaleCacheBytes > limit)
+	{
+		upscaleCacheBytes = TrimUpscaleCache(limit);
+	}
+}
+
+static void SaveUpscaledBuffer(FUpscaleCacheHeader header, const FString& filename, const unsigned char* buffer, int width, int height)
+{
+	size_t size = size_t(width) * height * 4;
+	mz_ulong complen = compressBound((mz_ulong)size);
+	TArray<uint8_t> compressed(complen, true);
+	if (compress2(compressed.Data(), &complen, buffer, (mz_ulong)size, Z_BEST_SPEED) != Z_OK) return;
+
+	header.OutWidth = width;
+	header.OutHeight = height;
+	header.CompressedSize = (uint32_t)complen;
+
+	bool ok = WriteFileReplace(filename.GetChars(), [&](FileWriter* fw)
+	{
+		return fw->Write(&header, sizeof(header)) == sizeof(header) && fw->Write(compressed.Data(), complen) == complen;
+	});
+	if (ok) AddToUpscaleCacheSize(sizeof(header) + complen);
+}
+
+CCMD(hqresize_clearcache)
+{
+	std::vector<FileSys::FileListEntry> list;
+	if (FileSys::ScanDirectory(list, GetUpscaleCachePath().GetChars(), "*.hqr", true))
+	{
+		for (auto& entry : list)
+		{
+			if (!entry.isDirectory) RemoveFile(entry.FilePath.c_str());
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(upscaleCacheSizeMutex);
+		upscaleCacheBytes = -1;
+	}
+	Printf("%d cached upscaled textures removed\n", (int)list.size());
+}
+
 //===========================================================================
 // 
 // [BB] Upsamples the texture in texbuffer.mBuffer, frees texbuffer.mBuffer and returns
@@ -442,7 +640,22 @@ void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasA
 	if (mult < 2 || mult > 6 || type < 1 || type > 6) return;
 	if (type < 4 && mult > 4) mult = 4;
 
-	if (!checkonly)
+	FUpscaleCacheHeader cachekey;
+	FString cachefile;
+	unsigned char* cached = nullptr;
+	if (!checkonly && gl_texture_hqresize_cache)
+	{
+		InitUpscaleCacheKey(cachekey, texbuffer.mBuffer, inWidth, inHeight, type, mult);
+		cachefile = GetUpscaleCacheFileName(cachekey);
+		cached = LoadUpscaledBuffer(cachekey, cachefile, texbuffer.mWidth, texbuffer.mHeight);
+	}
+
+	if (cached != nullptr)
+	{
+		delete[] texbuffer.mBuffer;
+		texbuffer.mBuffer = cached;
+	}
+	else if (!checkonly)
 	{
 		if (type == 1)
 		{
@@ -484,6 +697,11 @@ void FTexture::CreateUpsampledTextureBuffer(FTextureBuffer &texbuffer, bool hasA
 			texbuffer.mBuffer = normalNx(mult, texbuffer.mBuffer, inWidth, inHeight, texbuffer.mWidth, texbuffer.mHeight);
 		else
 			return;
+
+		if (cachefile.IsNotEmpty())
+		{
+			SaveUpscaledBuffer(cachekey, cachefile, texbuffer.mBuffer, texbuffer.mWidth, texbuffer.mHeight);
+		}
 	}
 	else
 	{
@@ -0,0 +1,441 @@
+/*
+** hw_texcompress.cpp
+** BC1/BC3 block compression of textures on the CPU
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#include <miniz.h>
+#include "hw_texcompress.h"
+#include "c_cvars.h"
+#include "cmdlib.h"
+#include "files.h"
+#include "superfasthash.h"
+#include "parallel_for.h"
+#include "texturemanager.h"
+
+CUSTOM_CVAR(Bool, gl_texture_compression, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOINITCALL)
+{
+	TexMan.FlushAll();
+}
+
+CVAR(Bool, gl_texture_compression_cache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+// Small textures are mostly UI and font graphics. They suffer most from block artifacts and gain the least.
+enum { MIN_COMPRESS_SIZE = 64 };
+
+bool IsTextureCompressionEnabled()
+{
+	return gl_texture_compression;
+}
+
+//===========================================================================
+//
+// Only textures used in the world get compressed. UI graphics and font
+// characters are viewed 1:1 where block artifacts are clearly visible.
+//
+//===========================================================================
+
+bool IsCompressibleTexture(FGameTexture* tex)
+{
+	if (tex->isHardwareCanvas() || tex->isSoftwareCanvas()) return false;
+	switch (tex->GetUseType())
+	{
+	case ETextureType::Wall:
+	case ETextureType::Flat:
+	case ETextureType::Sprite:
+	case ETextureType::WallPatch:
+	case ETextureType::Build:
+	case ETextureType::SkinSprite:
+	case ETextureType::Decal:
+	case ETextureType::Override:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+//===========================================================================
+//
+// Block encoders
+//
+// Endpoints are taken from the inset bounding box of the block's colors.
+// The box diagonal is flipped per channel when that channel correlates
+// negatively with green, which keeps gradients across hues intact.
+//
+//===========================================================================
+
+static inline uint16_t To565(int r, int g, int b)
+{
+	return uint16_t((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) | ((b * 31 + 127) / 255));
+}
+
+static inline void From565(uint16_t c, int* rgb)
+{
+	int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+static void EncodeColorBlock(const uint8_t* block, uint8_t* dest)
+{
+	int minc[3] = { 255, 255, 255 }, maxc[3] = { 0, 0, 0 }, sum[3] = { 0, 0, 0 };
+	for (int i = 0; i < 16; i++)
+	{
+		const uint8_t* p = block + i * 4;
+		int rgb[3] = { p[2], p[1], p[0] };
+		for (int c = 0; c < 3; c++)
+		{
+			minc[c] = std::min(minc[c], rgb[c]);
+			maxc[c] = std::max(maxc[c], rgb[c]);
+			sum[c] += rgb[c];
+		}
+	}
+
+	int covrg = 0, covbg = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		const uint8_t* p = block + i * 4;
+		int g = p[1] * 16 - sum[1];
+		covrg += (p[2] * 16 - sum[0]) * g;
+		covbg += (p[0] * 16 - sum[2]) * g;
+	}
+	if (covrg < 0) std::swap(minc[0], maxc[0]);
+	if (covbg < 0) std::swap(minc[2], maxc[2]);
+
+	for (int c = 0; c < 3; c++)
+	{
+		int inset = (maxc[c] - minc[c]) / 16;
+		maxc[c] -= inset;
+		minc[c] += inset;
+	}
+
+	uint16_t c0 = To565(maxc[0], maxc[1], maxc[2]);
+	uint16_t c1 = To565(minc[0], minc[1], minc[2]);
+	if (c0 < c1) std::swap(c0, c1);	// c0 > c1 selects the opaque 4 color mode.
+
+	uint32_t indices = 0;
+	if (c0 != c1)
+	{
+		int palette[4][3];
+		From565(c0, palette[0]);
+		From565(c1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			const uint8_t* p = block + i * 4;
+			int best = 0, bestdist = INT_MAX;
+			for (int j = 0; j < 4; j++)
+			{
+				int dr = p[2] - palette[j][0], dg = p[1] - palette[j][1], db = p[0] - palette[j][2];
+				int dist = dr * dr + dg * dg + db * db;
+				if (dist < bestdist)
+				{
+					bestdist = dist;
+					best = j;
+				}
+			}
+			indices |= uint32_t(best) << (i * 2);
+		}
+	}
+
+	dest[0] = uint8_t(c0);
+	dest[1] = uint8_t(c0 >> 8);
+	dest[2] = uint8_t(c1);
+	dest[3] = uint8_t(c1 >> 8);
+	dest[4] = uint8_t(indices);
+	dest[5] = uint8_t(indices >> 8);
+	dest[6] = uint8_t(indices >> 16);
+	dest[7] = uint8_t(indices >> 24);
+}
+
+static void EncodeAlphaBlock(const uint8_t* block, uint8_t* dest)
+{
+	int amin = 255, amax = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		amin = std::min(amin, (int)block[i * 4 + 3]);
+		amax = std::max(amax, (int)block[i * 4 + 3]);
+	}
+
+	uint64_t indices = 0;
+	if (amin != amax)
+	{
+		// a0 > a1 selects the 8 value mode.
+		int palette[8] = { amax, amin };
+		for (int j = 2; j < 8; j++)
+		{
+			palette[j] = ((8 - j) * amax + (j - 1) * amin) / 7;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int a = block[i * 4 + 3];
+			int best = 0, bestdist = INT_MAX;
+			for (int j = 0; j < 8; j++)
+			{
+				int dist = abs(a - palette[j]);
+				if (dist < bestdist)
+				{
+					bestdist = dist;
+					best = j;
+				}
+			}
+			indices |= uint64_t(best) << (i * 3);
+		}
+	}
+
+	dest[0] = uint8_t(amax);
+	dest[1] = uint8_t(amin);
+	for (int i = 0; i < 6; i++)
+	{
+		dest[2 + i] = uint8_t(indices >> (i * 8));
+	}
+}
+
+void CompressBC1Block(const uint8_t* block, uint8_t* dest)
+{
+	EncodeColorBlock(block, dest);
+}
+
+void CompressBC3Block(const uint8_t* block, uint8_t* dest)
+{
+	EncodeAlphaBlock(block, dest);
+	EncodeColorBlock(block, dest + 8);
+}
+
+//===========================================================================
+//
+// Compresses one mip level. Rows of blocks are processed in parallel.
+// Blocks extending past the edge of the image repeat the edge pixels.
+//
+//===========================================================================
+
+static void CompressLevel(const uint8_t* pixels, int width, int height, int format, uint8_t* dest)
+{
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+	int blockSize = format == TEXCOMPRESS_BC1 ? 8 : 16;
+
+	parallel_for(blocksY, [=](int by)
+	{
+		uint8_t block[64];
+		uint8_t* out = dest + size_t(by) * blocksX * blockSize;
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			for (int y = 0; y < 4; y++)
+			{
+				int sy = std::min(by * 4 + y, height - 1);
+				for (int x = 0; x < 4; x++)
+				{
+					int sx = std::min(bx * 4 + x, width - 1);
+					memcpy(block + (y * 4 + x) * 4, pixels + (size_t(sy) * width + sx) * 4, 4);
+				}
+			}
+			if (format == TEXCOMPRESS_BC1) CompressBC1Block(block, out);
+			else CompressBC3Block(block, out);
+			out += blockSize;
+		}
+	});
+}
+
+//===========================================================================
+//
+// Box filtered mip level, matching the linear blit used for uncompressed
+// textures closely enough.
+//
+//===========================================================================
+
+static void DownsampleLevel(const uint8_t* src, int width, int height, uint8_t* dest, int destwidth, int destheight)
+{
+	for (int y = 0; y < destheight; y++)
+	{
+		int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+		for (int x = 0; x < destwidth; x++)
+		{
+			int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+			const uint8_t* p00 = src + (size_t(y0) * width + x0) * 4;
+			const uint8_t* p01 = src + (size_t(y0) * width + x1) * 4;
+			const uint8_t* p10 = src + (size_t(y1) * width + x0) * 4;
+			const uint8_t* p11 = src + (size_t(y1) * width + x1) * 4;
+			uint8_t* d = dest + (size_t(y) * destwidth + x) * 4;
+			for (int c = 0; c < 4; c++)
+			{
+				d[c] = uint8_t((p00[c] + p01[c] + p10[c] + p11[c] + 2) >> 2);
+			}
+		}
+	}
+}
+
+//===========================================================================
+//
+// Disk cache for compressed textures
+//
+//===========================================================================
+
+struct FCompressedCacheHeader
+{
+	char Magic[4];
+	uint32_t PixelCRC;
+	uint32_t PixelHash;
+	int32_t Width;
+	int32_t Height;
+	int32_t Mipmap;
+	// everything above is the key.
+	int32_t Format;
+	uint32_t NumMips;
+	uint32_t DataSize;
+};
+
+static const char CompressedCacheMagic[4] = { 'B', 'C', 'C', '1' };
+
+static const FString& GetCompressedCachePath()
+{
+	static const FString path = GetCacheSubPath("texcompress");
+	return path;
+}
+
+static bool LoadCompressedTexture(FCompressedTexture& result, const FCompressedCacheHeader& key, const FString& filename)
+{
+	FileReader fr;
+	if (!fr.OpenFile(filename.GetChars())) return false;
+
+	FCompressedCacheHeader header;
+	if (fr.Read(&header, sizeof(header)) != (FileReader::Size)sizeof(header)) return false;
+	if (memcmp(&header, &key, offsetof(FCompressedCacheHeader, Format)) != 0) return false;
+	if ((header.Format != TEXCOMPRESS_BC1 && header.Format != TEXCOMPRESS_BC3) || header.NumMips == 0 || header.NumMips > 32) return false;
+
+	result.Format = header.Format;
+	result.Mips.Resize(header.NumMips);
+	result.Data.Resize(header.DataSize);
+	FileReader::Size mipsize = sizeof(FCompressedMip) * header.NumMips;
+	if (fr.Read(result.Mips.Data(), mipsize) != mipsize) return false;
+	if (fr.Read(result.Data.Data(), header.DataSize) != (FileReader::Size)header.DataSize) return false;
+
+	for (auto& mip : result.Mips)
+	{
+		if (mip.Offset > header.DataSize || mip.Size > header.DataSize - mip.Offset) return false;
+	}
+	return true;
+}
+
+static void SaveCompressedTexture(const FCompressedTexture& texture, FCompressedCacheHeader header, const FString& filename)
+{
+	header.Format = texture.Format;
+	header.NumMips = texture.Mips.Size();
+	header.DataSize = texture.Data.Size();
+
+	size_t mipsize = sizeof(FCompressedMip) * texture.Mips.Size();
+	WriteFileReplace(filename.GetChars(), [&](FileWriter* fw)
+	{
+		return fw->Write(&header, sizeof(header)) == sizeof(header) &&
+			fw->Write(texture.Mips.Data(), mipsize) == mipsize &&
+			fw->Write(texture.Data.Data(), texture.Data.Size()) == texture.Data.Size();
+	});
+}
+
+//===========================================================================
+//
+// Compresses a BGRA texture including its mip chain. Textures without
+// any translucency are stored as BC1, all others as BC3.
+// Returns false if the texture should be uploaded uncompressed.
+//
+//===========================================================================
+
+bool CompressTexture(FCompressedTexture& result, const uint8_t* pixels, int width, int height, bool mipmap)
+{
+	if (width < MIN_COMPRESS_SIZE || height < MIN_COMPRESS_SIZE) return false;
+
+	size_t size = size_t(width) * height * 4;
+	FCompressedCacheHeader key;
+	FString cachefile;
+	if (gl_texture_compression_cache)
+	{
+		memset(&key, 0, sizeof(key));
+		memcpy(key.Magic, CompressedCacheMagic, 4);
+		key.PixelCRC = crc32(0, pixels, size);
+		key.PixelHash = SuperFastHash((const char*)pixels, size);
+		key.Width = width;
+		key.Height = height;
+		key.Mipmap = mipmap;
+		cachefile.Format("%s/%08x%08x-%dx%d.bcc", GetCompressedCachePath().GetChars(), key.PixelCRC, key.PixelHash, width, height);
+
+		if (LoadCompressedTexture(result, key, cachefile)) return true;
+	}
+
+	bool opaque = true;
+	for (size_t i = 3; i < size && opaque; i += 4)
+	{
+		opaque = pixels[i] == 255;
+	}
+	result.Format = opaque ? TEXCOMPRESS_BC1 : TEXCOMPRESS_BC3;
+	int blockSize = opaque ? 8 : 16;
+
+	// Lay out the mip chain first so that the output buffer only needs to be allocated once.
+	result.Mips.Clear();
+	unsigned offset = 0;
+	for (int w = width, h = height; ; w = std::max(w >> 1, 1), h = std::max(h >> 1, 1))
+	{
+		unsigned levelsize = unsigned(((w + 3) / 4) * ((h + 3) / 4) * blockSize);
+		result.Mips.Push({ w, h, offset, levelsize });
+		offset += levelsize;
+		if (!mipmap || (w == 1 && h == 1)) break;
+	}
+	result.Data.Resize(offset);
+
+	TArray<uint8_t> level, nextlevel;
+	const uint8_t* src = pixels;
+	for (unsigned i = 0; i < result.Mips.Size(); i++)
+	{
+		auto& mip = result.Mips[i];
+		if (i > 0)
+		{
+			auto& prev = result.Mips[i - 1];
+			nextlevel.Resize(mip.Width * mip.Height * 4);
+			DownsampleLevel(src, prev.Width, prev.Height, nextlevel.Data(), mip.Width, mip.Height);
+			level.Swap(nextlevel);
+			src = level.Data();
+		}
+		CompressLevel(src, mip.Width, mip.Height, result.Format, result.Data.Data() + mip.Offset);
+	}
+
+	if (cachefile.IsNotEmpty())
+	{
+		SaveCompressedTexture(result, key, cachefile);
+	}
+	return true;
+}
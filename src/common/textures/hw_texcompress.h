@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include "tarray.h"
+
+// CPU block compression of true color textures for the hardware renderers.
+// Input is always BGRA as produced by FTexture::CreateTexBuffer.
+
+enum ETextureCompression
+{
+	TEXCOMPRESS_None,
+	TEXCOMPRESS_BC1,	// opaque textures, 8 bytes per 4x4 block
+	TEXCOMPRESS_BC3,	// textures with alpha, 16 bytes per 4x4 block
+};
+
+struct FCompressedMip
+{
+	int Width;
+	int Height;
+	unsigned Offset;
+	unsigned Size;
+};
+
+struct FCompressedTexture
+{
+	int Format = TEXCOMPRESS_None;
+	TArray<FCompressedMip> Mips;
+	TArray<uint8_t> Data;
+};
+
+class FGameTexture;
+
+bool IsTextureCompressionEnabled();
+bool IsCompressibleTexture(FGameTexture* tex);
+bool CompressTexture(FCompressedTexture& result, const uint8_t* pixels, int width, int height, bool mipmap);
+
+// Encode a single 4x4 block of BGRA pixels (64 bytes, row major).
+void CompressBC1Block(const uint8_t* block, uint8_t* dest);
+void CompressBC3Block(const uint8_t* block, uint8_t* dest);
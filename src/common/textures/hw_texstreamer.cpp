@@ -0,0 +1,194 @@
+/*
+** hw_texstreamer.cpp
+** Creates texture buffers for the hardware renderer on worker threads
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+#include "hw_texstreamer.h"
+#include "image.h"
+#include "c_cvars.h"
+#include "printf.h"
+#include "stats.h"
+#include "ctpl.h"
+
+CVAR(Bool, gl_texture_streaming, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Int, gl_texture_stream_maxuploads, 16, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// 0 means unlimited
+
+static std::unique_ptr<ctpl::thread_pool> streamPool;
+static std::atomic<int> pendingJobs;
+
+CUSTOM_CVAR(Int, gl_texture_stream_threads, 2, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 1) self = 1;
+	else if (self > 16) self = 16;
+	else if (streamPool) streamPool->resize(self);
+}
+
+//==========================================================================
+//
+// FTextureStreamJob
+//
+//==========================================================================
+
+void FTextureStreamJob::Run()
+{
+	int expected = Queued;
+	if (State.compare_exchange_strong(expected, Running))
+	{
+		// Worker threads must not touch the precache data, it is owned by the main thread.
+		FImageSource::SetWorkerThread();
+
+		FTextureBuffer buffer;
+		FCompressedTexture compressed;
+		bool ok;
+		try
+		{
+			buffer = Texture->CreateTexBuffer(Translation, Flags | CTF_ProcessData);
+			ok = buffer.mBuffer != nullptr;
+			if (ok && Compress && CompressTexture(compressed, buffer.mBuffer, buffer.mWidth, buffer.mHeight, true))
+			{
+				buffer = FTextureBuffer();	// not needed anymore.
+			}
+		}
+		catch (...)
+		{
+			// Let the render thread retry synchronously so that errors get reported the normal way.
+			ok = false;
+		}
+
+		std::unique_lock<std::mutex> lock(Mutex);
+		Result = std::move(buffer);
+		CompressedResult = std::move(compressed);
+		State = ok ? Done : Failed;
+		Finished.notify_all();
+	}
+	pendingJobs--;
+}
+
+//==========================================================================
+//
+// Returns false if the buffer could not be created in the background.
+// If the texture got compressed, 'compressed' receives the data and
+// 'result' stays empty.
+//
+//==========================================================================
+
+bool FTextureStreamJob::TakeResult(FTextureBuffer& result, FCompressedTexture& compressed)
+{
+	std::unique_lock<std::mutex> lock(Mutex);
+	if (State != Done) return false;
+	result = std::move(Result);
+	compressed = std::move(CompressedResult);
+	return true;
+}
+
+//==========================================================================
+//
+// Must be called before the texture or its hardware texture get destroyed.
+// If a worker is currently processing the job this waits for it.
+//
+//==========================================================================
+
+void FTextureStreamJob::Cancel()
+{
+	int expected = Queued;
+	if (State.compare_exchange_strong(expected, Cancelled)) return;
+
+	std::unique_lock<std::mutex> lock(Mutex);
+	Finished.wait(lock, [this]() { return State != Running; });
+	State = Cancelled;
+	FTextureBuffer discard = std::move(Result);
+	FCompressedTexture discardCompressed = std::move(CompressedResult);
+}
+
+//==========================================================================
+//
+// FTextureStreamer
+//
+//==========================================================================
+
+bool FTextureStreamer::IsEnabled()
+{
+	return gl_texture_streaming;
+}
+
+//==========================================================================
+//
+// Only untranslated true color textures backed by an image source can be
+// created in the background. Translations may get added by the main thread
+// at any time so these always need to be created synchronously.
+//
+//==========================================================================
+
+bool FTextureStreamer::CanStream(FTexture* tex, int translation, int flags)
+{
+	return gl_texture_streaming && translation == 0 && !(flags & (CTF_Indexed | CTF_CheckOnly)) &&
+		tex->GetImage() != nullptr && !tex->isHardwareCanvas();
+}
+
+std::shared_ptr<FTextureStreamJob> FTextureStreamer::Queue(FTexture* tex, int translation, int flags, bool compress)
+{
+	if (!streamPool)
+	{
+		streamPool.reset(new ctpl::thread_pool(gl_texture_stream_threads));
+	}
+	auto job = std::make_shared<FTextureStreamJob>(tex, translation, flags, compress);
+	pendingJobs++;
+	streamPool->push([job](int) { job->Run(); });
+	return job;
+}
+
+int FTextureStreamer::PendingJobs()
+{
+	return pendingJobs;
+}
+
+//==========================================================================
+//
+// All jobs must have been cancelled or completed before this gets called.
+//
+//==========================================================================
+
+void FTextureStreamer::Shutdown()
+{
+	if (streamPool)
+	{
+		streamPool->stop(true);
+		streamPool.reset();
+	}
+}
+
+ADD_STAT(texstream)
+{
+	FString out;
+	out.Format("Pending texture jobs: %d, threads: %d", FTextureStreamer::PendingJobs(), streamPool ? streamPool->size() : 0);
+	return out;
+}
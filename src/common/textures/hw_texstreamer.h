@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "textures.h"
+#include "hw_texcompress.h"
+
+// Background creation of texture buffers for the hardware renderer.
+// The expensive part of creating a hardware texture (image decoding, compositing and upscaling)
+// is done on worker threads while the render thread uses a placeholder until the data is ready.
+// If requested, the job also block compresses the result so that the render thread only has to upload it.
+
+class FTextureStreamJob
+{
+	friend class FTextureStreamer;
+
+public:
+	enum EState
+	{
+		Queued,
+		Running,
+		Done,
+		Failed,
+		Cancelled
+	};
+
+	FTextureStreamJob(FTexture* tex, int translation, int flags, bool compress) : Texture(tex), Translation(translation), Flags(flags), Compress(compress) {}
+
+	bool IsPending() const { int s = State; return s == Queued || s == Running; }
+	bool TakeResult(FTextureBuffer& result, FCompressedTexture& compressed);
+	void Cancel();
+
+	FTexture* GetTexture() const { return Texture; }
+	int GetTranslation() const { return Translation; }
+	int GetFlags() const { return Flags; }
+	bool GetCompress() const { return Compress; }
+
+private:
+	void Run();
+
+	FTexture* Texture;
+	int Translation;
+	int Flags;
+	bool Compress;
+	std::atomic<int> State = { Queued };
+	std::mutex Mutex;
+	std::condition_variable Finished;
+	FTextureBuffer Result;
+	FCompressedTexture CompressedResult;
+};
+
+class FTextureStreamer
+{
+public:
+	static bool IsEnabled();
+	static bool CanStream(FTexture* tex, int translation, int flags);
+	static std::shared_ptr<FTextureStreamJob> Queue(FTexture* tex, int translation, int flags, bool compress = false);
+	static int PendingJobs();
+	static void Shutdown();
+};
@@ -67,6 +67,9 @@ struct PrecacheDataRgba
 TArray<PrecacheDataPaletted> precacheDataPaletted;
 TArray<PrecacheDataRgba> precacheDataRgba;
 
+// Background texture creation must bypass the precache data because it is not thread safe.
+static thread_local bool isWorkerThread;
+
 //===========================================================================
 // 
 // the default just returns an empty texture.
@@ -87,7 +90,7 @@ PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion, int frame)
 	auto imageID = ImageID;
 
 	// Do we have this image in the cache?
-	unsigned index = conversion != normal? UINT_MAX : precacheDataPaletted.FindEx([=](PrecacheDataPaletted &entry) { return entry.ImageID == imageID && entry.Frame == frame; });
+	unsigned index = conversion != normal || isWorkerThread? UINT_MAX : precacheDataPaletted.FindEx([=](PrecacheDataPaletted &entry) { return entry.ImageID == imageID && entry.Frame == frame; });
 	if (index < precacheDataPaletted.Size())
 	{
 		auto cache = &precacheDataPaletted[index];
@@ -112,7 +115,7 @@ PalettedPixels FImageSource::GetCachedPalettedPixels(int conversion, int frame)
 	else
 	{
 		// The image wasn't cached. Now there's two possibilities: 
-		auto info = precacheInfo.CheckKey(ImageID);
+		auto info = isWorkerThread? nullptr : precacheInfo.CheckKey(ImageID);
 		if (!info || info->second <= 1 || conversion != normal)
 		{
 			// This is either the only copy needed or some access outside the caching block. In these cases create a new one and directly return it.
@@ -214,7 +217,7 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 	{
 		if (conversion == luminance) conversion = normal;	// luminance has no meaning for true color.
 		// Do we have this image in the cache?
-		unsigned index = conversion != normal? UINT_MAX : precacheDataRgba.FindEx([=](PrecacheDataRgba &entry) { return entry.ImageID == imageID && entry.Frame == frame; });
+		unsigned index = conversion != normal || isWorkerThread? UINT_MAX : precacheDataRgba.FindEx([=](PrecacheDataRgba &entry) { return entry.ImageID == imageID && entry.Frame == frame; });
 		if (index < precacheDataRgba.Size())
 		{
 			auto cache = &precacheDataRgba[index];
@@ -243,7 +246,7 @@ FBitmap FImageSource::GetCachedBitmap(const PalEntry *remap, int conversion, int
 		else
 		{
 			// The image wasn't cached. Now there's two possibilities:
-			auto info = precacheInfo.CheckKey(ImageID);
+			auto info = isWorkerThread? nullptr : precacheInfo.CheckKey(ImageID);
 			if (!info || info->first <= 1 || conversion != normal)
 			{
 				// This is either the only copy needed or some access outside the caching block. In these cases create a new one and directly return it.
@@ -310,6 +313,11 @@ void FImageSource::RegisterForPrecache(FImageSource *img, bool requiretruecolor)
 		img->CollectForPrecache(precacheInfo, requiretruecolor);
 }
 
+void FImageSource::SetWorkerThread()
+{
+	isWorkerThread = true;
+}
+
 //==========================================================================
 //
 //
@@ -177,6 +177,7 @@ public:
 	static void BeginPrecaching();
 	static void EndPrecaching();
 	static void RegisterForPrecache(FImageSource *img, bool requiretruecolor);
+	static void SetWorkerThread();
 };
 
 
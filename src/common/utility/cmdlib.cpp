@@ -39,6 +39,8 @@
 #include "filesystem.h"
 #include "files.h"
 #include "md5.h"
+#include "i_specialpaths.h"
+#include <atomic>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -47,6 +49,11 @@
 #ifndef _WIN32
 #include <pwd.h>
 #include <unistd.h>
+#else
+#ifndef _WINNT_
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
 #endif
 
 /*
@@ -613,6 +620,63 @@ int RemoveDir(const char* file)
 #endif
 }
 
+int RenameFile(const char* from, const char* to)
+{
+#ifndef _WIN32
+	return rename(from, to);
+#else
+	// _wrename fails if the target exists, so this must go through MoveFileEx.
+	auto wfrom = WideString(from);
+	auto wto = WideString(to);
+	return MoveFileExW(wfrom.c_str(), wto.c_str(), MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#endif
+}
+
+//==========================================================================
+//
+// WriteFileReplace
+//
+// Writes to a temporary file and renames it to the target when write
+// succeeds, so that readers never see a partially written file. The
+// temporary name is unique within the process so that several threads
+// can write the same file at once.
+//
+//==========================================================================
+
+bool WriteFileReplace(const char* filename, const std::function<bool(FileWriter*)>& write)
+{
+	static std::atomic<unsigned> tempcounter;
+
+	FString tempname;
+	tempname.Format("%s.%u.tmp", filename, tempcounter++);
+	FileWriter* fw = FileWriter::Open(tempname.GetChars());
+	if (fw == nullptr) return false;
+
+	bool ok = write(fw);
+	delete fw;
+	if (!ok || RenameFile(tempname.GetChars(), filename) != 0)
+	{
+		RemoveFile(tempname.GetChars());
+		return false;
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// GetCacheSubPath
+//
+// Returns a subdirectory of the cache path and creates it if needed.
+//
+//==========================================================================
+
+FString GetCacheSubPath(const char* subdir)
+{
+	FString path = M_GetCachePath(true) + "/" + subdir;
+	CreatePath(path.GetChars());
+	return path;
+}
+
 //==========================================================================
 //
 // strbin	-- In-place version
@@ -11,6 +11,7 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <time.h>
+#include <functional>
 #include "zstring.h"
 #include "files.h"
 
@@ -73,6 +74,9 @@ FString strbin1 (const char *start);
 void CreatePath(const char * fn);
 void RemoveFile(const char* file);
 int RemoveDir(const char* file);
+int RenameFile(const char* from, const char* to);
+bool WriteFileReplace(const char* filename, const std::function<bool(FileWriter*)>& write);
+FString GetCacheSubPath(const char* subdir);
 
 FString ExpandEnvVars(const char *searchpathstring);
 FString NicePath(const char *path);
@@ -210,6 +210,75 @@ void FMemArena::DumpData(FILE *f)
 	}
 }
 
+//==========================================================================
+//
+// FMemArena :: GetBlockUsage
+//
+// Returns the used size of each block, oldest block first.
+//
+//==========================================================================
+
+void FMemArena::GetBlockUsage(TArray<size_t> &usage) const
+{
+	usage.Clear();
+	for (auto block = TopBlock; block != NULL; block = block->NextBlock)
+	{
+		usage.Push((char*)block->Avail - (char*)block);
+	}
+	for (unsigned i = 0; i < usage.Size() / 2; i++)
+	{
+		std::swap(usage[i], usage[usage.Size() - 1 - i]);
+	}
+}
+
+//==========================================================================
+//
+// FMemArena :: GetLocation
+//
+// Converts an address into a block index, counted from the oldest block,
+// and an offset within that block.
+//
+//==========================================================================
+
+bool FMemArena::GetLocation(const void *ptr, unsigned &block, size_t &offset) const
+{
+	unsigned count = 0;
+	for (auto b = TopBlock; b != NULL; b = b->NextBlock) count++;
+
+	unsigned index = count;
+	for (auto b = TopBlock; b != NULL; b = b->NextBlock)
+	{
+		index--;
+		if (ptr >= (void*)b && ptr < b->Avail)
+		{
+			block = index;
+			offset = (char*)ptr - (char*)b;
+			return true;
+		}
+	}
+	return false;
+}
+
+//==========================================================================
+//
+// FMemArena :: GetAddress
+//
+// The inverse of GetLocation. Returns NULL if the location is not in use.
+//
+//==========================================================================
+
+void *FMemArena::GetAddress(unsigned block, size_t offset) const
+{
+	unsigned count = 0;
+	for (auto b = TopBlock; b != NULL; b = b->NextBlock) count++;
+	if (block >= count) return NULL;
+
+	auto b = TopBlock;
+	for (unsigned i = count - 1; i > block; i--) b = b->NextBlock;
+	char *addr = (char*)b + offset;
+	return addr < b->Avail ? addr : NULL;
+}
+
 //==========================================================================
 //
 // FMemArena :: FreeBlockChain
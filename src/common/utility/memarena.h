@@ -35,6 +35,7 @@
 #define __MEMARENA_H
 
 #include "zstring.h"
+#include "tarray.h"
 
 // A general purpose arena.
 class FMemArena
@@ -51,6 +52,11 @@ public:
 	FString DumpInfo();
 	void DumpData(FILE *f);
 
+	// Allows finding the same data again in a later session that performs the same sequence of allocations.
+	void GetBlockUsage(TArray<size_t> &usage) const;
+	bool GetLocation(const void *ptr, unsigned &block, size_t &offset) const;
+	void *GetAddress(unsigned block, size_t offset) const;
+
 protected:
 	struct Block;
 
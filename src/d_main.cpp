@@ -73,6 +73,7 @@
 #include "d_main.h"
 #include "d_dehacked.h"
 #include "cmdlib.h"
+#include "i_specialpaths.h"
 #include "v_text.h"
 #include "gi.h"
 #include "a_dynlight.h"
@@ -122,6 +123,8 @@
 #include "shiftstate.h"
 #include "common/widgets/errorwindow.h"
 #include "commandlets/commandlet.h"
+#include "profiler.h"
+#include "metrics.h"
 
 #ifdef __unix__
 #include "i_system.h"  // for SHARE_DIR
@@ -1263,6 +1266,7 @@ void D_DoomLoop ()
 	{
 		try
 		{
+			PROFILE_ZONE("Frame", "frame");
 			GStrings.SetDefaultGender(players[consoleplayer].userinfo.GetGender()); // cannot be done when the CVAR changes because we don't know if it's for the consoleplayer.
 
 			// frame syncronous IO operations
@@ -1273,7 +1277,10 @@ void D_DoomLoop ()
 			}
 			I_SetFrameTime();
 
+			FProfileSequence frame("frame");
+
 			// process one or more tics
+			frame.Next("Tics");
 			if (singletics)
 			{
 				D_SingleTick();
@@ -1283,10 +1290,15 @@ void D_DoomLoop ()
 				TryRunTics (); // will run at least one tic
 			}
 			// Update display, next frame, with current state.
+			frame.Next("Events");
 			I_StartTic ();
 			D_ProcessEvents();
+			frame.Next("D_Display");
 			D_Display ();
+			frame.Next("S_UpdateMusic");
 			S_UpdateMusic();
+			frame.Next(nullptr);
+			Metrics_EndFrame();
 			if (wantToRestart)
 			{
 				wantToRestart = false;
@@ -3139,6 +3151,9 @@ static int FileSystemPrintf(FSMessageLevel level, const char* fmt, ...)
 
 static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allwads, std::vector<std::string>& pwads)
 {
+	PROFILE_ZONE("D_InitGame", "startup");
+	FProfileSequence phase("startup");
+	phase.Next("D_DoomInit");
 	NetworkEntityManager::InitializeNetworkEntities();
 
 	if (!restart)
@@ -3195,6 +3210,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 		exec->AddPullins(allwads, GameConfig);
 	}
 
+	phase.Next("W_Init");
 	if (!batchrun && !RunningAsTool) Printf ("W_Init: Init WADfiles.\n");
 
 	LumpFilterInfo lfi;
@@ -3224,6 +3240,15 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 
 	GetReserved(lfi);
 
+	// Cache the parsed archive directories so that warm starts do not have to reprocess them.
+	if (!Args->CheckParm("-noindexcache"))
+	{
+		FString cachepath = M_GetCachePath(true);
+		cachepath << "/fsindex";
+		CreatePath(cachepath.GetChars());
+		lfi.indexCacheDir = cachepath.GetChars();
+	}
+
 	lfi.postprocessFunc = [&]()
 	{
 		RenameNerve(fileSystem);
@@ -3255,6 +3280,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 	D_GrabCVarDefaults(); //parse DEFCVARS
 	InitPalette();
 
+	phase.Next("S_Init");
 	if (!batchrun && !RunningAsTool) Printf("S_Init: Setting up sound.\n");
 	S_Init();
 
@@ -3287,6 +3313,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 		exec = NULL;
 	}
 
+	phase.Next("LoadStrings");
 	// [RH] Initialize localizable strings. 
 	GStrings.LoadStrings(fileSystem, language);
 
@@ -3306,6 +3333,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 		Printf("%s", ci.GetChars());
 	}
 
+	phase.Next("V_Init");
 	TexMan.Init();
 	
 	if (!batchrun && !RunningAsTool) Printf ("V_Init: allocate screen.\n");
@@ -3330,6 +3358,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 		compatmode = (int)strtoll(compatmodeval, nullptr, 10);
 	}
 
+	phase.Next("ST_Init");
 	if (!batchrun && !RunningAsTool) Printf ("ST_Init: Init startup screen.\n");
 	if (!restart)
 	{
@@ -3345,10 +3374,12 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 	// [RH] Load sound environments
 	S_ParseReverbDef ();
 
+	phase.Next("S_InitData");
 	// [RH] Parse any SNDINFO lumps
 	if (!batchrun && !RunningAsTool) Printf ("S_InitData: Load sound definitions.\n");
 	S_InitData ();
 
+	phase.Next("G_ParseMapInfo");
 	// [RH] Parse through all loaded mapinfo lumps
 	if (!batchrun && !RunningAsTool) Printf ("G_ParseMapInfo: Load map definitions.\n");
 	G_ParseMapInfo (iwad_info->MapInfo);
@@ -3360,6 +3391,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 	// MUSINFO must be parsed after MAPINFO
 	S_ParseMusInfo();
 
+	phase.Next("TexMan.AddTextures");
 	if (!batchrun && !RunningAsTool) Printf ("Texman.Init: Init texture manager.\n");
 	UpdateUpscaleMask();
 	SpriteFrames.Clear();
@@ -3376,15 +3408,18 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 
 	StartWindow->Progress(); 
 	if (StartScreen) StartScreen->Progress(1);
+	phase.Next("V_InitFonts");
 	V_InitFonts();
 	InitDoomFonts();
 	V_LoadTranslations();
 	UpdateGenericUI(false);
 
+	phase.Next("ParseTeamInfo");
 	// [CW] Parse any TEAMINFO lumps.
 	if (!batchrun && !RunningAsTool) Printf ("ParseTeamInfo: Load team definitions.\n");
 	FTeam::ParseTeamInfo ();
 
+	phase.Next("PClassActor::StaticInit");
 	R_ParseTrnslate();
 	PClassActor::StaticInit ();
 	FBaseCVar::InitZSCallbacks ();
@@ -3406,17 +3441,21 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 	StartWindow->Progress(); 
 	if (StartScreen) StartScreen->Progress (1);
 
+	phase.Next("ParseGLDefs");
 	ParseGLDefs();
 
+	phase.Next("R_Init");
 	if (!batchrun && !RunningAsTool) Printf ("R_Init: Init %s refresh subsystem.\n", gameinfo.ConfigName.GetChars());
 	if (StartScreen) StartScreen->LoadingStatus ("Loading graphics", 0x3f);
 	if (StartScreen) StartScreen->Progress(1);
 	StartWindow->Progress(); 
 	R_Init ();
 
+	phase.Next("DecalLibrary");
 	if (!batchrun && !RunningAsTool) Printf ("DecalLibrary: Load decals.\n");
 	DecalLibrary.ReadAllDecals ();
 
+	phase.Next("Dehacked");
 	auto numbasesounds = soundEngine->GetNumSounds();
 
 	// Load embedded Dehacked patches
@@ -3451,6 +3490,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 	auto numdehsounds = soundEngine->GetNumSounds();
 	if (numbasesounds < numdehsounds) S_LockLocalSndinfo(); // DSDHacked sounds are not compatible with map-local SNDINFOs.
 
+	phase.Next("M_Init");
 	if (!batchrun && !RunningAsTool) Printf("M_Init: Init menus.\n");
 	SetDefaultMenuColors();
 	M_Init();
@@ -3476,6 +3516,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 	primaryLevel->BotInfo.spawn_tries = 0;
 	primaryLevel->BotInfo.wanted_botnum = primaryLevel->BotInfo.getspawned.Size();
 
+	phase.Next("P_Init");
 	if (!batchrun && !RunningAsTool) Printf ("P_Init: Init Playloop state.\n");
 	if (StartScreen) StartScreen->LoadingStatus ("Init game engine", 0x3f);
 	AM_StaticInit();
@@ -3503,6 +3544,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 		}
 	}
 
+	phase.Next("D_CheckNetGame");
 	if (!restart)
 	{
 		if (!batchrun && !RunningAsTool) Printf ("D_CheckNetGame: Checking network game status.\n");
@@ -3513,6 +3555,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 		}
 	}
 
+	phase.Next("D_StartGame");
 	// [SP] Force vanilla transparency auto-detection to re-detect our game lumps now
 	UpdateVanillaTransparency();
 
@@ -3710,7 +3753,8 @@ int GameMain_Internal()
 		OkForLocalization,
 		[]() ->FConfigFile* { return GameConfig; },
 		nullptr, 
-		RemapUserTranslation
+		RemapUserTranslation,
+		[]() { return gametic; }
 	};
 
 	
@@ -3903,6 +3947,8 @@ int GameMain()
 	int ret = 0;
 	GameTicRate = TICRATE;
 	I_InitTime();
+	Profiler_Start(Args->CheckValue("-profiletrace"));
+	Metrics_Start(Args->CheckValue("-metrics"));
 
 	ConsoleCallbacks cb = {
 		D_UserInfoChanged,
@@ -3944,6 +3990,8 @@ int GameMain()
 	DeleteStartupScreen();
 	C_UninitCVars(); // must come last so that nothing will access the CVARs anymore after deletion.
 	CloseWidgetResources();
+	Metrics_Stop();
+	Profiler_Stop();
 	delete Args;
 	Args = nullptr;
 	return ret;
@@ -163,6 +163,9 @@ CUSTOM_CVAR(Int, net_extratic, 0, CVAR_SERVERINFO | CVAR_NOSAVE)
 	}
 }
 
+// Runs packets the local node sends to itself through packet compression to test it without a second machine.
+CVAR(Bool, net_checkloopback, false, 0);
+
 #ifdef _DEBUG
 CVAR(Int, net_fakelatency, 0, 0);
 
@@ -513,6 +516,10 @@ void HSendPacket (int node, int len)
 
 	if (node == 0)
 	{
+		if (net_checkloopback && !I_CheckLoopbackPacket (netbuffer, len))
+		{
+			Printf ("Loopback packet of %d bytes did not survive compression\n", len);
+		}
 		memcpy (reboundstore, netbuffer, len);
 		reboundpacket = len;
 		return;
@@ -524,6 +531,9 @@ void HSendPacket (int node, int len)
 	if (!netgame)
 		I_Error ("Tried to transmit to another node");
 
+	Net_CountSent (node, len);
+	Net_SimFlush ();
+
 #if SIMULATEERRORS
 	if (rand() < SIMULATEERRORS)
 	{
@@ -537,6 +547,9 @@ void HSendPacket (int node, int len)
 	doomcom.remotenode = node;
 	doomcom.datalength = len;
 
+	if (Net_SimSend ())
+		return;
+
 #ifdef _DEBUG
 	if (net_fakelatency / 2 > 0)
 	{
@@ -583,6 +596,7 @@ bool HGetPacket (void)
 	if (demoplayback)
 		return false;
 
+	Net_SimFlush ();
 	doomcom.command = CMD_GET;
 	I_NetCmd ();
 
@@ -682,6 +696,7 @@ bool HGetPacket (void)
 		return false;
 	}
 
+	Net_CountReceived (doomcom.remotenode, doomcom.datalength);
 	return true;		
 }
 
@@ -888,6 +903,7 @@ void GetPackets (void)
 		if (resendcount[netnode] <= 0 && (netbuffer[0] & NCMD_RETRANSMIT))
 		{
 			resendto[netnode] = ExpandTics (retransmitfrom);
+			Net_CountResend (netnode);
 			if (debugfile)
 				fprintf (debugfile,"retransmit from %i\n", resendto[netnode]);
 			resendcount[netnode] = RESENDCOUNT;
@@ -903,6 +919,7 @@ void GetPackets (void)
 						
 		if (realend < nettics[netnode])
 		{
+			Net_CountLate (netnode);
 			if (debugfile)
 				fprintf (debugfile, "out of order packet (%i + %i)\n" ,
 						 realstart, numtics);
@@ -916,6 +933,8 @@ void GetPackets (void)
 			if (debugfile)
 				fprintf (debugfile, "missed tics from %i (%i to %i)\n",
 						 netnode, nettics[netnode], realstart);
+			if (!remoteresend[netnode])
+				Net_CountMissed (netnode);
 			remoteresend[netnode] = true;
 			continue;
 		}
@@ -1760,6 +1779,7 @@ bool D_CheckNetGame (void)
 		playeringame[i] = true;
 	for (i = 0; i < doomcom.numnodes; i++)
 		nodeingame[i] = true;
+	Net_ResetStats ();
 
 	if (consoleplayer != Net_Arbitrator && doomcom.numnodes > 1)
 	{
@@ -1896,6 +1916,9 @@ void TryRunTics (void)
 	if (pauseext)
 		return;
 
+	if (demoplayback && G_RunDemoSeek())
+		return;
+
 	lowtic = INT_MAX;
 	numplaying = 0;
 	for (i = 0; i < doomcom.numnodes; i++)
@@ -1952,6 +1975,8 @@ void TryRunTics (void)
 				 realtics, availabletics, counts);
 
 	// wait for new tics if needed
+	uint64_t stallstart = I_msTime ();
+	bool stalled = false;
 	while (lowtic < gametic + counts)
 	{
 		NetUpdate ();
@@ -1971,11 +1996,16 @@ void TryRunTics (void)
 
 		// Update time returned by I_GetTime, but only if we are stuck in this loop
 		if (lowtic < gametic + counts)
+		{
 			I_SetFrameTime();
+			stalled = true;
+		}
 
 		// don't stay in here forever -- give the menu a chance to work
 		if (I_GetTime () - entertic >= 1)
 		{
+			if (stalled)
+				Net_CountStall (I_msTime () - stallstart);
 			C_Ticker ();
 			M_Ticker ();
 			// Repredict the player for new buffered movement
@@ -1984,6 +2014,8 @@ void TryRunTics (void)
 			return;
 		}
 	}
+	if (stalled)
+		Net_CountStall (I_msTime () - stallstart);
 
 	//Tic lowtic is high enough to process this gametic. Clear all possible waiting info
 	hadlate = false;
@@ -78,6 +78,17 @@ void Net_SkipCommand (int type, uint8_t **stream);
 
 void Net_ClearBuffers ();
 
+// Simulated network impairment and traffic statistics
+bool Net_SimSend ();
+void Net_SimFlush ();
+void Net_CountSent (int node, int len);
+void Net_CountReceived (int node, int len);
+void Net_CountResend (int node);
+void Net_CountMissed (int node);
+void Net_CountLate (int node);
+void Net_CountStall (uint64_t ms);
+void Net_ResetStats ();
+
 
 // Netgame stuff (buffers and pointers, i.e. indices).
 
@@ -0,0 +1,298 @@
+/*
+** d_netsim.cpp
+** Simulated network impairment and per node traffic statistics
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+
+#include "d_net.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "i_time.h"
+#include "printf.h"
+#include "tarray.h"
+
+//==========================================================================
+//
+// Outgoing game packets can be held back, dropped and reordered to test
+// how the lockstep code copes with a bad connection. Running several
+// instances on one machine over the loopback interface with these set
+// behaves like a real network of that quality. All values apply to the
+// packets this node sends, so every peer needs its own settings.
+//
+//==========================================================================
+
+CUSTOM_CVAR(Int, net_simlatency, 0, 0)		// one way, in ms
+{
+	if (self < 0) self = 0;
+}
+CUSTOM_CVAR(Int, net_simjitter, 0, 0)		// random extra delay, in ms
+{
+	if (self < 0) self = 0;
+}
+CUSTOM_CVAR(Float, net_simloss, 0.f, 0)		// percentage of packets that get lost
+{
+	if (self < 0) self = 0;
+	else if (self > 100) self = 100;
+}
+CUSTOM_CVAR(Float, net_simreorder, 0.f, 0)	// percentage of packets that arrive late
+{
+	if (self < 0) self = 0;
+	else if (self > 100) self = 100;
+}
+
+struct FSimPacket
+{
+	uint64_t Time;
+	uint32_t Order;
+	int Node;
+	TArray<uint8_t> Data;
+};
+
+static TArray<FSimPacket> SimQueue;
+static uint32_t SimOrder;
+static uint32_t SimSeed;
+
+struct FNetNodeStats
+{
+	uint64_t PacketsSent;
+	uint64_t BytesSent;
+	uint64_t PacketsReceived;
+	uint64_t BytesReceived;
+	uint64_t Resends;		// times this node asked us to send tics again
+	uint64_t Missed;		// times we had to ask this node for missing tics
+	uint64_t Late;			// duplicated or out of order packets from this node
+	uint64_t SimDropped;
+};
+
+static FNetNodeStats NodeStats[MAXNETNODES];
+static uint64_t StallCount;
+static uint64_t StallTime;
+static uint64_t StatsStart;
+
+//==========================================================================
+//
+// The simulation must not touch the game's random number generators,
+// or a peer with impairment would go out of sync.
+//
+//==========================================================================
+
+static double SimRandom()
+{
+	if (SimSeed == 0) SimSeed = uint32_t(I_msTime()) | 1;
+	SimSeed ^= SimSeed << 13;
+	SimSeed ^= SimSeed >> 17;
+	SimSeed ^= SimSeed << 5;
+	return SimSeed * (1. / 4294967296.);
+}
+
+//==========================================================================
+//
+// Net_SimSend
+//
+// Takes the packet in doomcom. Returns false if the simulation is off
+// and the packet has to be sent right away.
+//
+//==========================================================================
+
+bool Net_SimSend()
+{
+	if (net_simlatency <= 0 && net_simjitter <= 0 && net_simloss <= 0 && net_simreorder <= 0)
+	{
+		return false;
+	}
+	// Leaving the game must always get through so that nobody waits for a node that is gone.
+	if (doomcom.data[0] & NCMD_EXIT)
+	{
+		return false;
+	}
+
+	if (SimRandom() * 100 < net_simloss)
+	{
+		NodeStats[doomcom.remotenode].SimDropped++;
+		return true;
+	}
+
+	uint64_t delay = net_simlatency + uint64_t(SimRandom() * net_simjitter);
+	if (SimRandom() * 100 < net_simreorder)
+	{
+		// Late enough to be overtaken by the packets of the next tic or two.
+		delay += 2 * 1000 / TICRATE;
+	}
+
+	auto &packet = SimQueue[SimQueue.Reserve(1)];
+	packet.Time = I_msTime() + delay;
+	packet.Order = SimOrder++;
+	packet.Node = doomcom.remotenode;
+	packet.Data.Resize(doomcom.datalength);
+	memcpy(packet.Data.Data(), doomcom.data, doomcom.datalength);
+	return true;
+}
+
+//==========================================================================
+//
+// Net_SimFlush
+//
+// Sends every held back packet that is due, oldest first.
+//
+//==========================================================================
+
+void Net_SimFlush()
+{
+	if (SimQueue.Size() == 0)
+	{
+		return;
+	}
+
+	uint64_t now = I_msTime();
+	doomcom_t *saved = nullptr;
+	while (true)
+	{
+		unsigned next = SimQueue.Size();
+		for (unsigned i = 0; i < SimQueue.Size(); i++)
+		{
+			auto &p = SimQueue[i];
+			if (p.Time <= now && (next == SimQueue.Size() || p.Time < SimQueue[next].Time ||
+				(p.Time == SimQueue[next].Time && p.Order < SimQueue[next].Order)))
+			{
+				next = i;
+			}
+		}
+		if (next == SimQueue.Size())
+		{
+			break;
+		}
+
+		if (saved == nullptr)
+		{
+			saved = new doomcom_t(doomcom);
+		}
+		auto &packet = SimQueue[next];
+		doomcom.command = CMD_SEND;
+		doomcom.remotenode = packet.Node;
+		doomcom.datalength = packet.Data.Size();
+		memcpy(doomcom.data, packet.Data.Data(), packet.Data.Size());
+		I_NetCmd();
+		SimQueue.Delete(next);
+	}
+	if (saved != nullptr)
+	{
+		doomcom = *saved;
+		delete saved;
+	}
+}
+
+//==========================================================================
+//
+// Traffic statistics
+//
+//==========================================================================
+
+void Net_CountSent(int node, int len)
+{
+	NodeStats[node].PacketsSent++;
+	NodeStats[node].BytesSent += len;
+}
+
+void Net_CountReceived(int node, int len)
+{
+	NodeStats[node].PacketsReceived++;
+	NodeStats[node].BytesReceived += len;
+}
+
+void Net_CountResend(int node)
+{
+	NodeStats[node].Resends++;
+}
+
+void Net_CountMissed(int node)
+{
+	NodeStats[node].Missed++;
+}
+
+void Net_CountLate(int node)
+{
+	NodeStats[node].Late++;
+}
+
+void Net_CountStall(uint64_t ms)
+{
+	StallCount++;
+	StallTime += ms;
+}
+
+void Net_ResetStats()
+{
+	memset(NodeStats, 0, sizeof(NodeStats));
+	StallCount = StallTime = 0;
+	StatsStart = I_msTime();
+}
+
+//==========================================================================
+//
+// CCMD netstats
+//
+// Byte counts are packet sizes before compression.
+//
+//==========================================================================
+
+CCMD(netstats)
+{
+	if (argv.argc() > 1 && !stricmp(argv[1], "reset"))
+	{
+		Net_ResetStats();
+		return;
+	}
+	if (!netgame)
+	{
+		Printf("Not in a netgame\n");
+		return;
+	}
+
+	double seconds = max(uint64_t(1), I_msTime() - StatsStart) / 1000.;
+	Printf("node    sent  out B/s    recv   in B/s  resend  missed    late  simdrop\n");
+	for (int i = 1; i < doomcom.numnodes; i++)
+	{
+		auto &s = NodeStats[i];
+		Printf("%4d %7llu %8.0f %7llu %8.0f %7llu %7llu %7llu %8llu\n", i,
+			(unsigned long long)s.PacketsSent, s.BytesSent / seconds,
+			(unsigned long long)s.PacketsReceived, s.BytesReceived / seconds,
+			(unsigned long long)s.Resends, (unsigned long long)s.Missed,
+			(unsigned long long)s.Late, (unsigned long long)s.SimDropped);
+	}
+	Printf("%llu tic stalls, %llu ms waiting for the network over %.1f seconds\n",
+		(unsigned long long)StallCount, (unsigned long long)StallTime, seconds);
+	if (SimQueue.Size() > 0)
+	{
+		Printf("%u packets held back by the simulation\n", SimQueue.Size());
+	}
+}
@@ -265,6 +265,7 @@ void DNetworkBuffer::Serialize(FSerializer& arc)
 
 void EventManager::CallOnRegister()
 {
+	InvalidateSubscribers();
 	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
 	{
 		handler->OnRegister();
@@ -337,6 +338,7 @@ bool EventManager::RegisterHandler(DStaticEventHandler* handler)
 		handler->ObjectFlags |= OF_Transient;
 	}
 
+	InvalidateSubscribers();
 	return true;
 }
 
@@ -370,6 +372,7 @@ bool EventManager::UnregisterHandler(DStaticEventHandler* handler)
 		LastEventHandler = handler->prev;
 		GC::WriteBarrier(handler->prev);
 	}
+	InvalidateSubscribers();
 	if (handler->IsStatic())
 	{
 		handler->ObjectFlags &= ~OF_Transient;
@@ -633,6 +636,7 @@ void EventManager::Shutdown()
 		handler->Destroy();
 	}
 	FirstEventHandler = LastEventHandler = nullptr;
+	InvalidateSubscribers();
 }
 
 #define DEFINE_EVENT_LOOPER(name, play) void EventManager::name() \
@@ -642,6 +646,12 @@ void EventManager::Shutdown()
 		handler->name(); \
 }
 
+#define DEFINE_SUBSCRIBED_EVENT_LOOPER(name, play) void EventManager::name() \
+{ \
+	if (ShouldCallStatic(play)) staticEventManager.name(); \
+	ForEachSubscriber(ESUB_##name, [](DStaticEventHandler* handler) { handler->name(); }); \
+}
+
 void EventManager::OnEngineInitialize()
 {
 	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
@@ -685,8 +695,7 @@ void EventManager::WorldThingSpawned(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingSpawned(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingSpawned(actor);
+	ForEachSubscriber(ESUB_WorldThingSpawned, [&](DStaticEventHandler* handler) { handler->WorldThingSpawned(actor); });
 }
 
 void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
@@ -697,8 +706,7 @@ void EventManager::WorldThingDied(AActor* actor, AActor* inflictor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDied(actor, inflictor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDied(actor, inflictor);
+	ForEachSubscriber(ESUB_WorldThingDied, [&](DStaticEventHandler* handler) { handler->WorldThingDied(actor, inflictor); });
 }
 
 bool EventManager::WorldHitscanPreFired(AActor* actor, DAngle angle, double distance, DAngle pitch, int damage, FName damageType, PClassActor *pufftype, int flags, double sz, double offsetforward, double offsetside)
@@ -712,8 +720,10 @@ bool EventManager::WorldHitscanPreFired(AActor* actor, DAngle angle, double dist
 
 	if (!ret)
 	{
-		for (DStaticEventHandler* handler = FirstEventHandler; handler && ret == false; handler = handler->next)
-			ret = handler->WorldHitscanPreFired(actor, angle, distance, pitch, damage, damageType, pufftype, flags, sz, offsetforward, offsetside);
+		ForEachSubscriber(ESUB_WorldHitscanPreFired, [&](DStaticEventHandler* handler)
+		{
+			if (!ret) ret = handler->WorldHitscanPreFired(actor, angle, distance, pitch, damage, damageType, pufftype, flags, sz, offsetforward, offsetside);
+		});
 	}
 	
 	return ret;
@@ -733,8 +743,10 @@ bool EventManager::WorldRailgunPreFired(FName damageType, PClassActor* pufftype,
 
 	if (!ret)
 	{
-		for (DStaticEventHandler* handler = FirstEventHandler; handler && ret == false; handler = handler->next)
-			ret = handler->WorldRailgunPreFired(damageType, pufftype, param);
+		ForEachSubscriber(ESUB_WorldRailgunPreFired, [&](DStaticEventHandler* handler)
+		{
+			if (!ret) ret = handler->WorldRailgunPreFired(damageType, pufftype, param);
+		});
 	}
 
 	return ret;
@@ -748,8 +760,7 @@ void EventManager::WorldHitscanFired(AActor* actor, const DVector3& AttackPos, c
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldHitscanFired(actor, AttackPos, DamagePosition, Inflictor, flags);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldHitscanFired(actor, AttackPos, DamagePosition, Inflictor, flags);
+	ForEachSubscriber(ESUB_WorldHitscanFired, [&](DStaticEventHandler* handler) { handler->WorldHitscanFired(actor, AttackPos, DamagePosition, Inflictor, flags); });
 }
 
 void EventManager::WorldRailgunFired(AActor* actor, const DVector3& AttackPos, const DVector3& DamagePosition, AActor* Inflictor, int flags)
@@ -760,8 +771,7 @@ void EventManager::WorldRailgunFired(AActor* actor, const DVector3& AttackPos, c
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldRailgunFired(actor, AttackPos, DamagePosition, Inflictor, flags);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldRailgunFired(actor, AttackPos, DamagePosition, Inflictor, flags);
+	ForEachSubscriber(ESUB_WorldRailgunFired, [&](DStaticEventHandler* handler) { handler->WorldRailgunFired(actor, AttackPos, DamagePosition, Inflictor, flags); });
 }
 
 void EventManager::WorldThingGround(AActor* actor, FState* st)
@@ -772,8 +782,7 @@ void EventManager::WorldThingGround(AActor* actor, FState* st)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingGround(actor, st);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingGround(actor, st);
+	ForEachSubscriber(ESUB_WorldThingGround, [&](DStaticEventHandler* handler) { handler->WorldThingGround(actor, st); });
 }
 
 void EventManager::WorldThingRevived(AActor* actor)
@@ -784,8 +793,7 @@ void EventManager::WorldThingRevived(AActor* actor)
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingRevived(actor);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingRevived(actor);
+	ForEachSubscriber(ESUB_WorldThingRevived, [&](DStaticEventHandler* handler) { handler->WorldThingRevived(actor); });
 }
 
 void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* source, int damage, FName mod, int flags, DAngle angle)
@@ -796,8 +804,7 @@ void EventManager::WorldThingDamaged(AActor* actor, AActor* inflictor, AActor* s
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle);
+	ForEachSubscriber(ESUB_WorldThingDamaged, [&](DStaticEventHandler* handler) { handler->WorldThingDamaged(actor, inflictor, source, damage, mod, flags, angle); });
 }
 
 void EventManager::WorldThingDestroyed(AActor* actor)
@@ -810,8 +817,7 @@ void EventManager::WorldThingDestroyed(AActor* actor)
 	if (!(actor->ObjectFlags & OF_Spawned))
 		return;
 
-	for (DStaticEventHandler* handler = LastEventHandler; handler; handler = handler->prev)
-		handler->WorldThingDestroyed(actor);
+	ForEachSubscriberReverse(ESUB_WorldThingDestroyed, [&](DStaticEventHandler* handler) { handler->WorldThingDestroyed(actor); });
 
 	if (ShouldCallStatic(true)) staticEventManager.WorldThingDestroyed(actor);
 }
@@ -820,24 +826,21 @@ void EventManager::WorldLinePreActivated(line_t* line, AActor* actor, int activa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLinePreActivated(line, actor, activationType, shouldactivate);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLinePreActivated(line, actor, activationType, shouldactivate);
+	ForEachSubscriber(ESUB_WorldLinePreActivated, [&](DStaticEventHandler* handler) { handler->WorldLinePreActivated(line, actor, activationType, shouldactivate); });
 }
 
 void EventManager::WorldLineActivated(line_t* line, AActor* actor, int activationType)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineActivated(line, actor, activationType);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->WorldLineActivated(line, actor, activationType);
+	ForEachSubscriber(ESUB_WorldLineActivated, [&](DStaticEventHandler* handler) { handler->WorldLineActivated(line, actor, activationType); });
 }
 
 int EventManager::WorldSectorDamaged(sector_t* sector, AActor* source, int damage, FName damagetype, int part, DVector3 position, bool isradius)
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius);
+	ForEachSubscriber(ESUB_WorldSectorDamaged, [&](DStaticEventHandler* handler) { damage = handler->WorldSectorDamaged(sector, source, damage, damagetype, part, position, isradius); });
 	return damage;
 }
 
@@ -845,8 +848,7 @@ int EventManager::WorldLineDamaged(line_t* line, AActor* source, int damage, FNa
 {
 	if (ShouldCallStatic(true)) staticEventManager.WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius);
+	ForEachSubscriber(ESUB_WorldLineDamaged, [&](DStaticEventHandler* handler) { damage = handler->WorldLineDamaged(line, source, damage, damagetype, side, position, isradius); });
 	return damage;
 }
 
@@ -969,16 +971,14 @@ void EventManager::RenderOverlay(EHudState state)
 {
 	if (ShouldCallStatic(false)) staticEventManager.RenderOverlay(state);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->RenderOverlay(state);
+	ForEachSubscriber(ESUB_RenderOverlay, [&](DStaticEventHandler* handler) { handler->RenderOverlay(state); });
 }
 
 void EventManager::RenderUnderlay(EHudState state)
 {
 	if (ShouldCallStatic(false)) staticEventManager.RenderUnderlay(state);
 
-	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
-		handler->RenderUnderlay(state);
+	ForEachSubscriber(ESUB_RenderUnderlay, [&](DStaticEventHandler* handler) { handler->RenderUnderlay(state); });
 }
 
 bool EventManager::CheckUiProcessors()
@@ -1016,8 +1016,7 @@ bool EventManager::CheckReplacement( PClassActor *replacee, PClassActor **replac
 	// This is play scope but unlike in-game events needs to be handled like UI by static handlers.
 	if (ShouldCallStatic(false)) final = staticEventManager.CheckReplacement(replacee, replacement);
 
-	for (DStaticEventHandler *handler = FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacement(replacee,replacement,&final);
+	ForEachSubscriber(ESUB_CheckReplacement, [&](DStaticEventHandler* handler) { handler->CheckReplacement(replacee, replacement, &final); });
 	return final;
 }
 
@@ -1026,8 +1025,7 @@ bool EventManager::CheckReplacee(PClassActor **replacee, PClassActor *replacemen
 	bool final = false;
 	if (ShouldCallStatic(false)) final = staticEventManager.CheckReplacee(replacee, replacement);
 
-	for (DStaticEventHandler *handler = FirstEventHandler; handler; handler = handler->next)
-		handler->CheckReplacee(replacee, replacement, &final);
+	ForEachSubscriber(ESUB_CheckReplacee, [&](DStaticEventHandler* handler) { handler->CheckReplacee(replacee, replacement, &final); });
 	return final;
 }
 
@@ -1042,10 +1040,10 @@ void EventManager::NewGame()
 
 // normal event loopers (non-special, argument-less)
 DEFINE_EVENT_LOOPER(RenderFrame, false)
-DEFINE_EVENT_LOOPER(WorldLightning, true)
-DEFINE_EVENT_LOOPER(WorldTick, true)
-DEFINE_EVENT_LOOPER(UiTick, false)
-DEFINE_EVENT_LOOPER(PostUiTick, false)
+DEFINE_SUBSCRIBED_EVENT_LOOPER(WorldLightning, true)
+DEFINE_SUBSCRIBED_EVENT_LOOPER(WorldTick, true)
+DEFINE_SUBSCRIBED_EVENT_LOOPER(UiTick, false)
+DEFINE_SUBSCRIBED_EVENT_LOOPER(PostUiTick, false)
 
 // declarations
 IMPLEMENT_CLASS(DStaticEventHandler, false, true);
@@ -1701,6 +1699,80 @@ static bool isEmptyInt(VMFunction *func)
 	return (code == nullptr || code->word == (0x00048000|OP_RET));
 }
 
+//==========================================================================
+//
+// Collects the handlers that implement each subscribable event, in
+// handler order. Whether a class implements an event cannot change
+// after compilation, so this only needs redoing when the list changes.
+//
+//==========================================================================
+
+static const char* const SubscriptionNames[NUM_EVENT_SUBSCRIPTIONS] =
+{
+	"WorldThingSpawned",
+	"WorldThingDied",
+	"WorldThingGround",
+	"WorldThingRevived",
+	"WorldThingDamaged",
+	"WorldThingDestroyed",
+	"WorldHitscanPreFired",
+	"WorldRailgunPreFired",
+	"WorldHitscanFired",
+	"WorldRailgunFired",
+	"WorldLinePreActivated",
+	"WorldLineActivated",
+	"WorldSectorDamaged",
+	"WorldLineDamaged",
+	"WorldLightning",
+	"WorldTick",
+	"UiTick",
+	"PostUiTick",
+	"RenderOverlay",
+	"RenderUnderlay",
+	"CheckReplacement",
+	"CheckReplacee",
+};
+
+static bool Subscribes(DStaticEventHandler* handler, int event)
+{
+	static unsigned VIndex[NUM_EVENT_SUBSCRIPTIONS];
+	static bool indicesInitialized = false;
+	if (!indicesInitialized)
+	{
+		for (int i = 0; i < NUM_EVENT_SUBSCRIPTIONS; i++)
+		{
+			VIndex[i] = GetVirtualIndex(RUNTIME_CLASS(DStaticEventHandler), SubscriptionNames[i]);
+			assert(VIndex[i] != ~0u);
+		}
+		indicesInitialized = true;
+	}
+
+	auto clss = handler->GetClass();
+	VMFunction* func = clss->Virtuals.Size() > VIndex[event] ? clss->Virtuals[VIndex[event]] : nullptr;
+	return func != nullptr && !isEmpty(func);
+}
+
+void EventManager::BuildSubscribers()
+{
+	for (auto& list : Subscribers) list.Clear();
+	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+	{
+		for (int i = 0; i < NUM_EVENT_SUBSCRIPTIONS; i++)
+		{
+			if (Subscribes(handler, i)) Subscribers[i].Push(handler);
+		}
+	}
+	SubscribersValid = true;
+}
+
+void EventManager::CollectSubscribers(int event, TArray<DStaticEventHandler*>& list)
+{
+	for (DStaticEventHandler* handler = FirstEventHandler; handler; handler = handler->next)
+	{
+		if (Subscribes(handler, event)) list.Push(handler);
+	}
+}
+
 // ===========================================
 //
 //  Event handlers
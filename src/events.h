@@ -446,12 +446,47 @@ struct FReplacedEvent
 	bool IsFinal;
 };
 
+// Events that get dispatched through per-event subscriber lists.
+// Only handlers whose class implements the event are in the list, so events nobody listens to cost nothing.
+enum EEventSubscription
+{
+	ESUB_WorldThingSpawned,
+	ESUB_WorldThingDied,
+	ESUB_WorldThingGround,
+	ESUB_WorldThingRevived,
+	ESUB_WorldThingDamaged,
+	ESUB_WorldThingDestroyed,
+	ESUB_WorldHitscanPreFired,
+	ESUB_WorldRailgunPreFired,
+	ESUB_WorldHitscanFired,
+	ESUB_WorldRailgunFired,
+	ESUB_WorldLinePreActivated,
+	ESUB_WorldLineActivated,
+	ESUB_WorldSectorDamaged,
+	ESUB_WorldLineDamaged,
+	ESUB_WorldLightning,
+	ESUB_WorldTick,
+	ESUB_UiTick,
+	ESUB_PostUiTick,
+	ESUB_RenderOverlay,
+	ESUB_RenderUnderlay,
+	ESUB_CheckReplacement,
+	ESUB_CheckReplacee,
+
+	NUM_EVENT_SUBSCRIPTIONS
+};
+
 struct EventManager
 {
 	FLevelLocals *Level = nullptr;
 	DStaticEventHandler* FirstEventHandler = nullptr;
 	DStaticEventHandler* LastEventHandler = nullptr;
 
+	// Built from the handler list on first use after it changed. Savegames write the list directly, so this cannot be done in RegisterHandler alone.
+	TArray<DStaticEventHandler*> Subscribers[NUM_EVENT_SUBSCRIPTIONS];
+	bool SubscribersValid = false;
+	int DispatchDepth = 0;	// the lists must not be rebuilt while they are being iterated
+
 	EventManager() = default;
 	EventManager(FLevelLocals *l) { Level = l; }
 	~EventManager() { Shutdown(); }
@@ -567,6 +602,63 @@ struct EventManager
 		{
 			existinghandler->owner = this;
 		}
+		InvalidateSubscribers();
+	}
+
+	// subscriber lists
+	void InvalidateSubscribers() { SubscribersValid = false; }
+	void BuildSubscribers();
+	void CollectSubscribers(int event, TArray<DStaticEventHandler*>& list);
+
+	// Callbacks may register or remove handlers. The lists only get rebuilt once no dispatch
+	// is running, so an outer dispatch keeps iterating the list it started with. A dispatch that
+	// starts while they are out of date uses a private copy instead. While out of date, handlers
+	// that are no longer registered get skipped.
+	struct FDispatchScope
+	{
+		EventManager* Manager;
+		TArray<DStaticEventHandler*> Rebuilt;
+		const TArray<DStaticEventHandler*>* List;
+
+		FDispatchScope(EventManager* manager, int event) : Manager(manager)
+		{
+			if (!Manager->SubscribersValid && Manager->DispatchDepth == 0) Manager->BuildSubscribers();
+			if (Manager->SubscribersValid) List = &Manager->Subscribers[event];
+			else
+			{
+				Manager->CollectSubscribers(event, Rebuilt);
+				List = &Rebuilt;
+			}
+			Manager->DispatchDepth++;
+		}
+		~FDispatchScope()
+		{
+			Manager->DispatchDepth--;
+		}
+		bool ShouldCall(DStaticEventHandler* handler)
+		{
+			return !(handler->ObjectFlags & OF_EuthanizeMe) && (Manager->SubscribersValid || Manager->CheckHandler(handler));
+		}
+	};
+
+	template<class Func> void ForEachSubscriber(int event, Func func)
+	{
+		FDispatchScope scope(this, event);
+		auto& list = *scope.List;
+		for (unsigned i = 0; i < list.Size(); i++)
+		{
+			if (scope.ShouldCall(list[i])) func(list[i]);
+		}
+	}
+
+	template<class Func> void ForEachSubscriberReverse(int event, Func func)
+	{
+		FDispatchScope scope(this, event);
+		auto& list = *scope.List;
+		for (unsigned i = list.Size(); i-- > 0; )
+		{
+			if (scope.ShouldCall(list[i])) func(list[i]);
+		}
 	}
 
 };
@@ -0,0 +1,332 @@
+/*
+** g_demoseek.cpp
+** Keyframe snapshots for seeking during demo playback
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#include "doomstat.h"
+#include "g_game.h"
+#include "g_levellocals.h"
+#include "d_net.h"
+#include "d_event.h"
+#include "d_player.h"
+#include "c_dispatch.h"
+#include "c_cvars.h"
+#include "i_time.h"
+#include "m_random.h"
+#include "p_acs.h"
+#include "p_local.h"
+#include "p_saveg.h"
+#include "s_soundinternal.h"
+#include "serializer_doom.h"
+#include "dobjgc.h"
+#include "version.h"
+
+// While a demo plays, the level is periodically serialized into compressed
+// memory buffers. Seeking restores the closest keyframe before the target
+// and runs the remaining tics without drawing anything, so jumping around
+// in a long demo does not require replaying it from the start.
+
+CVAR(Int, demo_keyframeinterval, 0, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// seconds between keyframes, 0 disables them
+CVAR(Int, demo_maxkeyframes, 64, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+extern uint8_t *demobuffer;
+extern uint8_t *demo_p;
+extern uint8_t globalfreeze;
+extern bool savegamerestore;
+extern bool timingdemo;
+void C_SerializeCVars(FSerializer& arc, const char* label, uint32_t filter);
+
+struct FDemoKeyframe
+{
+	int DemoTic;
+	ptrdiff_t DemoOffset;
+	FString MapName;
+	FCompressedBuffer Level;
+	FCompressedBuffer Globals;
+};
+
+static TArray<FDemoKeyframe> DemoKeyframes;
+static int DemoTic;				// number of tics played since the demo started
+static int KeyframeInterval;	// in tics, doubles every time the keyframe list gets thinned out
+static int DemoSeekTarget = -1;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void FreeKeyframe(FDemoKeyframe &key)
+{
+	key.Level.Clean();
+	key.Globals.Clean();
+}
+
+void G_ClearDemoKeyframes()
+{
+	for (auto &key : DemoKeyframes) FreeKeyframe(key);
+	DemoKeyframes.Clear();
+	DemoTic = 0;
+	KeyframeInterval = 0;
+	DemoSeekTarget = -1;
+}
+
+//==========================================================================
+//
+// Keeps the memory bounded by dropping every other keyframe once the
+// limit is reached. The spacing of all future keyframes doubles.
+//
+//==========================================================================
+
+static void ThinKeyframes()
+{
+	unsigned out = 0;
+	for (unsigned i = 0; i < DemoKeyframes.Size(); i++)
+	{
+		if (i & 1)
+		{
+			FreeKeyframe(DemoKeyframes[i]);
+			continue;
+		}
+		if (out != i) DemoKeyframes[out] = std::move(DemoKeyframes[i]);
+		out++;
+	}
+	DemoKeyframes.Clamp(out);
+	KeyframeInterval *= 2;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool WriteKeyframe(FDemoKeyframe &key)
+{
+	FDoomSerializer arc(primaryLevel);
+	FSerializer globals;
+
+	if (!arc.OpenWriter(false) || !globals.OpenWriter(false))
+		return false;
+
+	SaveVersion = SAVEVER;
+	primaryLevel->Serialize(arc, false);
+
+	C_SerializeCVars(globals, "servercvars", CVAR_SERVERINFO);
+	globals("leveltime", primaryLevel->time)
+		("globalfreeze", globalfreeze)
+		.Array("playeringame", playeringame, MAXPLAYERS);
+	FRandom::StaticWriteRNGState(globals);
+	P_WriteACSVars(globals);
+
+	key.DemoTic = DemoTic;
+	key.DemoOffset = demo_p - demobuffer;
+	key.MapName = primaryLevel->MapName;
+	key.Level = arc.GetCompressedOutput();
+	key.Globals = globals.GetCompressedOutput();
+	return true;
+}
+
+//==========================================================================
+//
+// Restores a keyframe the same way G_DoLoadGame restores a savegame.
+// Lines, sides and sectors are only stored where they differ from the
+// freshly loaded map, so the map has to be loaded again before the
+// keyframe can be applied to it.
+//
+//==========================================================================
+
+static void ReadKeyframe(FDemoKeyframe &key)
+{
+	FSerializer globals;
+	if (!globals.OpenReader(&key.Globals))
+		I_Error("Failed to read demo keyframe");
+
+	int leveltime = 0;
+	C_SerializeCVars(globals, "servercvars", CVAR_SERVERINFO);
+	globals("leveltime", leveltime)
+		("globalfreeze", globalfreeze)
+		.Array("playeringame", playeringame, MAXPLAYERS);
+
+	// G_DoLoadLevel picks the level up from its snapshot and discards the snapshot afterward.
+	auto info = FindLevelInfo(key.MapName.GetChars());
+	auto &snapshot = info->Snapshot;
+	snapshot.Clean();
+	snapshot = key.Level;
+	snapshot.mBuffer = new char[key.Level.mCompressedSize];
+	memcpy(snapshot.mBuffer, key.Level.mBuffer, key.Level.mCompressedSize);
+
+	bool demoplaybacksave = demoplayback;
+	bool usergamesave = usergame;
+	savegamerestore = true;
+	primaryLevel->time = leveltime;
+	G_InitNew(key.MapName.GetChars(), false);
+	demoplayback = demoplaybacksave;
+	usergame = usergamesave;
+	savegamerestore = false;
+
+	FRandom::StaticReadRNGState(globals);
+	P_ReadACSVars(globals);
+	globals.Close();
+
+	demo_p = demobuffer + key.DemoOffset;
+	DemoTic = key.DemoTic;
+}
+
+//==========================================================================
+//
+// Called by G_Ticker right before the commands for the current tic are
+// read from the demo.
+//
+//==========================================================================
+
+void G_DemoKeyframeTic()
+{
+	if (!demoplayback || demobuffer == nullptr)
+		return;
+
+	// Keyframes would only skew the measurement.
+	if (timingdemo)
+	{
+		DemoTic++;
+		return;
+	}
+
+	if (KeyframeInterval == 0)
+		KeyframeInterval = demo_keyframeinterval * TICRATE;
+
+	if (KeyframeInterval > 0 && gamestate == GS_LEVEL && gameaction == ga_nothing &&
+		primaryLevel->sectors.Size() > 0 && (DemoKeyframes.Size() == 0 || DemoTic >= DemoKeyframes.Last().DemoTic + KeyframeInterval))
+	{
+		if (DemoKeyframes.Size() >= (unsigned)max<int>(demo_maxkeyframes, 2))
+		{
+			ThinKeyframes();
+		}
+		FDemoKeyframe key = {};
+		try
+		{
+			if (WriteKeyframe(key)) DemoKeyframes.Push(std::move(key));
+		}
+		catch (CRecoverableError &err)
+		{
+			FreeKeyframe(key);
+			Printf("Failed to create demo keyframe: %s\n", err.GetMessage());
+			KeyframeInterval = -1;
+		}
+	}
+	DemoTic++;
+}
+
+//==========================================================================
+//
+// Performs a pending seek. Called by TryRunTics before it runs the
+// regular tics. Returns true if it did anything.
+//
+//==========================================================================
+
+bool G_RunDemoSeek()
+{
+	if (DemoSeekTarget < 0)
+		return false;
+
+	int target = DemoSeekTarget;
+	DemoSeekTarget = -1;
+	if (!demoplayback || target == DemoTic)
+		return false;
+
+	// Find the last keyframe before the target that is on the current level.
+	// Going forward it is only worth it if the keyframe is ahead of the current position.
+	FDemoKeyframe *best = nullptr;
+	for (auto &key : DemoKeyframes)
+	{
+		if (key.DemoTic > target) break;
+		if (key.MapName.CompareNoCase(primaryLevel->MapName) == 0 && (target < DemoTic || key.DemoTic > DemoTic))
+			best = &key;
+	}
+	if (best == nullptr && target < DemoTic)
+	{
+		Printf("No demo keyframe to seek back to on this level.\n");
+		return false;
+	}
+
+	I_FreezeTime(true);
+	soundEngine->BlockNewSounds(true);
+	P_UnPredictPlayer();
+
+	if (best != nullptr)
+	{
+		ReadKeyframe(*best);
+	}
+
+	// Run the remaining tics with nothing being drawn in between.
+	// gametic and maketic need to advance together so that the network
+	// code does not try to catch up on the skipped tics afterward.
+	while (demoplayback && DemoTic < target)
+	{
+		G_Ticker();
+		gametic++;
+		maketic++;
+	}
+
+	soundEngine->BlockNewSounds(false);
+	P_PredictPlayer(&players[consoleplayer]);
+	I_FreezeTime(false);
+
+	GC::StartCollection();
+	return true;
+}
+
+//==========================================================================
+//
+// demoseek <seconds>, demoseek +<seconds>, demoseek -<seconds>
+//
+//==========================================================================
+
+CCMD(demoseek)
+{
+	if (!demoplayback)
+	{
+		Printf("Not playing a demo.\n");
+		return;
+	}
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: demoseek [+|-]seconds\nCurrent position: %.1f seconds\n", DemoTic / double(TICRATE));
+		return;
+	}
+
+	const char *arg = argv[1];
+	int tics = int(atof(arg) * TICRATE);
+	if (*arg == '+' || *arg == '-') tics += DemoTic;
+	DemoSeekTarget = max(tics, 0);
+}
@@ -91,11 +91,14 @@
 #include "screenjob.h"
 #include "i_interface.h"
 #include "fs_findfile.h"
+#include "metrics.h"
 
 
 static FRandom pr_dmspawn ("DMSpawn");
 static FRandom pr_pspawn ("PlayerSpawn");
 
+static FHistogramMetric TicTime("playsim.tic_ms", METRIC_Tic, { 1, 2, 4, 8, 16, 28.6, 57.1 });
+
 extern int startpos, laststartpos;
 
 bool WriteZip(const char* filename, const FileSys::FCompressedBuffer* content, size_t contentcount);
@@ -1141,6 +1144,7 @@ void G_Ticker ()
 {
 	int i;
 	gamestate_t	oldgamestate;
+	uint64_t ticstart = MetricsActive ? I_nsTime() : 0;
 
 	// do player reborns if needed
 	for (i = 0; i < MAXPLAYERS; i++)
@@ -1250,6 +1254,8 @@ void G_Ticker ()
 		C_AdjustBottom ();
 	}
 
+	G_DemoKeyframeTic();
+
 	// get commands, check consistancy, and build new consistancy check
 	int buf = (gametic/ticdup)%BACKUPTICS;
 
@@ -1359,6 +1365,12 @@ void G_Ticker ()
 
 	// [MK] Additional ticker for UI events right after all others
 	primaryLevel->localEventManager->PostUiTick();
+
+	if (MetricsActive)
+	{
+		TicTime.Record((I_nsTime() - ticstart) / 1e6);
+		Metrics_EndTic();
+	}
 }
 
 
@@ -2690,6 +2702,7 @@ void G_BeginRecording (const char *startmap)
 	}
 
 	// Write cvars chunk
+	P_ActorSleepBeginRecording();
 	StartChunk (VARS_ID, &demo_p);
 	C_WriteCVars (&demo_p, CVAR_SERVERINFO|CVAR_DEMOSAVE);
 	FinishChunk (&demo_p);
@@ -2763,6 +2776,7 @@ bool G_ProcessIFFDemo (FString &mapname)
 	uint8_t *nextchunk;
 
 	demoplayback = true;
+	P_ActorSleepBeginPlayback();
 
 	for (i = 0; i < MAXPLAYERS; i++)
 		playeringame[i] = 0;
@@ -2936,6 +2950,7 @@ void G_DoPlayDemo (void)
 		}
 	}
 	demo_p = demobuffer;
+	G_ClearDemoKeyframes();
 
 	if (singledemo) Printf ("Playing demo %s\n", defdemoname.GetChars());
 
@@ -3030,6 +3045,7 @@ bool G_CheckDemoStatus (void)
 		C_RestoreCVars ();		// [RH] Restore cvars demo might have changed
 		M_Free (demobuffer);
 		demobuffer = NULL;
+		G_ClearDemoKeyframes();
 
 		P_SetupWeapons_ntohton();
 		demoplayback = false;
@@ -3075,6 +3091,7 @@ bool G_CheckDemoStatus (void)
 	{
 		uint8_t *formlen;
 
+		P_ActorSleepEndRecording();
 		WriteInt8 (DEM_STOP, &demo_p);
 
 		if (demo_compress)
@@ -77,6 +77,11 @@ void G_PlayDemo (char* name);
 void G_TimeDemo (const char* name);
 bool G_CheckDemoStatus (void);
 
+// Keyframes for seeking in demos, see g_demoseek.cpp.
+void G_ClearDemoKeyframes();
+void G_DemoKeyframeTic();
+bool G_RunDemoSeek();
+
 void G_Ticker (void);
 bool G_Responder (event_t*	ev);
 
@@ -306,6 +306,8 @@ void ST_CreateStatusBar(bool bTitleLevel)
 		StatusBar->Destroy();
 		StatusBar = NULL;
 	}
+	// Layers recorded by the old status bar are of no use to the new one.
+	twod->ClearCachedLayers();
 	GC::AddMarkerFunc([]() { GC::Mark(StatusBar); });
 
 	bool shouldWarn = true;
@@ -87,6 +87,7 @@
 #include "fs_decompress.h"
 
 #include "common/utility/halffloat.h"
+#include "profiler.h"
 
 enum
 {
@@ -3011,7 +3012,10 @@ void MapLoader::InitLevelMesh(MapData* map)
 	}
 
 	// Create the levelmesh
-	Level->levelMesh = new DoomLevelMesh(*Level);
+	{
+		PROFILE_ZONE("DoomLevelMesh", "mapload");
+		Level->levelMesh = new DoomLevelMesh(*Level);
+	}
 
 	// Lightmap binding/loading
 	if (!LoadLightmap(map))
@@ -3195,6 +3199,7 @@ bool MapLoader::LoadLightmap(MapData* map)
 
 void MapLoader::LoadLevel(MapData *map, const char *lumpname, int position)
 {
+	FProfileZone zone("MapLoader::LoadLevel", "mapload", lumpname);
 	SetNullLevelMeshUpdater();
 
 	const int *oldvertextable  = nullptr;
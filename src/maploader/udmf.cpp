@@ -204,7 +204,7 @@ void UDMFParserBase::Skip()
 FName UDMFParserBase::ParseKey(bool checkblock, bool *isblock)
 {
 	sc.MustGetString();
-	FName key = sc.String;
+	FName key = sc.GetName();
 	if (checkblock)
 	{
 		if (sc.CheckToken('{'))
@@ -2655,6 +2655,18 @@ public:
 			Printf("Map does not define a namespace.\n");
 		}
 
+		// Size all arrays up front so that large maps do not keep reallocating them.
+		static const char *const blocknames[] = { "thing", "linedef", "sidedef", "sector", "vertex", nullptr };
+		unsigned blockcounts[5];
+		sc.CountBlocks(blocknames, blockcounts);
+		loader->MapThingsConverted.Grow(blockcounts[0]);
+		ParsedLines.Grow(blockcounts[1]);
+		ParsedSides.Grow(blockcounts[2]);
+		ParsedSideTextures.Grow(blockcounts[2]);
+		ParsedSectors.Grow(blockcounts[3]);
+		ParsedVertices.Grow(blockcounts[4]);
+		loader->vertexdatas.Grow(blockcounts[4]);
+
 		while (sc.GetString())
 		{
 			if (sc.Compare("thing"))
@@ -1,13 +1,13 @@
 #ifndef __P_UDMF_H
 #define __P_UDMF_H
 
-#include "sc_man.h"
+#include "udmfscanner.h"
 #include "m_fixed.h"
 
 class UDMFParserBase
 {
 protected:
-	FScanner sc;
+	FUDMFScanner sc;
 	FName namespc = NAME_None;
 	int namespace_bits;
 	FString parsedString;
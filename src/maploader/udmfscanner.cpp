@@ -0,0 +1,581 @@
+/*
+** udmfscanner.cpp
+** Fast tokenizer for UDMF map and dialogue text
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#include <stdarg.h>
+#include "udmfscanner.h"
+#include "cmdlib.h"
+#include "engineerrors.h"
+#include "printf.h"
+#include "v_text.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+#define UDMF_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+enum
+{
+	CHAR_Space = 1,
+	CHAR_IdentStart = 2,
+	CHAR_Ident = 4,
+	CHAR_Digit = 8,
+};
+
+static uint8_t CharClass[256];
+
+static void InitCharClasses()
+{
+	if (CharClass['a'] != 0) return;
+	for (int c = 0; c <= ' '; c++) CharClass[c] = CHAR_Space;
+	for (int c = 'a'; c <= 'z'; c++) CharClass[c] = CHAR_IdentStart | CHAR_Ident;
+	for (int c = 'A'; c <= 'Z'; c++) CharClass[c] = CHAR_IdentStart | CHAR_Ident;
+	for (int c = '0'; c <= '9'; c++) CharClass[c] = CHAR_Ident | CHAR_Digit;
+	CharClass['_'] = CHAR_IdentStart | CHAR_Ident;
+}
+
+#ifdef UDMF_SSE2
+static inline int FirstSetBit(unsigned mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static inline int CountBits(unsigned mask)
+{
+#ifdef _MSC_VER
+	return (int)__popcnt(mask);
+#else
+	return __builtin_popcount(mask);
+#endif
+}
+#endif
+
+//==========================================================================
+//
+// The buffer gets 16 bytes of padding so that the whitespace skipper
+// may always load full vectors.
+//
+//==========================================================================
+
+void FUDMFScanner::OpenMem(const char *name, TArray<uint8_t> &&buffer)
+{
+	InitCharClasses();
+	ScriptName = name;
+	Buffer = std::move(buffer);
+	unsigned size = Buffer.Size();
+	Buffer.Resize(size + 16);
+	memset(&Buffer[size], 0, 16);
+
+	Pos = LastPos = TokenStart = (const char *)Buffer.Data();
+	End = Pos + size;
+	Line = LastLine = 1;
+	TokenType = 0;
+	String = "";
+	StringLen = 0;
+	NameCache.Clear();
+	NameCache.Resize(NAME_CACHE_SIZE);
+	memset(NameCache.Data(), 0, NameCache.Size() * sizeof(FNameCacheEntry));
+	NameCacheUsed = 0;
+}
+
+//==========================================================================
+//
+// Whitespace runs in TEXTMAPs are mostly indentation, newlines and
+// blank lines, so they get skipped 16 bytes at a time where possible.
+// Comment and string bodies are searched with memchr.
+//
+//==========================================================================
+
+void FUDMFScanner::SkipWhitespace()
+{
+	const char *p = Pos;
+	while (p < End)
+	{
+#ifdef UDMF_SSE2
+		if (CharClass[(uint8_t)*p] & CHAR_Space)
+		{
+			const __m128i space = _mm_set1_epi8(' ' + 1);
+			const __m128i newline = _mm_set1_epi8('\n');
+			const __m128i signbit = _mm_set1_epi8((char)0x80);
+			while (p < End)
+			{
+				__m128i chars = _mm_loadu_si128((const __m128i *)p);
+				// unsigned chars <= ' ', done as a signed compare on the sign flipped values.
+				__m128i ws = _mm_cmplt_epi8(_mm_xor_si128(chars, signbit), _mm_xor_si128(space, signbit));
+				unsigned wsmask = _mm_movemask_epi8(ws);
+				unsigned nlmask = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, newline));
+				int avail = int(End - p);
+				if (avail < 16)
+				{
+					// The padding is zero and would count as whitespace.
+					wsmask &= (1u << avail) - 1;
+					nlmask &= (1u << avail) - 1;
+				}
+				if (wsmask == 0xffff)
+				{
+					Line += CountBits(nlmask);
+					p += 16;
+					continue;
+				}
+				int count = FirstSetBit(~wsmask);
+				Line += CountBits(nlmask & ((1u << count) - 1));
+				p += count;
+				break;
+			}
+			continue;
+		}
+#else
+		if (CharClass[(uint8_t)*p] & CHAR_Space)
+		{
+			if (*p == '\n') Line++;
+			p++;
+			continue;
+		}
+#endif
+		if (*p == '/' && p + 1 < End)
+		{
+			if (p[1] == '/')
+			{
+				p = (const char *)memchr(p, '\n', End - p);
+				if (p == nullptr) p = End;
+				continue;
+			}
+			else if (p[1] == '*')
+			{
+				const char *start = p + 2;
+				p = start;
+				while (true)
+				{
+					p = (const char *)memchr(p, '*', End - p);
+					if (p == nullptr || p + 1 >= End)
+					{
+						p = End;
+						break;
+					}
+					if (p[1] == '/')
+					{
+						p += 2;
+						break;
+					}
+					p++;
+				}
+				for (const char *c = start; (c = (const char *)memchr(c, '\n', p - c)) != nullptr; c++) Line++;
+				continue;
+			}
+		}
+		break;
+	}
+	Pos = p;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FUDMFScanner::SetString(const char *start, int len)
+{
+	if (StringBuffer.Size() < unsigned(len + 1)) StringBuffer.Resize(len + 1);
+	memcpy(StringBuffer.Data(), start, len);
+	StringBuffer[len] = 0;
+	String = StringBuffer.Data();
+	StringLen = len;
+}
+
+void FUDMFScanner::ParseNumber(const char *start, int len, bool isfloat)
+{
+	if (isfloat)
+	{
+		SetString(start, len);
+		Float = strtod(String, nullptr);
+		Number = (int)Float;
+		TokenType = TK_FloatConst;
+		return;
+	}
+
+	// Plain decimal numbers are by far the most common so they skip the generic conversion.
+	if (start[0] != '0' && len < 10)
+	{
+		int value = 0;
+		for (int i = 0; i < len; i++) value = value * 10 + (start[i] - '0');
+		Number = value;
+		SetString(start, len);
+	}
+	else
+	{
+		SetString(start, len);
+		Number = (int)strtoll(String, nullptr, 0);
+	}
+	Float = Number;
+	TokenType = TK_IntConst;
+}
+
+void FUDMFScanner::ParseQuotedString(const char *start, int len)
+{
+	SetString(start, len);
+	if (memchr(start, '\\', len) != nullptr)
+	{
+		StringLen = strbin(StringBuffer.Data());
+	}
+	TokenType = TK_StringConst;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+bool FUDMFScanner::GetToken()
+{
+	LastPos = Pos;
+	LastLine = Line;
+	SkipWhitespace();
+	if (Pos >= End)
+	{
+		TokenType = 0;
+		String = "";
+		StringLen = 0;
+		return false;
+	}
+
+	const char *p = Pos;
+	TokenStart = p;
+	uint8_t cls = CharClass[(uint8_t)*p];
+
+	if (cls & CHAR_IdentStart)
+	{
+		do p++; while (p < End && (CharClass[(uint8_t)*p] & CHAR_Ident));
+		int len = int(p - TokenStart);
+		SetString(TokenStart, len);
+		TokenType = TK_Identifier;
+		if (len == 4 && !strnicmp(TokenStart, "true", 4)) TokenType = TK_True;
+		else if (len == 5 && !strnicmp(TokenStart, "false", 5)) TokenType = TK_False;
+	}
+	else if ((cls & CHAR_Digit) || (*p == '.' && p + 1 < End && (CharClass[(uint8_t)p[1]] & CHAR_Digit)))
+	{
+		bool isfloat = false;
+		if (p[0] == '0' && p + 1 < End && (p[1] == 'x' || p[1] == 'X'))
+		{
+			p += 2;
+			while (p < End && isxdigit((uint8_t)*p)) p++;
+		}
+		else
+		{
+			while (p < End && (CharClass[(uint8_t)*p] & CHAR_Digit)) p++;
+			if (p < End && *p == '.')
+			{
+				isfloat = true;
+				p++;
+				while (p < End && (CharClass[(uint8_t)*p] & CHAR_Digit)) p++;
+			}
+			if (p < End && (*p == 'e' || *p == 'E'))
+			{
+				const char *exp = p + 1;
+				if (exp < End && (*exp == '+' || *exp == '-')) exp++;
+				if (exp < End && (CharClass[(uint8_t)*exp] & CHAR_Digit))
+				{
+					isfloat = true;
+					p = exp;
+					while (p < End && (CharClass[(uint8_t)*p] & CHAR_Digit)) p++;
+				}
+			}
+		}
+		ParseNumber(TokenStart, int(p - TokenStart), isfloat);
+	}
+	else if (*p == '"')
+	{
+		const char *start = p + 1;
+		const char *q = start;
+		while (true)
+		{
+			q = (const char *)memchr(q, '"', End - q);
+			if (q == nullptr)
+			{
+				Pos = End;
+				ScriptError("Unterminated string constant");
+				return false;
+			}
+			// An odd number of backslashes means the quote is escaped.
+			int slashes = 0;
+			for (const char *b = q - 1; b >= start && *b == '\\'; b--) slashes++;
+			if (!(slashes & 1)) break;
+			q++;
+		}
+		for (const char *c = start; (c = (const char *)memchr(c, '\n', q - c)) != nullptr; c++) Line++;
+		ParseQuotedString(start, int(q - start));
+		p = q + 1;
+	}
+	else
+	{
+		SetString(p, 1);
+		TokenType = (uint8_t)*p;
+		p++;
+	}
+	Pos = p;
+	return true;
+}
+
+void FUDMFScanner::UnGet()
+{
+	Pos = LastPos;
+	Line = LastLine;
+}
+
+void FUDMFScanner::MustGetAnyToken()
+{
+	if (!GetToken())
+	{
+		ScriptError("Missing token (unexpected end of file).");
+	}
+}
+
+void FUDMFScanner::TokenMismatch(int token)
+{
+	FString tok1 = FScanner::TokenName(token);
+	FString tok2 = FScanner::TokenName(TokenType, String);
+	ScriptError("Expected %s but got %s instead.", tok1.GetChars(), tok2.GetChars());
+}
+
+bool FUDMFScanner::CheckToken(int token)
+{
+	if (GetToken())
+	{
+		if (TokenType == token) return true;
+		UnGet();
+	}
+	return false;
+}
+
+void FUDMFScanner::MustGetToken(int token)
+{
+	MustGetAnyToken();
+	if (TokenType != token) TokenMismatch(token);
+}
+
+bool FUDMFScanner::GetString()
+{
+	return GetToken();
+}
+
+void FUDMFScanner::MustGetString()
+{
+	if (!GetToken())
+	{
+		ScriptError("Missing string (unexpected end of file).");
+	}
+}
+
+bool FUDMFScanner::CheckString(const char *name)
+{
+	if (GetToken())
+	{
+		if (Compare(name)) return true;
+		UnGet();
+	}
+	return false;
+}
+
+void FUDMFScanner::MustGetStringName(const char *name)
+{
+	MustGetString();
+	if (!Compare(name))
+	{
+		ScriptError("Expected '%s', got '%s'.", name, String);
+	}
+}
+
+bool FUDMFScanner::Compare(const char *text) const
+{
+	return !stricmp(text, String);
+}
+
+//==========================================================================
+//
+// Maps identifiers to names through an open addressing table keyed by
+// the exact spelling in the text. Maps only use a few dozen distinct keys
+// so after the first block nearly every lookup is a hit.
+//
+//==========================================================================
+
+FName FUDMFScanner::GetName()
+{
+	if (TokenType != TK_Identifier && TokenType != TK_True && TokenType != TK_False)
+	{
+		return FName(String);
+	}
+
+	uint32_t hash = 2166136261u;
+	for (int i = 0; i < StringLen; i++)
+	{
+		hash = (hash ^ (uint8_t)TokenStart[i]) * 16777619u;
+	}
+
+	unsigned mask = NameCache.Size() - 1;
+	for (unsigned slot = hash & mask; ; slot = (slot + 1) & mask)
+	{
+		auto &entry = NameCache[slot];
+		if (entry.Text == nullptr)
+		{
+			FName name(String);
+			// Keep the table at most half full, after that new keys simply miss.
+			if (NameCacheUsed < NameCache.Size() / 2)
+			{
+				entry.Hash = hash;
+				entry.Len = StringLen;
+				entry.Text = TokenStart;
+				entry.Name = name;
+				NameCacheUsed++;
+			}
+			return name;
+		}
+		if (entry.Hash == hash && entry.Len == StringLen && !memcmp(entry.Text, TokenStart, StringLen))
+		{
+			return entry.Name;
+		}
+	}
+}
+
+//==========================================================================
+//
+// A quick pass over the text that only tracks strings, comments and
+// brace depth, so that the parser can allocate its arrays up front.
+//
+//==========================================================================
+
+void FUDMFScanner::CountBlocks(const char *const *names, unsigned *counts)
+{
+	int numnames = 0;
+	while (names[numnames] != nullptr) counts[numnames++] = 0;
+
+	const char *savepos = Pos;
+	int saveline = Line;
+	int depth = 0;
+	const char *ident = nullptr;
+	int identlen = 0;
+
+	Pos = (const char *)Buffer.Data();
+	while (true)
+	{
+		SkipWhitespace();
+		if (Pos >= End) break;
+
+		const char *p = Pos;
+		if (CharClass[(uint8_t)*p] & CHAR_IdentStart)
+		{
+			do p++; while (p < End && (CharClass[(uint8_t)*p] & CHAR_Ident));
+			ident = Pos;
+			identlen = int(p - Pos);
+			Pos = p;
+			continue;
+		}
+		if (*p == '"')
+		{
+			p++;
+			while (p < End)
+			{
+				p = (const char *)memchr(p, '"', End - p);
+				if (p == nullptr) { p = End; break; }
+				int slashes = 0;
+				for (const char *b = p - 1; *b == '\\'; b--) slashes++;
+				p++;
+				if (!(slashes & 1)) break;
+			}
+		}
+		else if (*p == '{')
+		{
+			if (depth == 0 && ident != nullptr)
+			{
+				for (int i = 0; i < numnames; i++)
+				{
+					if ((int)strlen(names[i]) == identlen && !strnicmp(names[i], ident, identlen))
+					{
+						counts[i]++;
+						break;
+					}
+				}
+			}
+			depth++;
+			p++;
+		}
+		else
+		{
+			if (*p == '}' && depth > 0) depth--;
+			p++;
+		}
+		ident = nullptr;
+		Pos = p;
+	}
+
+	Pos = savepos;
+	Line = saveline;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FUDMFScanner::ScriptError(const char *message, ...)
+{
+	FString composed;
+	va_list arglist;
+	va_start(arglist, message);
+	composed.VFormat(message, arglist);
+	va_end(arglist);
+
+	I_Error("Script error, \"%s\" line %d:\n%s\n", ScriptName.GetChars(), Line, composed.GetChars());
+}
+
+void FUDMFScanner::ScriptMessage(const char *message, ...)
+{
+	FString composed;
+	va_list arglist;
+	va_start(arglist, message);
+	composed.VFormat(message, arglist);
+	va_end(arglist);
+
+	Printf(TEXTCOLOR_RED "Script error, \"%s\"" TEXTCOLOR_RED " line %d:\n" TEXTCOLOR_RED "%s\n", ScriptName.GetChars(), Line, composed.GetChars());
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "tarray.h"
+#include "name.h"
+#include "sc_man.h"
+
+// A tokenizer for UDMF text that only knows what the UDMF grammar needs.
+// Tokens are slices of the text buffer, only the current token gets copied
+// into a reusable buffer, and identifiers are mapped to names through a
+// small local cache so that each distinct key only hits the global name
+// table once. The interface mirrors the parts of FScanner the UDMF
+// parsers use and produces the same token types.
+
+class FUDMFScanner
+{
+public:
+	int TokenType = 0;
+	const char *String = "";
+	int StringLen = 0;
+	int Number = 0;
+	double Float = 0;
+	int Line = 1;
+
+	void OpenMem(const char *name, TArray<uint8_t> &&buffer);
+	template<class T> void OpenMem(const char *name, const T &buffer)
+	{
+		TArray<uint8_t> copy((unsigned)buffer.size(), true);
+		if (copy.Size() > 0) memcpy(copy.Data(), buffer.data(), copy.Size());
+		OpenMem(name, std::move(copy));
+	}
+	void SetCMode(bool) {}	// UDMF is always scanned in C mode.
+
+	bool GetToken();
+	void MustGetAnyToken();
+	bool CheckToken(int token);
+	void MustGetToken(int token);
+	bool GetString();
+	void MustGetString();
+	bool CheckString(const char *name);
+	void MustGetStringName(const char *name);
+	bool Compare(const char *text) const;
+	void UnGet();
+
+	// Returns the current token as a name.
+	FName GetName();
+
+	// Counts how many top level blocks with each of the given names the text contains.
+	void CountBlocks(const char *const *names, unsigned *counts);
+
+	void ScriptError(const char *message, ...) GCCPRINTF(2,3);
+	void ScriptMessage(const char *message, ...) GCCPRINTF(2,3);
+
+private:
+	void SkipWhitespace();
+	void SetString(const char *start, int len);
+	void ParseNumber(const char *start, int len, bool isfloat);
+	void ParseQuotedString(const char *start, int len);
+	void TokenMismatch(int token);
+
+	struct FNameCacheEntry
+	{
+		uint32_t Hash;
+		int Len;
+		const char *Text;	// points into the text buffer
+		FName Name;
+	};
+	enum { NAME_CACHE_SIZE = 1024 };
+
+	FString ScriptName;
+	TArray<uint8_t> Buffer;
+	TArray<char> StringBuffer;
+	TArray<FNameCacheEntry> NameCache;
+	unsigned NameCacheUsed = 0;
+	const char *TokenStart = nullptr;
+	const char *Pos = nullptr;
+	const char *End = nullptr;
+	const char *LastPos = nullptr;
+	int LastLine = 1;
+};
@@ -80,6 +80,7 @@
 #include "texturemanager.h"
 #include "p_lnspec.h"
 #include "d_main.h"
+#include "profiler.h"
 
 extern AActor *SpawnMapThing (int index, FMapThing *mthing, int position);
 
@@ -155,6 +156,8 @@ static void PrecacheLevel(FLevelLocals *Level)
 	if (demoplayback)
 		return;
 
+	PROFILE_ZONE("PrecacheLevel", "mapload");
+
 	int i;
 	TMap<PClassActor *, bool> actorhitlist;
 	int cnt = TexMan.NumTextures();
@@ -412,6 +415,7 @@ void P_FreeLevelData (bool fullgc)
 
 void P_SetupLevel(FLevelLocals *Level, int position, bool newGame)
 {
+	FProfileZone zone("P_SetupLevel", "mapload", Level->MapName.GetChars());
 	int i;
 
 	Level->ShaderStartTime = I_msTimeFS(); // indicate to the shader system that the level just started
@@ -573,6 +577,7 @@ void P_SetupLevel(FLevelLocals *Level, int position, bool newGame)
 	if (precache)
 	{
 		PrecacheLevel(Level);
+		PROFILE_ZONE("S_PrecacheLevel", "mapload");
 		S_PrecacheLevel(Level);
 	}
 
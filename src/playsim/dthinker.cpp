@@ -47,11 +47,29 @@
 #include "d_main.h"
 
 #include "p_visualthinker.h"
+#include "metrics.h"
 
 static int ThinkCount;
 static cycle_t ThinkCycles;
+static FHistogramMetric ThinkTimeMetric("playsim.think_ms", METRIC_Tic, { 1, 2, 4, 8, 16, 28.6 });
+static FGaugeMetric ThinkerCountMetric("playsim.thinkers", METRIC_Tic);
+static FGaugeMetric ActorCountMetric("playsim.actors", METRIC_Tic);
 extern cycle_t BotSupportCycles;
 extern cycle_t ActionCycles;
+
+// Reorders the actors in each thinker list by their blockmap block every n tics so that
+// actors close to each other get ticked one after another. This changes the order in which
+// actors act, so it is a server setting that gets recorded in demos and synced in netgames.
+// It is not archived so that it cannot accidentally be active when playing back old demos.
+CVAR(Int, sv_thinkersort, 0, CVAR_SERVERINFO)
+
+static bool ActorSleepActive;
+
+// Sleeping actors are skipped, see p_actorsleep.cpp. Fresh actors always get their first tick.
+static inline bool SkipTick(DThinker *node)
+{
+	return ActorSleepActive && !(node->ObjectFlags & OF_JustSpawned) && node->IsKindOf(RUNTIME_CLASS(AActor)) && P_ActorSleeps(static_cast<AActor *>(node));
+}
 extern int BotWTG;
 
 IMPLEMENT_CLASS(DThinker, false, false)
@@ -141,6 +159,16 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 		}
 	};
 
+	ActorSleepActive = P_BeginActorSleep(Level);
+
+	if (sv_thinkersort > 0 && Level->maptime % sv_thinkersort == 0)
+	{
+		for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
+		{
+			Thinkers[i].SortActors(Level);
+		}
+	}
+
 	if (!profilethinkers)
 	{
 		// Tick every thinker left from last time
@@ -265,6 +293,17 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 	}
 
 	ThinkCycles.Unclock();
+
+	if (MetricsActive)
+	{
+		int actors = 0;
+		auto it = Level->GetThinkerIterator<AActor>();
+		while (it.Next()) actors++;
+
+		ThinkTimeMetric.Record(ThinkCycles.TimeMS());
+		ThinkerCountMetric.Set(ThinkCount);
+		ActorCountMetric.Set(actors);
+	}
 }
 
 //==========================================================================
@@ -405,6 +444,85 @@ void FThinkerList::AddTail(DThinker *thinker)
 	GC::WriteBarrier(Sentinel, thinker);
 }
 
+//==========================================================================
+//
+// Stable sorts the actors in this list by the Morton code of their blockmap
+// block. Other thinkers keep their places in the list. The result only depends
+// on the list order and actor positions so it is the same on every machine.
+//
+//==========================================================================
+
+static uint32_t MortonCode(uint32_t x, uint32_t y)
+{
+	auto spread = [](uint32_t v)
+	{
+		v &= 0xffff;
+		v = (v | (v << 8)) & 0x00ff00ff;
+		v = (v | (v << 4)) & 0x0f0f0f0f;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	};
+	return spread(x) | (spread(y) << 1);
+}
+
+void FThinkerList::SortActors(FLevelLocals *Level)
+{
+	struct SortEntry
+	{
+		uint32_t Key;
+		AActor *Actor;
+	};
+	static TArray<DThinker *> nodes;
+	static TArray<SortEntry> actors;
+
+	if (Sentinel == nullptr || Sentinel->NextThinker == Sentinel)
+		return;
+
+	nodes.Clear();
+	actors.Clear();
+	auto &blockmap = Level->blockmap;
+	for (DThinker *node = Sentinel->NextThinker; node != Sentinel; node = node->NextThinker)
+	{
+		nodes.Push(node);
+		if (node->IsKindOf(RUNTIME_CLASS(AActor)))
+		{
+			auto actor = static_cast<AActor *>(node);
+			uint32_t bx = clamp(blockmap.GetBlockX(actor->X()), 0, 0xffff);
+			uint32_t by = clamp(blockmap.GetBlockY(actor->Y()), 0, 0xffff);
+			actors.Push({ MortonCode(bx, by), actor });
+		}
+	}
+	if (actors.Size() < 2)
+		return;
+
+	std::stable_sort(actors.begin(), actors.end(), [](const SortEntry &a, const SortEntry &b) { return a.Key < b.Key; });
+
+	unsigned nextactor = 0;
+	for (auto &node : nodes)
+	{
+		if (node->IsKindOf(RUNTIME_CLASS(AActor)))
+		{
+			node = actors[nextactor++].Actor;
+		}
+	}
+
+	// Relink the list in the new order.
+	DThinker *prev = Sentinel;
+	for (auto node : nodes)
+	{
+		prev->NextThinker = node;
+		node->PrevThinker = prev;
+		GC::WriteBarrier(prev, node);
+		GC::WriteBarrier(node, prev);
+		prev = node;
+	}
+	prev->NextThinker = Sentinel;
+	Sentinel->PrevThinker = prev;
+	GC::WriteBarrier(prev, Sentinel);
+	GC::WriteBarrier(Sentinel, prev);
+}
+
 //==========================================================================
 //
 // 
@@ -614,7 +732,7 @@ int FThinkerList::TickThinkers(FThinkerList *dest)
 			I_Error("There is a thinker in the fresh list that has already ticked.\n");
 		}
 
-		if (!(node->ObjectFlags & OF_EuthanizeMe))
+		if (!(node->ObjectFlags & OF_EuthanizeMe) && !SkipTick(node))
 		{ // Only tick thinkers not scheduled for destruction
 			ThinkCount++;
 			node->CallTick();
@@ -659,7 +777,7 @@ int FThinkerList::ProfileThinkers(FThinkerList *dest)
 			I_Error("There is a thinker in the fresh list that has already ticked.\n");
 		}
 
-		if (!(node->ObjectFlags & OF_EuthanizeMe))
+		if (!(node->ObjectFlags & OF_EuthanizeMe) && !SkipTick(node))
 		{ // Only tick thinkers not scheduled for destruction
 			ThinkCount++;
 
@@ -63,6 +63,7 @@ struct FThinkerList
 	int TickThinkers(FThinkerList *dest);	// Returns: # of thinkers ticked
 	int ProfileThinkers(FThinkerList *dest);
 	void SaveList(FSerializer &arc);
+	void SortActors(FLevelLocals *Level);
 
 private:
 	DThinker *Sentinel = nullptr;
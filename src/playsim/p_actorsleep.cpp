@@ -0,0 +1,216 @@
+/*
+** p_actorsleep.cpp
+** Reduced tick rate for idle monsters far away from all players
+**
+**---------------------------------------------------------------------------
+** Copyright 2026 agent
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+*/
+
+
+#include "actor.h"
+#include "d_player.h"
+#include "doomstat.h"
+#include "g_levellocals.h"
+#include "p_local.h"
+#include "c_cvars.h"
+#include "vm.h"
+
+// On maps with the 'actorsleep' MAPINFO flag, idle monsters that are far away
+// from all players only tick every SLEEP_TICS tics. A monster counts as idle
+// while it has no target, is in a spawn state sequence that does nothing but
+// A_Look, is not moving and nothing made noise in its sector. Actors with their
+// own Tick are never put to sleep, so scripted logic always runs at full rate.
+// Idle monsters keep calling A_Look at the lower rate,
+// so they still wake up by seeing a player, and anything that gives them a
+// target, like line specials or P_NoiseAlert, wakes them up on the next tic.
+// All of this only depends on the game state, so it stays in sync in demos and
+// netgames. sv_actorsleep turns it off for strict compatibility.
+//
+// Demos are strict by default: they only let actors sleep if their serverinfo
+// has sv_actorsleep enabled. Demos without the setting play back with sleeping
+// turned off, and single player recordings only enable it with demo_actorsleep.
+// In netgames sv_actorsleep is shared by all nodes, so a node that records
+// cannot change it and writes it to the demo as it is.
+
+CVAR(Bool, sv_actorsleep, true, CVAR_SERVERINFO)
+CVAR(Bool, demo_actorsleep, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+static bool RestoreActorSleep;
+
+enum
+{
+	SLEEP_TICS = 8,
+};
+static const double SLEEP_DISTANCE = 4096.;
+
+static DVector2 PlayerPositions[MAXPLAYERS];
+static int NumPlayerPositions;
+static int SleepTic;
+
+//==========================================================================
+//
+// Called before a demo's cvars are read. G_DoPlayDemo has already backed up
+// the cvars and restores them when playback ends.
+//
+//==========================================================================
+
+void P_ActorSleepBeginPlayback()
+{
+	UCVarValue val;
+	val.Bool = false;
+	sv_actorsleep->ForceSet(val, CVAR_Bool);
+}
+
+//==========================================================================
+//
+// Called before the serverinfo gets written to a new demo.
+//
+//==========================================================================
+
+void P_ActorSleepBeginRecording()
+{
+	if (!netgame && !demo_actorsleep && sv_actorsleep)
+	{
+		UCVarValue val;
+		val.Bool = false;
+		sv_actorsleep->ForceSet(val, CVAR_Bool);
+		RestoreActorSleep = true;
+	}
+}
+
+void P_ActorSleepEndRecording()
+{
+	if (RestoreActorSleep)
+	{
+		UCVarValue val;
+		val.Bool = true;
+		sv_actorsleep->ForceSet(val, CVAR_Bool);
+		RestoreActorSleep = false;
+	}
+}
+
+//==========================================================================
+//
+// Called once per tic before the thinkers run. Returns false if no actor
+// may sleep this tic.
+//
+//==========================================================================
+
+bool P_BeginActorSleep(FLevelLocals *Level)
+{
+	if (!(Level->flags3 & LEVEL3_ACTORSLEEP) || !sv_actorsleep)
+		return false;
+
+	NumPlayerPositions = 0;
+	for (int i = 0; i < MAXPLAYERS; i++)
+	{
+		if (Level->PlayerInGame(i) && Level->Players[i]->mo != nullptr)
+		{
+			PlayerPositions[NumPlayerPositions++] = Level->Players[i]->mo->Pos().XY();
+		}
+	}
+	SleepTic = Level->maptime;
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static bool IsLookAction(VMFunction *func)
+{
+	static const FName look("A_Look"), lookex("A_LookEx");
+	return func == nullptr || func->Name == look || func->Name == lookex;
+}
+
+// True if the actor is in its spawn state sequence and that sequence only looks for players.
+static bool InIdleSequence(FState *state, FState *spawnstate)
+{
+	if (spawnstate == nullptr) return false;
+
+	bool found = false;
+	FState *thisstate = spawnstate;
+	do
+	{
+		if (!IsLookAction(thisstate->ActionFunc)) return false;
+		if (state == thisstate) found = true;
+		spawnstate = thisstate;
+		thisstate = thisstate->GetNextState();
+	}
+	while (thisstate == spawnstate + 1);
+	return found;
+}
+
+static bool OverridesTick(AActor *actor)
+{
+	static unsigned VIndex = ~0u;
+	if (VIndex == ~0u)
+	{
+		VIndex = GetVirtualIndex(RUNTIME_CLASS(DThinker), "Tick");
+	}
+	auto &virtuals = actor->GetClass()->Virtuals;
+	auto &base = RUNTIME_CLASS(AActor)->Virtuals;
+	return VIndex < virtuals.Size() && VIndex < base.Size() && virtuals[VIndex] != base[VIndex];
+}
+
+//==========================================================================
+//
+// Returns true if the actor's tick should be skipped this tic.
+// The tics get spread out by spawn order so that not all sleeping
+// actors tick at once.
+//
+//==========================================================================
+
+bool P_ActorSleeps(AActor *actor)
+{
+	if ((SleepTic + actor->SpawnOrder) % SLEEP_TICS == 0)
+		return false;
+
+	if (actor->player != nullptr || !(actor->flags3 & MF3_ISMONSTER) || (actor->flags & (MF_FRIENDLY | MF_SKULLFLY)) || actor->health <= 0)
+		return false;
+
+	if (actor->target != nullptr || !actor->Vel.isZero() || actor->Z() > actor->floorz)
+		return false;
+
+	if (actor->Sector == nullptr || actor->Sector->SoundTarget != nullptr)
+		return false;
+
+	if (!InIdleSequence(actor->state, actor->SpawnState) || OverridesTick(actor))
+		return false;
+
+	auto pos = actor->Pos().XY();
+	for (int i = 0; i < NumPlayerPositions; i++)
+	{
+		if ((PlayerPositions[i] - pos).LengthSquared() < SLEEP_DISTANCE * SLEEP_DISTANCE)
+			return false;
+	}
+	return true;
+}
@@ -52,6 +52,7 @@ struct FTranslatedLineTarget;
 struct FLinePortal;
 class DViewPosition;
 struct FRenderViewpoint;
+struct FLevelLocals;
 
 #include <stdlib.h>
 
@@ -129,6 +130,12 @@ void P_CheckFakeFloorTriggers(AActor *mo, double oldz, bool oldz_has_viewheight
 
 AActor *P_SpawnSubMissile (AActor *source, PClassActor *type, AActor *target);	// Strife uses it
 
+bool P_BeginActorSleep(FLevelLocals *Level);
+void P_ActorSleepBeginPlayback();
+void P_ActorSleepBeginRecording();
+void P_ActorSleepEndRecording();
+bool P_ActorSleeps(AActor *actor);
+
 
 //
 // [RH] P_THINGS
@@ -146,7 +153,6 @@ PClassActor *P_GetSpawnableType(int spawnnum);
 void InitSpawnablesFromMapinfo();
 int P_Thing_CheckInputNum(player_t *p, int inputnum);
 int P_Thing_Warp(AActor *caller, AActor *reference, double xofs, double yofs, double zofs, DAngle angle, int flags, double heightoffset, double radiusoffset, DAngle pitch);
-struct FLevelLocals;
 int P_Thing_CheckProximity(FLevelLocals *Level, AActor *self, PClass *classname, double distance, int count, int flags, int ptr, bool counting = false);
 
 enum
@@ -6213,7 +6213,27 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, double
 
 	P_GeometryRadiusAttack(bombspot, bombsource, bombdamage, bombdistance, bombmod, fulldamagedistance);
 
-	TArray<AActor*> targets;
+	// Damaging a target can set off further explosions before this one is done,
+	// so each nesting level gets its own target list which is kept between calls.
+	static TArray<TArray<AActor*>> targetlists;
+	static unsigned targetdepth;
+	struct FTargetList
+	{
+		TArray<AActor*> List;
+		FTargetList()
+		{
+			if (targetlists.Size() <= targetdepth) targetlists.Resize(targetdepth + 1);
+			List = std::move(targetlists[targetdepth++]);
+			List.Clear();
+		}
+		~FTargetList()
+		{
+			targetlists[--targetdepth] = std::move(List);
+		}
+	} targetlist;
+	TArray<AActor*> &targets = targetlist.List;
+
+	auto sourcegroup = bombspot->GetClass()->ActorInfo()->splash_group;
 	int count = 0;
 	while ((it.Next(&cres)))
 	{
@@ -6236,7 +6256,6 @@ int P_RadiusAttack(AActor *bombspot, AActor *bombsource, int bombdamage, double
 
 		// MBF21
 		auto targetgroup = thing->GetClass()->ActorInfo()->splash_group;
-		auto sourcegroup = bombspot->GetClass()->ActorInfo()->splash_group;
 		if (targetgroup != 0 && targetgroup == sourcegroup) continue;
 
 		// a much needed option: monsters that fire explosive projectiles cannot 
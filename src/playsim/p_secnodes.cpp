@@ -76,6 +76,40 @@ void P_PutSecnode(msecnode_t *node)
 	headsecnode = node;
 }
 
+//=============================================================================
+//
+// P_LinkNewSecnode
+//
+// Adds a new node for a sector that is not yet in the list without
+// searching for it first.
+//
+//=============================================================================
+
+template<class nodetype, class linktype>
+static nodetype *P_LinkNewSecnode(linktype *s, AActor *thing, nodetype *nextnode, nodetype *&sec_thinglist)
+{
+	nodetype *node = (nodetype*)P_GetSecnode();
+
+	// killough 4/4/98, 4/7/98: mark new nodes unvisited.
+	node->visited = 0;
+
+	node->m_sector = s; 			// sector
+	node->m_thing = thing; 		// mobj
+	node->m_tprev = nullptr;			// prev node on Thing thread
+	node->m_tnext = nextnode;		// next node on Thing thread
+	if (nextnode)
+		nextnode->m_tprev = node;	// set back link on Thing
+
+	// Add new node at head of sector thread starting at s->touching_thinglist
+
+	node->m_sprev = nullptr;			// prev node on sector thread
+	node->m_snext = sec_thinglist; // next node on sector thread
+	if (sec_thinglist)
+		node->m_snext->m_sprev = node;
+	sec_thinglist = node;
+	return node;
+}
+
 //=============================================================================
 // phares 3/16/98
 //
@@ -112,26 +146,7 @@ nodetype *P_AddSecnode(linktype *s, AActor *thing, nodetype *nextnode, nodetype
 	// Couldn't find an existing node for this sector. Add one at the head
 	// of the list.
 
-	node = (nodetype*)P_GetSecnode();
-
-	// killough 4/4/98, 4/7/98: mark new nodes unvisited.
-	node->visited = 0;
-
-	node->m_sector = s; 			// sector
-	node->m_thing = thing; 		// mobj
-	node->m_tprev = nullptr;			// prev node on Thing thread
-	node->m_tnext = nextnode;		// next node on Thing thread
-	if (nextnode)
-		nextnode->m_tprev = node;	// set back link on Thing
-
-	// Add new node at head of sector thread starting at s->touching_thinglist
-
-	node->m_sprev = nullptr;			// prev node on sector thread
-	node->m_snext = sec_thinglist; // next node on sector thread
-	if (sec_thinglist)
-		node->m_snext->m_sprev = node;
-	sec_thinglist = node;
-	return node;
+	return P_LinkNewSecnode(s, thing, nextnode, sec_thinglist);
 }
 
 template msecnode_t *P_AddSecnode<msecnode_t, sector_t>(sector_t *s, AActor *thing, msecnode_t *nextnode, msecnode_t *&sec_thinglist);
@@ -212,30 +227,81 @@ void P_DelSeclist(portnode_t *node, portnode_t *FLinePortal::*sechead)
 
 
 //=============================================================================
-// phares 3/14/98
-//
-// P_CreateSecNodeList
 //
-// Alters/creates the sector_list that shows what sectors the object resides in
+// The sectors an actor touches, in the order they were found. There are
+// rarely more than a few so they are kept in a small array on the stack
+// that can be scanned linearly.
 //
 //=============================================================================
 
-msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector_list, msecnode_t *sector_t::*seclisthead)
+struct FTouchedSectors
 {
-	msecnode_t *node;
+	enum { INLINE_SIZE = 32 };
 
-	// First, clear out the existing m_thing fields. As each node is
-	// added or verified as needed, m_thing will be set properly. When
-	// finished, delete all nodes where m_thing is still nullptr. These
-	// represent the sectors the Thing has vacated.
+	sector_t *Inline[INLINE_SIZE];
+	bool Linked[INLINE_SIZE];
+	TArray<sector_t *> Overflow;
+	TArray<bool> OverflowLinked;
+	unsigned Count = 0;
 
-	node = sector_list;
-	while (node)
+	sector_t *Sector(unsigned i) const
 	{
-		node->m_thing = nullptr;
-		node = node->m_tnext;
+		return i < INLINE_SIZE ? Inline[i] : Overflow[i - INLINE_SIZE];
+	}
+
+	bool &IsLinked(unsigned i)
+	{
+		return i < INLINE_SIZE ? Linked[i] : OverflowLinked[i - INLINE_SIZE];
+	}
+
+	int Find(const sector_t *sec) const
+	{
+		unsigned n = min<unsigned>(Count, INLINE_SIZE);
+		for (unsigned i = 0; i < n; i++)
+		{
+			if (Inline[i] == sec) return i;
+		}
+		for (unsigned i = 0; i < Overflow.Size(); i++)
+		{
+			if (Overflow[i] == sec) return i + INLINE_SIZE;
+		}
+		return -1;
 	}
 
+	void Add(sector_t *sec)
+	{
+		if (Find(sec) >= 0) return;
+		if (Count < INLINE_SIZE)
+		{
+			Inline[Count] = sec;
+			Linked[Count] = false;
+		}
+		else
+		{
+			Overflow.Push(sec);
+			OverflowLinked.Push(false);
+		}
+		Count++;
+	}
+};
+
+//=============================================================================
+// phares 3/14/98
+//
+// P_CreateSecNodeList
+//
+// Alters/creates the sector_list that shows what sectors the object resides in
+//
+// This first collects the touched sectors and then updates the existing list
+// in a single pass, instead of searching the list for every crossed line.
+// New nodes get added in the order the old code added them, so the thing
+// and sector lists come out exactly the same.
+//
+//=============================================================================
+
+msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector_list, msecnode_t *sector_t::*seclisthead)
+{
+	FTouchedSectors touched;
 	FBoundingBox box(thing->X(), thing->Y(), radius);
 	FBlockLinesIterator it(thing->Level, box);
 	line_t *ld;
@@ -247,12 +313,11 @@ msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector
 
 		// This line crosses through the object.
 
-		// Collect the sector(s) from the line and add to the
-		// sector_list you're examining. If the Thing ends up being
+		// Collect the sector(s) from the line. If the Thing ends up being
 		// allowed to move to this position, then the sector_list
 		// will be attached to the Thing's AActor at touching_sectorlist.
 
-		sector_list = P_AddSecnode(ld->frontsector, thing, sector_list, ld->frontsector->*seclisthead);
+		touched.Add(ld->frontsector);
 
 		// Don't assume all lines are 2-sided, since some Things
 		// like MT_TFOG are allowed regardless of whether their radius takes
@@ -262,20 +327,25 @@ msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector
 		// Use sidedefs instead of 2s flag to determine two-sidedness.
 
 		if (ld->backsector)
-			sector_list = P_AddSecnode(ld->backsector, thing, sector_list, ld->backsector->*seclisthead);
+			touched.Add(ld->backsector);
 	}
 
 	// Add the sector of the (x,y) point to sector_list.
 
-	sector_list = P_AddSecnode(thing->Sector, thing, sector_list, thing->Sector->*seclisthead);
+	if (thing->Sector == nullptr)
+	{
+		I_FatalError("AddSecnode of 0 for %s\n", thing->GetClass()->TypeName.GetChars());
+	}
+	touched.Add(thing->Sector);
 
-	// Now delete any nodes that won't be used. These are the ones where
-	// m_thing is still nullptr.
+	// Keep the nodes of all sectors that are still being touched and
+	// delete the ones for the sectors the Thing has vacated.
 
-	node = sector_list;
+	msecnode_t *node = sector_list;
 	while (node)
 	{
-		if (node->m_thing == nullptr)
+		int index = touched.Find(node->m_sector);
+		if (index < 0)
 		{
 			if (node == sector_list)
 				sector_list = node->m_tnext;
@@ -283,9 +353,22 @@ msecnode_t *P_CreateSecNodeList(AActor *thing, double radius, msecnode_t *sector
 		}
 		else
 		{
+			node->m_thing = thing;
+			touched.IsLinked(index) = true;
 			node = node->m_tnext;
 		}
 	}
+
+	// Now add nodes for the sectors that weren't in the list yet.
+
+	for (unsigned i = 0; i < touched.Count; i++)
+	{
+		if (!touched.IsLinked(i))
+		{
+			sector_t *sec = touched.Sector(i);
+			sector_list = P_LinkNewSecnode(sec, thing, sector_list, sec->*seclisthead);
+		}
+	}
 	return sector_list;
 }
 
@@ -15,6 +15,7 @@
 #include "hwrenderer/scene/hw_drawinfo.h"
 #include "hwrenderer/scene/hw_walldispatcher.h"
 #include "hwrenderer/scene/hw_flatdispatcher.h"
+#include "metrics.h"
 #include <unordered_map>
 
 #include "vm.h"
@@ -57,6 +58,17 @@ static int InvalidateLightmap()
 cycle_t ProcessLevelMesh;
 cycle_t DynamicBLASTime;
 
+static FGaugeMetric LevelMeshTimeMetric("levelmesh.process_ms", METRIC_Frame);
+static FGaugeMetric LevelMeshSidesMetric("levelmesh.sides", METRIC_Frame);
+static FGaugeMetric LevelMeshFlatsMetric("levelmesh.flats", METRIC_Frame);
+static FGaugeMetric LevelMeshPortalsMetric("levelmesh.portals", METRIC_Frame);
+static FGaugeMetric LevelMeshDynLightsMetric("levelmesh.dynlights", METRIC_Frame);
+static FGaugeMetric LightmapTilesMetric("lightmap.tiles", METRIC_Frame);
+static FGaugeMetric LightmapDirtyTilesMetric("lightmap.tiles_dirty", METRIC_Frame);
+static FGaugeMetric LightmapDynamicTilesMetric("lightmap.tiles_dynamic", METRIC_Frame);
+static FGaugeMetric LightmapDirtyPixelsMetric("lightmap.pixels_dirty", METRIC_Frame);
+static FGaugeMetric LightmapBLASTimeMetric("lightmap.blas_ms", METRIC_Frame);
+
 ADD_STAT(lightmap)
 {
 	FString out;
@@ -95,6 +107,35 @@ ADD_STAT(lightmap)
 	return out;
 }
 
+//==========================================================================
+//
+// Exports the data of the lightmap and levelmesh stats.
+// Must be called after the level mesh has been processed for this frame.
+//
+//==========================================================================
+
+static void RecordLevelMeshMetrics(DoomLevelMesh* levelMesh)
+{
+	if (!MetricsActive) return;
+
+	auto& stats = levelMesh->LastFrameStats;
+	LevelMeshTimeMetric.Set(ProcessLevelMesh.TimeMS());
+	LevelMeshSidesMetric.Set(stats.SidesUpdated);
+	LevelMeshFlatsMetric.Set(stats.FlatsUpdated);
+	LevelMeshPortalsMetric.Set(stats.Portals);
+	LevelMeshDynLightsMetric.Set(stats.DynLights);
+
+	if (level.lightmaps)
+	{
+		auto tilestats = levelMesh->GatherTilePixelStats();
+		LightmapTilesMetric.Set(tilestats.tiles.total);
+		LightmapDirtyTilesMetric.Set(tilestats.tiles.dirty);
+		LightmapDynamicTilesMetric.Set(tilestats.tiles.dirtyDynamic);
+		LightmapDirtyPixelsMetric.Set(tilestats.pixels.dirty + tilestats.pixels.dirtyDynamic);
+		LightmapBLASTimeMetric.Set(DynamicBLASTime.TimeMS());
+	}
+}
+
 ADD_STAT(levelmesh)
 {
 	auto& stats = level.levelMesh->LastFrameStats;
@@ -336,6 +377,7 @@ void DoomLevelMesh::BeginFrame(FLevelLocals& doomMap)
 	r_viewpoint.camera = oldcamera;
 
 	ProcessLevelMesh.Unclock();
+	RecordLevelMeshMetrics(this);
 }
 
 void DoomLevelMesh::UploadDynLights(FLevelLocals& doomMap)
@@ -417,6 +417,7 @@ sector_t* RenderView(player_t* player)
 		retsec = RenderViewpoint(r_viewpoint, player->camera, NULL, r_viewpoint.FieldOfView.Degrees(), ratio, fovratio, true, true);
 	}
 	All.Unclock();
+	if (V_IsHardwareRenderer()) RecordRenderMetrics();
 	return retsec;
 }
 
@@ -44,6 +44,7 @@
 #include "hw_vertexbuilder.h"
 #include "hw_walldispatcher.h"
 #include "hw_flatdispatcher.h"
+#include "profiler.h"
 
 #include "p_visualthinker.h"
 
@@ -52,12 +53,18 @@
 #endif // ARCH_IA32
 
 CVAR(Bool, gl_multithread, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CUSTOM_CVAR(Int, gl_multithread_workers, 2, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+{
+	if (self < 1) self = 1;
+	else if (self > MAX_RENDER_WORKERS) self = MAX_RENDER_WORKERS;
+}
 
 EXTERN_CVAR(Float, r_actorspriteshadowdist)
 EXTERN_CVAR(Bool, r_radarclipper)
 EXTERN_CVAR(Bool, r_dithertransparency)
 
 thread_local bool isWorkerThread;
+thread_local int renderWorkerIndex;
 ctpl::thread_pool renderPool(1);
 bool inited = false;
 
@@ -117,9 +124,56 @@ public:
 	}
 };
 
-static RenderJobQueue jobQueue;	// One static queue is sufficient here. This code will never be called recursively.
+//==========================================================================
+//
+// Each worker gets its own queue so that the queues can remain lock free.
+// The jobs are distributed by type so that everything that shares state
+// without synchronization stays on the same worker:
+//
+// 1 worker: everything
+// 2 workers: walls, flats and portals / sprites and particles
+// 3 workers: walls and portals / flats / sprites and particles
+//
+//==========================================================================
 
-void HWDrawInfo::WorkerThread()
+class RenderJobQueues
+{
+	RenderJobQueue queues[MAX_RENDER_WORKERS];
+	int numworkers = 1;
+
+	int GetWorker(int type) const
+	{
+		if (numworkers >= 2 && (type == RenderJob::SpriteJob || type == RenderJob::ParticleJob)) return numworkers - 1;
+		if (numworkers >= 3 && type == RenderJob::FlatJob) return 1;
+		return 0;
+	}
+
+public:
+	void Start(int workers)
+	{
+		numworkers = workers;
+		for (auto& queue : queues) queue.ReleaseAll();
+	}
+
+	void AddJob(int type, subsector_t *sub, seg_t *seg = nullptr)
+	{
+		queues[GetWorker(type)].AddJob(type, sub, seg);
+	}
+
+	void Finish()
+	{
+		for (int i = 0; i < numworkers; i++) queues[i].AddJob(RenderJob::TerminateJob, nullptr, nullptr);
+	}
+
+	RenderJob *GetJob(int worker)
+	{
+		return queues[worker].GetJob();
+	}
+};
+
+static RenderJobQueues jobQueue;	// One static set of queues is sufficient here. This code will never be called recursively.
+
+void HWDrawInfo::WorkerThread(int index)
 {
 	sector_t *front, *back;
 	HWWallDispatcher disp(this);
@@ -127,11 +181,15 @@ void HWDrawInfo::WorkerThread()
 
 	FRenderState& state = *screen->RenderState();
 
-	WTTotal.Clock();
+	// The clock is not thread safe so only the first worker may use it.
+	if (index == 0) WTTotal.Clock();
 	isWorkerThread = true;	// for adding asserts in GL API code. The worker thread may never call any GL API.
+	renderWorkerIndex = index;
+	Profiler_SetThreadName("BSP worker");
+	PROFILE_ZONE("BSP worker", "frame");
 	while (true)
 	{
-		auto job = jobQueue.GetJob();
+		auto job = jobQueue.GetJob(index);
 		if (job == nullptr)
 		{
 #ifdef ARCH_IA32
@@ -154,7 +212,8 @@ void HWDrawInfo::WorkerThread()
 		else switch (job->type)
 		{
 		case RenderJob::TerminateJob:
-			WTTotal.Unclock();
+			if (index == 0) WTTotal.Unclock();
+			renderWorkerIndex = 0;
 			return;
 
 		case RenderJob::WallJob:
@@ -207,18 +266,24 @@ void HWDrawInfo::WorkerThread()
 		}
 
 		case RenderJob::SpriteJob:
+		{
+			std::lock_guard<std::mutex> lock(SpriteLock);
 			SetupSprite.Clock();
 			front = hw_FakeFlat(drawctx, job->sub->sector, in_area, false);
 			RenderThings(job->sub, front, state);
 			SetupSprite.Unclock();
 			break;
+		}
 
 		case RenderJob::ParticleJob:
+		{
+			std::lock_guard<std::mutex> lock(SpriteLock);
 			SetupSprite.Clock();
 			front = hw_FakeFlat(drawctx, job->sub->sector, in_area, false);
 			RenderParticles(job->sub, front, state);
 			SetupSprite.Unclock();
 			break;
+		}
 
 		case RenderJob::PortalJob:
 			AddSubsectorToPortal((FSectorPortalGroup *)job->seg, job->sub);
@@ -1008,8 +1073,26 @@ void HWDrawInfo::RenderOrthoNoFog(FRenderState& state)
 	}
 }
 
+//==========================================================================
+//
+// Appends everything the additional workers produced to the main lists.
+//
+//==========================================================================
+
+void HWDrawInfo::MergeWorkerLists()
+{
+	for (int i = 0; i < numworkers - 1; i++)
+	{
+		for (int j = 0; j < GLDL_TYPES; j++)
+		{
+			drawlists[j].Append(workerlists[i][j]);
+		}
+	}
+}
+
 void HWDrawInfo::RenderBSP(void *node, bool drawpsprites, FRenderState& state)
 {
+	PROFILE_ZONE("RenderBSP", "frame");
 	ClearDitherTargets();
 	Bsp.Clock();
 
@@ -1035,17 +1118,26 @@ void HWDrawInfo::RenderBSP(void *node, bool drawpsprites, FRenderState& state)
 	multithread = gl_multithread;
 	if (multithread)
 	{
-		jobQueue.ReleaseAll();
-		auto future = renderPool.push([&](int id) {
-			WorkerThread();
-		});
+		// The workers busy-wait for new jobs so there should never be more of them than free cores.
+		numworkers = clamp<int>(gl_multithread_workers, 1, max<int>(1, std::thread::hardware_concurrency() - 1));
+		if (renderPool.size() < numworkers) renderPool.resize(numworkers);
+
+		jobQueue.Start(numworkers);
+		std::future<void> futures[MAX_RENDER_WORKERS];
+		for (int i = 0; i < numworkers; i++)
+		{
+			futures[i] = renderPool.push([=](int id) {
+				WorkerThread(i);
+			});
+		}
 		if (Viewpoint.IsOrtho() && ((Level->flags3 & LEVEL3_NOFOGOFWAR) || !r_radarclipper)) RenderOrthoNoFog(state);
 		else RenderBSPNode(node, state);
 
-		jobQueue.AddJob(RenderJob::TerminateJob, nullptr, nullptr);
+		jobQueue.Finish();
 		Bsp.Unclock();
 		MTWait.Clock();
-		future.wait();
+		for (int i = 0; i < numworkers; i++) futures[i].wait();
+		MergeWorkerLists();
 		MTWait.Unclock();
 	}
 	else
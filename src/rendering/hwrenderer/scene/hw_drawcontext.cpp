@@ -45,6 +45,7 @@ SortNode* StaticSortNodeArray::GetNew()
 HWDrawContext::HWDrawContext() : RenderDataAllocator(1024 * 1024), FakeSectorAllocator(20 * sizeof(sector_t))
 {
 	di_list.drawctx = this;
+	for (auto& alloc : WorkerDataAllocators) alloc.reset(new FMemArena(1024 * 1024));
 }
 
 HWDrawContext::~HWDrawContext()
@@ -54,4 +55,6 @@ HWDrawContext::~HWDrawContext()
 void HWDrawContext::ResetRenderDataAllocator()
 {
 	RenderDataAllocator.FreeAll();
+	for (auto& alloc : WorkerDataAllocators) alloc->FreeAll();
+	spriteLights.Clear();
 }
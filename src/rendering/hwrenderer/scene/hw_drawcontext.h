@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory>
 #include "common/utility/tarray.h"
 #include "hw_clipper.h"
 #include "hw_portal.h"
+#include "hw_spritelight.h"
 
 struct HWDrawInfo;
 struct SortNode;
@@ -46,6 +48,7 @@ public:
 	HWDrawInfo* gl_drawinfo = nullptr; // This is a linked list of all active DrawInfos and needed to free the memory arena after the last one goes out of scope.
 
 	FMemArena RenderDataAllocator;	// Use large blocks to reduce allocation time.
+	std::unique_ptr<FMemArena> WorkerDataAllocators[MAX_RENDER_WORKERS - 1];	// for the additional BSP workers which cannot share the one above.
 	StaticSortNodeArray SortNodes;
 
 	sector_t** fakesectorbuffer = nullptr;
@@ -54,4 +57,6 @@ public:
 	FPortalSceneState portalState;
 
 	TArray<FDynamicLight*> addedLightsArray;
+	FSpriteLightCache spriteLights;
+	TArray<unsigned> spriteLightHits;
 };
@@ -73,6 +73,29 @@ extern TArray<AActor*> Coronas;
 
 sector_t * hw_FakeFlat(sector_t * sec, sector_t * dest, area_t in_area, bool back);
 
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+HWDrawInfo::HWDrawInfo(HWDrawContext* drawctx) : drawctx(drawctx)
+{
+	for (HWDrawList& list : drawlists)
+	{
+		list.drawctx = drawctx;
+		list.allocator = &drawctx->RenderDataAllocator;
+	}
+	for (int i = 0; i < MAX_RENDER_WORKERS - 1; i++)
+	{
+		for (HWDrawList& list : workerlists[i])
+		{
+			list.drawctx = drawctx;
+			list.allocator = drawctx->WorkerDataAllocators[i].get();
+		}
+	}
+}
+
 
 //==========================================================================
 //
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <functional>
+#include <mutex>
 #include "vectors.h"
 #include "r_defs.h"
 #include "r_utility.h"
@@ -16,6 +17,8 @@ EXTERN_CVAR(Bool, lm_always_update);
 EXTERN_CVAR(Int, lm_max_updates);
 EXTERN_CVAR(Bool, lm_dynamic);
 
+extern thread_local int renderWorkerIndex;
+
 enum EDrawMode
 {
 	DM_MAINVIEW,
@@ -138,6 +141,7 @@ struct HWDrawInfo
 	HWDrawContext* drawctx = nullptr;
 
 	HWDrawList drawlists[GLDL_TYPES];
+	HWDrawList workerlists[MAX_RENDER_WORKERS - 1][GLDL_TYPES];	// Filled by the additional BSP workers and merged into drawlists afterward.
 	int vpIndex;
 	ELightMode lightmode;
 
@@ -184,12 +188,21 @@ struct HWDrawInfo
 	area_t	in_area;
 	fixed_t viewx, viewy;	// since the nodes are still fixed point, keeping the view position  also fixed point for node traversal is faster.
 	bool multithread;
+	int numworkers;
+	std::mutex SpriteLock;			// Sprites can also be processed by the wall worker when it encounters a line portal.
+	std::mutex VisibleTileLock;
 
 	TArray<bool> QueryResultsBuffer;
 
-	HWDrawInfo(HWDrawContext* drawctx) : drawctx(drawctx) { for (HWDrawList& list : drawlists) list.drawctx = drawctx; }
+	HWDrawInfo(HWDrawContext* drawctx);
+
+	void WorkerThread(int index);
+	void MergeWorkerLists();
 
-	void WorkerThread();
+	HWDrawList& DrawList(int list)
+	{
+		return renderWorkerIndex == 0 ? drawlists[list] : workerlists[renderWorkerIndex - 1][list];
+	}
 
 	void UnclipSubsector(subsector_t *sub);
 	
@@ -239,6 +252,8 @@ public:
 			return;
 		}
 
+		// walls and flats may be processed by different workers.
+		std::lock_guard<std::mutex> lock(VisibleTileLock);
 		LightmapTile* tile = &Level->levelMesh->Lightmap.Tiles[tileIndex];
 		if (lm_always_update || tile->AlwaysUpdate == 2 || (tile->AlwaysUpdate == 1 && lm_dynamic))
 		{
@@ -313,7 +328,7 @@ public:
 	void AddOtherFloorPlane(int sector, gl_subsectorrendernode * node, FRenderState& state);
 	void AddOtherCeilingPlane(int sector, gl_subsectorrendernode * node, FRenderState& state);
 
-	void GetDynSpriteLight(AActor *self, sun_trace_cache_t * traceCache, double x, double y, double z, FLightNode *node, int portalgroup, float *out, bool fullbright);
+	void GetDynSpriteLight(AActor *self, sun_trace_cache_t * traceCache, double x, double y, double z, FSection *section, int portalgroup, float *out, bool fullbright);
 	void GetDynSpriteLight(AActor *thing, particle_t *particle, sun_trace_cache_t * traceCache, float *out);
 
 	void GetDynSpriteLightList(AActor *self, double x, double y, double z, sun_trace_cache_t * traceCache, FDynLightData &modellightdata, bool isModel);
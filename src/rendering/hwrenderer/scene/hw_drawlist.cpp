@@ -678,7 +678,7 @@ void HWDrawList::SortFlats()
 
 HWWall *HWDrawList::NewWall()
 {
-	auto wall = (HWWall*)drawctx->RenderDataAllocator.Alloc(sizeof(HWWall));
+	auto wall = (HWWall*)allocator->Alloc(sizeof(HWWall));
 	drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(wall)));
 	return wall;
 }
@@ -690,7 +690,7 @@ HWWall *HWDrawList::NewWall()
 //==========================================================================
 HWFlat *HWDrawList::NewFlat()
 {
-	auto flat = (HWFlat*)drawctx->RenderDataAllocator.Alloc(sizeof(HWFlat));
+	auto flat = (HWFlat*)allocator->Alloc(sizeof(HWFlat));
 	drawitems.Push(HWDrawItem(DrawType_FLAT,flats.Push(flat)));
 	return flat;
 }
@@ -702,11 +702,40 @@ HWFlat *HWDrawList::NewFlat()
 //==========================================================================
 HWSprite *HWDrawList::NewSprite()
 {	
-	auto sprite = (HWSprite*)drawctx->RenderDataAllocator.Alloc(sizeof(HWSprite));
+	auto sprite = (HWSprite*)allocator->Alloc(sizeof(HWSprite));
 	drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(sprite)));
 	return sprite;
 }
 
+//==========================================================================
+//
+// Moves all items from a worker thread's list to the end of this one.
+// The items themselves stay where they are, only the pointers get moved.
+//
+//==========================================================================
+
+void HWDrawList::Append(HWDrawList &other)
+{
+	for (auto &item : other.drawitems)
+	{
+		switch (item.rendertype)
+		{
+		case DrawType_WALL:
+			drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(other.walls[item.index])));
+			break;
+
+		case DrawType_FLAT:
+			drawitems.Push(HWDrawItem(DrawType_FLAT, flats.Push(other.flats[item.index])));
+			break;
+
+		case DrawType_SPRITE:
+			drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(other.sprites[item.index])));
+			break;
+		}
+	}
+	other.Reset();
+}
+
 //==========================================================================
 //
 //
@@ -9,6 +9,9 @@ class HWSprite;
 class HWDrawContext;
 class FRenderState;
 
+// Maximum number of worker threads processing the BSP render jobs for one view.
+enum { MAX_RENDER_WORKERS = 3 };
+
 //==========================================================================
 //
 // Intermediate struct to link one draw item into a draw list
@@ -60,6 +63,7 @@ struct SortNode
 struct HWDrawList
 {
 	HWDrawContext* drawctx = nullptr;
+	FMemArena* allocator = nullptr;	// the memory for the items, each worker thread needs its own.
 	TArray<HWWall*> walls;
 	TArray<HWFlat*> flats;
 	TArray<HWSprite*> sprites;
@@ -89,6 +93,7 @@ struct HWDrawList
 	HWWall *NewWall();
 	HWFlat *NewFlat();
 	HWSprite *NewSprite();
+	void Append(HWDrawList &other);
 	void Reset();
 	void SortWalls();
 	void SortFlats();
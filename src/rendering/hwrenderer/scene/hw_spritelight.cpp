@@ -39,8 +39,19 @@
 #include "hwrenderer/scene/hw_drawstructs.h"
 #include "models.h"
 #include <cmath>	// needed for std::floor on mac
+#include <float.h>
 #include "hw_cvars.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__i386__) || defined(__amd64__)
+#define SPRITELIGHT_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <emmintrin.h>
+#endif
+
+CVAR(Bool, gl_spritelightcache, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
 template<class T>
 T smoothstep(const T edge0, const T edge1, const T x)
 {
@@ -127,13 +138,81 @@ float inverseSquareAttenuation(float dist, float radius, float strength)
 	return (b * b) / (dist * dist + 1.0) * strength;
 }
 
-void HWDrawInfo::GetDynSpriteLight(AActor *self, sun_trace_cache_t * traceCache, double x, double y, double z, FLightNode *node, int portalgroup, float *out, bool fullbright)
+//==========================================================================
+//
+// Adds the contribution of one light whose radius reaches the sprite.
+// L points from the light to the sprite, distSquared is its squared length.
+//
+//==========================================================================
+
+static inline void AddSpriteLight(ActorTraceStaticLight &staticLight, FLightNode *node, FVector3 L, float distSquared, float radius, double x, double y, double z, float *out)
+{
+	FDynamicLight *light = node->lightsource;
+	float frac, lr, lg, lb;
+	float dist = sqrtf(distSquared);	// only calculate the square root if we really need it.
+
+	if (light->IsSpot() || light->TraceActors())
+		L *= -1.0f / dist;
+
+	if (staticLight.TraceLightVisbility(node, L, dist, light->updated))
+	{
+		if(level.info->lightattenuationmode == ELightAttenuationMode::INVERSE_SQUARE)
+		{
+			frac = (inverseSquareAttenuation(std::max(dist, sqrt(radius) * 2), radius, light->GetStrength()));
+		}
+		else
+		{
+			frac = 1.0f - (dist / radius);
+		}
+
+		if (light->IsSpot())
+		{
+			DAngle negPitch = -*light->pPitch;
+			DAngle Angle = light->target->Angles.Yaw;
+			double xyLen = negPitch.Cos();
+			double spotDirX = -Angle.Cos() * xyLen;
+			double spotDirY = -Angle.Sin() * xyLen;
+			double spotDirZ = -negPitch.Sin();
+			double cosDir = L.X * spotDirX + L.Y * spotDirY + L.Z * spotDirZ;
+			frac *= (float)smoothstep(light->pSpotOuterAngle->Cos(), light->pSpotInnerAngle->Cos(), cosDir);
+		}
+
+		if (frac > 0 && (!light->shadowmapped || (staticLight.Actor && light->TraceActors()) || screen->mShadowMap->ShadowTest(light->Pos, { x, y, z })))
+		{
+			lr = light->GetRed() / 255.0f;
+			lg = light->GetGreen() / 255.0f;
+			lb = light->GetBlue() / 255.0f;
+
+			if (light->target)
+			{
+				float alpha = (float)light->target->Alpha;
+				lr *= alpha;
+				lg *= alpha;
+				lb *= alpha;
+			}
+
+			if (light->IsSubtractive())
+			{
+				float bright = (float)FVector3(lr, lg, lb).Length();
+				FVector3 lightColor(lr, lg, lb);
+				lr = (bright - lr) * -1;
+				lg = (bright - lg) * -1;
+				lb = (bright - lb) * -1;
+			}
+
+			out[0] += lr * frac;
+			out[1] += lg * frac;
+			out[2] += lb * frac;
+		}
+	}
+}
+
+void HWDrawInfo::GetDynSpriteLight(AActor *self, sun_trace_cache_t * traceCache, double x, double y, double z, FSection *section, int portalgroup, float *out, bool fullbright)
 {
 	if (fullbright || get_gl_spritelight() > 0)
 		return;
 
 	FDynamicLight *light;
-	float frac, lr, lg, lb;
 	float radius;
 	
 	out[0] = out[1] = out[2] = 0.f;
@@ -152,7 +231,32 @@ void HWDrawInfo::GetDynSpriteLight(AActor *self, sun_trace_cache_t * traceCache,
 		out[2] = Level->SunColor.Z * Level->SunIntensity;
 	}
 
+	auto cached = gl_spritelightcache ? drawctx->spriteLights.GetSection(Level, section, portalgroup) : nullptr;
+	if (cached)
+	{
+		auto &cache = drawctx->spriteLights;
+		auto &hits = drawctx->spriteLightHits;
+		cache.FindLights(cached, (float)x, (float)y, (float)z, 0, hits);
+		for (unsigned index : hits)
+		{
+			FLightNode *node = cache.Node(index);
+			light = node->lightsource;
+			if (light->ShouldLightActor(self))
+			{
+				FVector3 L(float(x - cache.LightX(index)), float(y - cache.LightY(index)), float(z - cache.LightZ(index)));
+				float dist = (float)L.LengthSquared();
+				radius = light->GetRadius();
+				if (dist < radius * radius)
+				{
+					AddSpriteLight(staticLight, node, L, dist, radius, x, y, z, out);
+				}
+			}
+		}
+		return;
+	}
+
 	// Go through both light lists
+	FLightNode *node = section->lighthead;
 	while (node)
 	{
 		light=node->lightsource;
@@ -183,62 +287,7 @@ void HWDrawInfo::GetDynSpriteLight(AActor *self, sun_trace_cache_t * traceCache,
 
 			if (radius > 0 && dist < radius * radius)
 			{
-				dist = sqrtf(dist);	// only calculate the square root if we really need it.
-
-				if (light->IsSpot() || light->TraceActors())
-					L *= -1.0f / dist;
-
-				if (staticLight.TraceLightVisbility(node, L, dist, light->updated))
-				{
-					if(level.info->lightattenuationmode == ELightAttenuationMode::INVERSE_SQUARE)
-					{
-						frac = (inverseSquareAttenuation(std::max(dist, sqrt(radius) * 2), radius, light->GetStrength()));
-					}
-					else
-					{
-						frac = 1.0f - (dist / radius);
-					}
-
-					if (light->IsSpot())
-					{
-						DAngle negPitch = -*light->pPitch;
-						DAngle Angle = light->target->Angles.Yaw;
-						double xyLen = negPitch.Cos();
-						double spotDirX = -Angle.Cos() * xyLen;
-						double spotDirY = -Angle.Sin() * xyLen;
-						double spotDirZ = -negPitch.Sin();
-						double cosDir = L.X * spotDirX + L.Y * spotDirY + L.Z * spotDirZ;
-						frac *= (float)smoothstep(light->pSpotOuterAngle->Cos(), light->pSpotInnerAngle->Cos(), cosDir);
-					}
-
-					if (frac > 0 && (!light->shadowmapped || (self && light->TraceActors()) || screen->mShadowMap->ShadowTest(light->Pos, { x, y, z })))
-					{
-						lr = light->GetRed() / 255.0f;
-						lg = light->GetGreen() / 255.0f;
-						lb = light->GetBlue() / 255.0f;
-
-						if (light->target)
-						{
-							float alpha = (float)light->target->Alpha;
-							lr *= alpha;
-							lg *= alpha;
-							lb *= alpha;
-						}
-
-						if (light->IsSubtractive())
-						{
-							float bright = (float)FVector3(lr, lg, lb).Length();
-							FVector3 lightColor(lr, lg, lb);
-							lr = (bright - lr) * -1;
-							lg = (bright - lg) * -1;
-							lb = (bright - lb) * -1;
-						}
-
-						out[0] += lr * frac;
-						out[1] += lg * frac;
-						out[2] += lb * frac;
-					}
-				}
+				AddSpriteLight(staticLight, node, L, dist, radius, x, y, z, out);
 			}
 		}
 		node = node->nextLight;
@@ -249,11 +298,11 @@ void HWDrawInfo::GetDynSpriteLight(AActor *thing, particle_t *particle, sun_trac
 {
 	if (thing)
 	{
-		GetDynSpriteLight(thing, &thing->StaticLightsTraceCache, thing->X(), thing->Y(), thing->Center(), thing->section->lighthead, thing->Sector->PortalGroup, out, (thing->flags5 & MF5_BRIGHT));
+		GetDynSpriteLight(thing, &thing->StaticLightsTraceCache, thing->X(), thing->Y(), thing->Center(), thing->section, thing->Sector->PortalGroup, out, (thing->flags5 & MF5_BRIGHT));
 	}
 	else if (particle)
 	{
-		GetDynSpriteLight(nullptr, traceCache, particle->Pos.X, particle->Pos.Y, particle->Pos.Z, particle->subsector->section->lighthead, particle->subsector->sector->PortalGroup, out, (particle->flags & SPF_FULLBRIGHT));
+		GetDynSpriteLight(nullptr, traceCache, particle->Pos.X, particle->Pos.Y, particle->Pos.Z, particle->subsector->section, particle->subsector->sector->PortalGroup, out, (particle->flags & SPF_FULLBRIGHT));
 	}
 }
 
@@ -288,10 +337,53 @@ void HWDrawInfo::GetDynSpriteLightList(AActor *self, double x, double y, double
 		AddSunLightToList(modellightdata, x, y, z, Level->SunDirection, Level->SunColor * Level->SunIntensity, gl_spritelight > 0);
 	}
 
+	// The cached light positions are only usable here if there are no portal displacements
+	// because PosRelative treats portal group 0 differently than the sprite light code.
+	bool usecache = gl_spritelightcache && Level->Displacements.size == 0;
+
 	BSPWalkCircle(Level, x, y, radiusSquared, [&](subsector_t *subsector) // Iterate through all subsectors potentially touched by actor
 	{
 		auto section = subsector->section;
 		if (section->validcount == dl_validcount) return;	// already done from a previous subsector.
+
+		auto cached = usecache ? drawctx->spriteLights.GetSection(Level, section, subsector->sector->PortalGroup) : nullptr;
+		if (cached)
+		{
+			auto &cache = drawctx->spriteLights;
+			auto &hits = drawctx->spriteLightHits;
+			cache.FindLights(cached, (float)x, (float)y, (float)z, actorradius, hits);
+			for (unsigned index : hits)
+			{
+				FLightNode *node = cache.Node(index);
+				FDynamicLight *light = node->lightsource;
+				if (!light->ShouldLightActor(self)) continue;
+
+				unsigned addindex = addedLights.SortedFind(light, false);
+				if (addindex == addedLights.Size() || addedLights[addindex] != light)
+				{
+					double dx = light->X() - x;
+					double dy = light->Y() - y;
+					double dz = light->Z() - z;
+					double distSquared = dx * dx + dy * dy + dz * dz;
+					float radius = (float)(light->GetRadius() + actorradius);
+					if (distSquared >= radius * radius) continue;
+
+					FVector3 L(dx, dy, dz);
+					float dist = sqrtf(distSquared);
+					if (gl_spritelight == 0 && light->TraceActors())
+						L *= 1.0f / dist;
+
+					if (gl_spritelight > 0 || staticLight.TraceLightVisbility(node, L, dist, light->updated))
+					{
+						AddLightToList(modellightdata, subsector->sector->PortalGroup, light, true, gl_spritelight > 0);
+					}
+
+					addedLights.Insert(addindex, light);
+				}
+			}
+			return;
+		}
+
 		FLightNode * node = section->lighthead;
 		while (node) // check all lights touching a subsector
 		{
@@ -340,4 +432,111 @@ void HWDrawInfo::GetDynSpriteLightList(AActor *thing, particle_t *particle, sun_
 		if(particle->flags & SPF_FULLBRIGHT) return;
 		GetDynSpriteLightList(nullptr, particle->Pos.X, particle->Pos.Y, particle->Pos.Z, traceCache, modellightdata, isModel);
 	}
-}
\ No newline at end of file
+}
+
+//==========================================================================
+//
+// Sprite light cache
+//
+//==========================================================================
+
+void FSpriteLightCache::Clear()
+{
+	Frame++;
+	X.Clear();
+	Y.Clear();
+	Z.Clear();
+	Radius.Clear();
+	Nodes.Clear();
+}
+
+void FSpriteLightCache::AddLight(FLightNode *node, float x, float y, float z, float radius)
+{
+	X.Push(x);
+	Y.Push(y);
+	Z.Push(z);
+	Radius.Push(radius);
+	Nodes.Push(node);
+}
+
+const FSpriteLightCache::FSectionLights *FSpriteLightCache::GetSection(FLevelLocals *Level, FSection *section, int portalgroup)
+{
+	if (Sections.Size() != Level->sections.allSections.Size())
+	{
+		Sections.Resize(Level->sections.allSections.Size());
+		for (auto &sec : Sections) sec.Frame = 0;
+	}
+
+	auto &sec = Sections[Level->sections.SectionIndex(section)];
+	if (sec.Frame == Frame)
+	{
+		// Sprites are practically always seen from the portal group of their section. Anything else takes the slow path.
+		return sec.PortalGroup == portalgroup ? &sec : nullptr;
+	}
+
+	sec.Frame = Frame;
+	sec.PortalGroup = portalgroup;
+	sec.First = X.Size();
+
+	for (FLightNode *node = section->lighthead; node; node = node->nextLight)
+	{
+		FDynamicLight *light = node->lightsource;
+		float radius = light->GetRadius();
+		if (radius <= 0) continue;
+
+		DVector3 pos = light->Pos;
+		if (Level->Displacements.size > 0)
+		{
+			int fromgroup = light->Sector->PortalGroup;
+			if (fromgroup != portalgroup && fromgroup != 0 && portalgroup != 0)
+			{
+				pos += Level->Displacements.getOffset(fromgroup, portalgroup);
+			}
+		}
+		AddLight(node, (float)pos.X, (float)pos.Y, (float)pos.Z, radius);
+	}
+
+	// Pad to a full group of 4 with lights so far away that they can never be in range.
+	while ((X.Size() - sec.First) & 3)
+	{
+		AddLight(nullptr, 1e18f, 1e18f, 1e18f, 0);
+	}
+	sec.Count = X.Size() - sec.First;
+	return &sec;
+}
+
+unsigned FSpriteLightCache::FindLights(const FSectionLights *sec, float x, float y, float z, float extra, TArray<unsigned> &hits) const
+{
+	hits.Clear();
+	unsigned end = sec->First + sec->Count;
+
+#ifdef SPRITELIGHT_SSE2
+	__m128 px = _mm_set1_ps(x);
+	__m128 py = _mm_set1_ps(y);
+	__m128 pz = _mm_set1_ps(z);
+	__m128 pextra = _mm_set1_ps(extra);
+	for (unsigned i = sec->First; i < end; i += 4)
+	{
+		__m128 dx = _mm_sub_ps(_mm_loadu_ps(&X[i]), px);
+		__m128 dy = _mm_sub_ps(_mm_loadu_ps(&Y[i]), py);
+		__m128 dz = _mm_sub_ps(_mm_loadu_ps(&Z[i]), pz);
+		__m128 r = _mm_add_ps(_mm_loadu_ps(&Radius[i]), pextra);
+		__m128 distsq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		int mask = _mm_movemask_ps(_mm_cmplt_ps(distsq, _mm_mul_ps(r, r)));
+		for (int j = 0; mask != 0; j++, mask >>= 1)
+		{
+			if (mask & 1) hits.Push(i + j);
+		}
+	}
+#else
+	for (unsigned i = sec->First; i < end; i++)
+	{
+		float dx = X[i] - x;
+		float dy = Y[i] - y;
+		float dz = Z[i] - z;
+		float r = Radius[i] + extra;
+		if (dx * dx + dy * dy + dz * dz < r * r) hits.Push(i);
+	}
+#endif
+	return hits.Size();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common/utility/tarray.h"
+
+struct FLevelLocals;
+struct FSection;
+struct FLightNode;
+
+// A flattened copy of the light lists of all sections that had lit sprites in
+// them during the current frame. The lights are stored as separate coordinate
+// and radius arrays, already moved into the portal group they are seen from,
+// so that the distance checks can be done for 4 lights at once instead of
+// following the light node list of the section for every single sprite.
+// Lights do not change while a frame is being rendered so all sprites in a
+// section share one copy which gets discarded when the frame is done.
+// Sprite processing is serialized between the BSP workers so this needs no locking.
+
+class FSpriteLightCache
+{
+public:
+	struct FSectionLights
+	{
+		unsigned Frame;
+		unsigned First;
+		unsigned Count;		// always a multiple of 4, the padding can never pass the distance check.
+		int PortalGroup;
+	};
+
+	const FSectionLights *GetSection(FLevelLocals *Level, FSection *section, int portalgroup);
+
+	// Collects the indices of all lights of a section whose radius plus 'extra' reaches the given point.
+	unsigned FindLights(const FSectionLights *sec, float x, float y, float z, float extra, TArray<unsigned> &hits) const;
+
+	FLightNode *Node(unsigned index) const { return Nodes[index]; }
+	float LightX(unsigned index) const { return X[index]; }
+	float LightY(unsigned index) const { return Y[index]; }
+	float LightZ(unsigned index) const { return Z[index]; }
+
+	void Clear();
+
+private:
+	void AddLight(FLightNode *node, float x, float y, float z, float radius);
+
+	TArray<float> X, Y, Z, Radius;
+	TArray<FLightNode *> Nodes;
+	TArray<FSectionLights> Sections;
+	unsigned Frame = 1;
+};
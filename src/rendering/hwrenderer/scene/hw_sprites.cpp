@@ -1753,6 +1753,9 @@ void HWDrawInfo::ProcessActorsInPortal(FLinePortalSpan *glport, area_t in_area,
 	TMap<AActor*, bool> processcheck;
 	if (glport->validcount == validcount) return;	// only process once per frame
 	glport->validcount = validcount;
+
+	// This gets called by the wall worker which may run in parallel to the sprite worker.
+	std::lock_guard<std::mutex> lock(SpriteLock);
     const auto &vp = Viewpoint;
 	for (auto port : glport->lines)
 	{
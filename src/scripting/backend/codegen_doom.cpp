@@ -724,6 +724,8 @@ FxExpression *FxStateByIndex::Resolve(FCompileContext &ctx)
 		delete this;
 		return nullptr;
 	}
+	// StateLabels only gets filled while resolving, so code referencing its indices cannot be restored from the script cache.
+	ctx.NoCache = true;
 	int symlabel = StateLabels.AddPointer(aclass->GetStates() + index);
 	FxExpression *x = new FxConstant(symlabel, ScriptPosition);
 	x->ValueType = TypeStateLabel;
@@ -752,6 +754,7 @@ FxExpression *FxRuntimeStateIndex::Resolve(FCompileContext &ctx)
 {
 	CHECKRESOLVED();
 	SAFE_RESOLVE(Index, ctx);
+	ctx.NoCache = true;	// see FxStateByIndex
 
 	if (!Index->IsNumeric())
 	{
@@ -844,6 +847,7 @@ FxExpression *FxMultiNameState::Resolve(FCompileContext &ctx)
 	CHECKRESOLVED();
 	ABORT(ctx.Class);
 	int symlabel;
+	ctx.NoCache = true;	// see FxStateByIndex
 
 	auto vclass = PType::toClass(ctx.Class);
 	//assert(vclass != nullptr);
@@ -45,6 +45,7 @@
 #include "a_morph.h"
 #include "codegen.h"
 #include "backend/codegen_doom.h"
+#include "vmcache.h"
 #include "filesystem.h"
 #include "v_text.h"
 #include "m_argv.h"
@@ -1266,6 +1267,8 @@ static void ParseDamageDefinition(FScanner &sc)
 
 void ParseDecorate (FScanner &sc, PNamespace *ns)
 {
+	ScriptCache.AddSource(sc.LumpNum);
+
 	// Get actor class name.
 	for(;;)
 	{
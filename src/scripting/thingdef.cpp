@@ -56,6 +56,7 @@
 #include "zcc_parser.h"
 #include "zcc_compile_doom.h"
 #include "i_interface.h"
+#include "profiler.h"
 
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
 void InitThingdef();
@@ -425,6 +426,7 @@ void ParseScripts()
 
 	while ((lump = fileSystem.FindLump("ZSCRIPT", &lastlump)) != -1)
 	{
+		FProfileZone zone("ZScript", "startup", fileSystem.GetFileFullPath(lump).c_str());
 		ZCCParseState state;
 		auto newns = ParseOneScript(lump, state);
 		PSymbolTable symtable;
@@ -455,14 +457,19 @@ void LoadActors()
 
 	SetDoomCompileEnvironment();
 	InitThingdef();
+	FProfileSequence phase("startup");
+	phase.Next("ParseScripts");
 	FScriptPosition::StrictErrors = true;
 	ParseScripts();
 
+	phase.Next("ParseAllDecorate");
 	FScriptPosition::StrictErrors = strictdecorate;
 	ParseAllDecorate();
 	SynthesizeFlagFields();
 
+	phase.Next("FunctionBuildList");
 	FunctionBuildList.Build();
+	phase.Next(nullptr);
 
 	if (FScriptPosition::ErrorCounter > 0)
 	{